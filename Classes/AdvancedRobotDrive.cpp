@@ -1,6 +1,7 @@
 #include "AdvancedRobotDrive.h"
 #include "../CommandBase.h"
-#include <Math.h>
+#include "RobotClock.h"
+#include <math.h>
 #include "../Robotmap.h"
 
 
@@ -8,22 +9,6 @@ namespace
 {
 	const float tolerance = 0.2;
 	const float thereTolerance = 0.1;
-	const float rotateReduce = 1.5;
-	
-	//! The robot wheel base
-	const float wheelBase = 25.0;
-	
-	//! The robot track (assumes front and rear track is the same)
-	const float wheelTrack = 22.25;
-	
-	//! The ratio of wheelBase to wheelTrack
-	const float wheelRatio = wheelBase / wheelTrack;
-	
-	//! The diameter of the Big Wheels on the BS Bot.
-	const float bigWheelDiameter = 12.5;
-	
-	//! The diameter of the BS bot's Mecanum wheels.
-	const float mecanumWheelDiameter = 5.5;
 };
 
 /** @brief Initializes the drive motors.
@@ -35,16 +20,16 @@ namespace
  * @author Stephen Nutt
  */
 DriveMotors::DriveMotors() try :
-	m_frontLeftMotor ((CommandBase::s_Log->LogMessage("Initializing front left jaguar."), kFrontLeftJaguar), 
+	m_frontLeftMotor ((LOG_MESSAGE("Initializing front left jaguar.", kLogPriorityDebug), kFrontLeftJaguar), 
 		kDriveRamp, kDriveVelocityLimit, tolerance, thereTolerance),
-	m_frontRightMotor((CommandBase::s_Log->LogMessage("Initializing front right jaguar."), kFrontRightJaguar), 
+	m_frontRightMotor((LOG_MESSAGE("Initializing front right jaguar.", kLogPriorityDebug), kFrontRightJaguar), 
 		kDriveRamp, kDriveVelocityLimit, tolerance, thereTolerance),
-	m_rearLeftMotor  ((CommandBase::s_Log->LogMessage("Initializing rear left jaguar."), kRearLeftJaguar), 
+	m_rearLeftMotor  ((LOG_MESSAGE("Initializing rear left jaguar.", kLogPriorityDebug), kRearLeftJaguar), 
 		kDriveRamp, kDriveVelocityLimit, tolerance, thereTolerance),
-	m_rearRightMotor ((CommandBase::s_Log->LogMessage("Initializing rear right jaguar."), kRearRightJaguar), 
+	m_rearRightMotor ((LOG_MESSAGE("Initializing rear right jaguar.", kLogPriorityDebug), kRearRightJaguar), 
 		kDriveRamp, kDriveVelocityLimit, tolerance, thereTolerance)
 {
-	CommandBase::s_Log->LogMessage("Drive jaguars successfully created.",kLogPriorityDebug);
+	LOG_MESSAGE("Drive jaguars successfully created.", kLogPriorityDebug);
 
 	DriveMotors::m_frontLeftMotor.ConfigMaxOutputVoltage(kDriveOutputVoltageLimit);
 	DriveMotors::m_frontLeftMotor.ConfigNeutralMode(CANJaguar::kNeutralMode_Brake);
@@ -58,12 +43,36 @@ DriveMotors::DriveMotors() try :
 	DriveMotors::m_rearRightMotor.ConfigMaxOutputVoltage(kDriveOutputVoltageLimit);
 	DriveMotors::m_rearRightMotor.ConfigNeutralMode(CANJaguar::kNeutralMode_Brake);
 
-	CommandBase::s_Log->LogMessage("Drive jaguars successfully instantiated.",kLogPriorityDebug);
+	if (kUseEncoders)
+	{
+		ConfigEncoder(DriveMotors::m_frontLeftMotor);
+		ConfigEncoder(DriveMotors::m_frontRightMotor);
+		ConfigEncoder(DriveMotors::m_rearLeftMotor);
+		ConfigEncoder(DriveMotors::m_rearRightMotor);
+	}
+
+	// The drive setpoints are applied together by PowerMotors
+	DriveMotors::m_frontLeftMotor.SetSyncGroup(kDriveSyncGroup);
+	DriveMotors::m_frontRightMotor.SetSyncGroup(kDriveSyncGroup);
+	DriveMotors::m_rearLeftMotor.SetSyncGroup(kDriveSyncGroup);
+	DriveMotors::m_rearRightMotor.SetSyncGroup(kDriveSyncGroup);
+
+	LOG_MESSAGE("Drive jaguars successfully instantiated.", kLogPriorityDebug);
 }
 catch (exception e)
 {
-	CommandBase::s_Log->LogMessage("Error creating jaguars.",kLogPriorityError);
-	CommandBase::s_Log->LogMessage(e.what(),kLogPriorityError);
+	LOG_MESSAGE("Error creating jaguars.", kLogPriorityError);
+	LOG_TEXT(e.what(), kLogPriorityError);
+}
+
+/** @brief Sets a drive motor to read its position and speed from a
+ * quadrature encoder with kDriveEncoderLines lines.
+ */
+void DriveMotors::ConfigEncoder(RampedCANJaguar& motor)
+{
+	motor.SetPositionReference(CANJaguar::kPosRef_QuadEncoder);
+	motor.SetSpeedReference(CANJaguar::kSpeedRef_QuadEncoder);
+	motor.ConfigEncoderCodesPerRev(kDriveEncoderLines);
 }
 
 /**
@@ -77,141 +86,227 @@ catch (exception e)
 AdvancedRobotDrive::AdvancedRobotDrive(DriveMode mode):
     DriveMotors(),
     RobotDrive(DriveMotors::m_rearRightMotor, DriveMotors::m_rearLeftMotor,
-		DriveMotors::m_frontRightMotor, DriveMotors::m_frontLeftMotor)
+		DriveMotors::m_frontRightMotor, DriveMotors::m_frontLeftMotor),
+	m_poseEstimator(mode, &(DriveMotors::m_frontLeftMotor), &(DriveMotors::m_rearLeftMotor),
+		&(DriveMotors::m_frontRightMotor), &(DriveMotors::m_rearRightMotor)),
+	m_speedController(&(DriveMotors::m_frontLeftMotor), &(DriveMotors::m_rearLeftMotor),
+		&(DriveMotors::m_frontRightMotor), &(DriveMotors::m_rearRightMotor))
 {
 	m_driveMode = mode;
+	switch (m_driveMode)
+	{
+		case kMecanumDrive:
+			SelectDriveMode<kMecanumDrive>();
+			break;
+		case kSkidSteer:
+			SelectDriveMode<kSkidSteer>();
+			break;
+		case kSwivelSteer:
+			SelectDriveMode<kSwivelSteer>();
+			break;
+		case kBSBotDrive:
+		default:
+			SelectDriveMode<kBSBotDrive>();
+			break;
+	}
+
+	m_moveChannel = CommandBase::s_Log->RegisterTelemetryChannel("DriveMove", kTelemetryFloat, "");
+	m_rotateChannel = CommandBase::s_Log->RegisterTelemetryChannel("DriveRotate", kTelemetryFloat, "");
+	m_frontLeftChannel = CommandBase::s_Log->RegisterTelemetryChannel("FrontLeftOutput", kTelemetryFloat, "");
+	m_rearLeftChannel = CommandBase::s_Log->RegisterTelemetryChannel("RearLeftOutput", kTelemetryFloat, "");
+	m_frontRightChannel = CommandBase::s_Log->RegisterTelemetryChannel("FrontRightOutput", kTelemetryFloat, "");
+	m_rearRightChannel = CommandBase::s_Log->RegisterTelemetryChannel("RearRightOutput", kTelemetryFloat, "");
+	m_canRateChannel = CommandBase::s_Log->RegisterTelemetryChannel("CANMessageRate", kTelemetryInteger, "msg/s");
+	m_canRateStartTime = RobotClock::GetTime();
+	m_canRateStartCount = RampedCANJaguar::GetMessageCount();
+	m_canRate = 0;
+
+	// Without encoders there is nothing to estimate the pose from
+	if (kUseEncoders)
+	{
+		m_poseEstimator.Start();
+	}
+	this->ConfigControlMode();
+}
+
+/**
+ * @brief Puts the drive motors in the control mode for kDriveControlMode.
+ * The closed loop modes need encoders, so without them the motors stay
+ * open loop. A closed loop mode whose gains are all 0 would never drive
+ * the motors, so it is driven open loop too.
+ */
+void AdvancedRobotDrive::ConfigControlMode()
+{
+	m_controlMode = kDriveControlMode;
+	if (m_controlMode != kDriveOpenLoop && !kUseEncoders)
+	{
+		LOG_MESSAGE("Closed loop drive needs kUseEncoders, driving open loop.", kLogPriorityError);
+		m_controlMode = kDriveOpenLoop;
+	}
+	const bool noFeedback = (kDriveP == 0 && kDriveI == 0 && kDriveD == 0);
+	if (m_controlMode == kDriveJaguarSpeedControl && noFeedback)
+	{
+		// The Jaguar's speed loop has no feed-forward
+		LOG_MESSAGE("Jaguar speed control needs kDriveP, kDriveI or kDriveD, driving open loop.", kLogPriorityError);
+		m_controlMode = kDriveOpenLoop;
+	}
+	else if (m_controlMode == kDriveCRIOSpeedControl && noFeedback && kDriveF == 0)
+	{
+		LOG_MESSAGE("cRIO speed control needs kDriveF or a PID gain, driving open loop.", kLogPriorityError);
+		m_controlMode = kDriveOpenLoop;
+	}
+
+	switch (m_controlMode)
+	{
+		case kDriveJaguarSpeedControl:
+			ConfigJaguarSpeedControl(DriveMotors::m_frontLeftMotor);
+			ConfigJaguarSpeedControl(DriveMotors::m_rearLeftMotor);
+			ConfigJaguarSpeedControl(DriveMotors::m_frontRightMotor);
+			ConfigJaguarSpeedControl(DriveMotors::m_rearRightMotor);
+			m_outputScale = kDriveMaxRPM;
+			break;
+		case kDriveCRIOSpeedControl:
+			DriveMotors::m_frontLeftMotor.ChangeControlMode(CANJaguar::kVoltage);
+			DriveMotors::m_rearLeftMotor.ChangeControlMode(CANJaguar::kVoltage);
+			DriveMotors::m_frontRightMotor.ChangeControlMode(CANJaguar::kVoltage);
+			DriveMotors::m_rearRightMotor.ChangeControlMode(CANJaguar::kVoltage);
+			DriveMotors::m_frontLeftMotor.EnableControl();
+			DriveMotors::m_rearLeftMotor.EnableControl();
+			DriveMotors::m_frontRightMotor.EnableControl();
+			DriveMotors::m_rearRightMotor.EnableControl();
+			m_speedController.Start();
+			m_outputScale = kDriveMaxRPM;
+			break;
+		default:
+			m_outputScale = 1.0;
+			break;
+	}
+	LOG_VALUE("Drive control mode", m_controlMode, kLogPriorityDebug);
+}
+
+/**
+ * @brief Puts a drive motor in speed mode, with the Jaguar running the
+ * PID loop with kDriveP, kDriveI and kDriveD.
+ */
+void AdvancedRobotDrive::ConfigJaguarSpeedControl(RampedCANJaguar& motor)
+{
+	motor.ChangeControlMode(CANJaguar::kSpeed);
+	motor.SetSpeedReference(CANJaguar::kSpeedRef_QuadEncoder);
+	motor.SetPID(kDriveP, kDriveI, kDriveD);
+	motor.EnableControl();
 }
 
 /**
  * @brief Drive the robot. Call this from a command. Do not use
  * this for autonomous. See AdvancedRobotDrive::DriveAutonomous.
- * @param joystick The joystick to pull the drive commands.
+ * The values come from the driver, but not directly from a joystick
+ * so that they can also be scripted, for example in a simulation.
+ * @param moveValue The forward speed, -1 to 1.
+ * @param strafeValue The sideways speed, -1 to 1.
+ * @param rotateValue The rotation speed, -1 to 1.
  * @see AdvancedRobotDrive::DriveAutonomous
  * 
  * @author Arthur Lockman
  */
-void AdvancedRobotDrive::DriveRobot(FRCXboxJoystick &joystick)
+void AdvancedRobotDrive::DriveRobot(float moveValue, float strafeValue, float rotateValue)
 {
-	CommandBase::s_Log->LogMessage("Entering AdvancedRobotDrive::DriveRobot.",kLogPrioritySystem);
+	LOG_MESSAGE("Entering AdvancedRobotDrive::DriveRobot.", kLogPrioritySystem);
 	m_safetyHelper->Feed();
-	switch (m_driveMode)
-	{
-		case kMecanumDrive:
-			this->DriveMecanum(joystick);
-			break;
-		case kBSBotDrive:
-			this->DriveBSBot(joystick);
-			break;
-		case kSkidSteer:
-			this->DriveSkidSteer(joystick);
-			break;
-		case kSwivelSteer:
-			this->DriveSwivelSteer(joystick);
-			break;
-	}
+	CommandBase::s_Log->SampleTelemetry(m_moveChannel, moveValue);
+	CommandBase::s_Log->SampleTelemetry(m_rotateChannel, rotateValue);
+	this->DriveChassis(moveValue, strafeValue, rotateValue);
 }
 
 /**
  * @brief Drives the robot in autonomous mode. Do not use this to
  * drive in teleoperated mode. See AdvancedRobotDrive::DriveRobot.
+ * @param forward The forward speed in inches per second.
+ * @param strafe The speed to the right in inches per second, ignored
+ * unless the drive mode can strafe.
+ * @param turnRate The anticlockwise turn rate in radians per second.
  * @see AdvancedRobotDrive::DriveRobot
  * 
  * @author Arthur Lockman
  */
-void AdvancedRobotDrive::DriveAutonomous()
+void AdvancedRobotDrive::DriveAutonomous(float forward, float strafe, float turnRate)
 {
 	m_safetyHelper->Feed();
-	//@TODO: Develop code for driving in Autonomous mode.
+	(this->*m_driveAutonomous)(forward, strafe, turnRate);
 }
 
 /**
- * @brief Drives the robot in Mecanum drive mode. 
- * 
- * @author Arthur Lockman
+ * @brief Drives the chassis in whatever drive mode it was created with.
+ * The drive mode's DriveKinematics turn the command into the motor outputs.
+ * @param move The forward speed, -1 to 1.
+ * @param strafe The sideways speed, -1 to 1, ignored unless the drive
+ * mode can strafe.
+ * @param rotate The rotation speed, -1 to 1.
  */
-void AdvancedRobotDrive::DriveMecanum(FRCXboxJoystick& joystick)
+void AdvancedRobotDrive::DriveChassis(float move, float strafe, float rotate)
 {
-	m_safetyHelper->Feed();
-	RobotDrive::MecanumDrive_Polar(joystick.GetLeftStickY(),joystick.GetLeftStickX(),joystick.GetRightStickX());
+	(this->*m_driveChassis)(move, strafe, rotate);
 }
 
 /**
- * @brief Drives the robot in BSBot drive mode. 
- * 
- * @author Arthur Lockman, Conor McGrory
+ * @brief Makes DriveChassis and DriveAutonomous use the kinematics of a
+ * drive mode. The mode only changes at construction, so each cycle makes
+ * one call through a member pointer to code instantiated for the mode, in
+ * which the kinematics inline.
  */
-void AdvancedRobotDrive::DriveBSBot(FRCXboxJoystick& joystick)
+template <DriveMode Mode>
+void AdvancedRobotDrive::SelectDriveMode()
 {
-	m_safetyHelper->Feed();
-	float rotateValue = joystick.GetRightStickX();
-	float moveValue = -joystick.GetLeftStickY();
-	
-	float frontLeft;
-	float frontRight;
-	float limit;
-	
-	moveValue   = Limit (moveValue, limit);
-	rotateValue = Limit (rotateValue, limit) / rotateReduce;
-
-	if (moveValue >= 0.0)
-	{
-		if (rotateValue > 0.0)
-		{
-			frontLeft = moveValue - rotateValue;
-			frontRight = max (moveValue, rotateValue);
-		}
-		else
-		{
-			frontLeft = max (moveValue, -rotateValue);
-			frontRight = moveValue + rotateValue;
-		}
-	}
-	else
-	{
-		if (rotateValue > 0.0)
-		{
-			frontLeft = -max (-moveValue, rotateValue);
-			frontRight = moveValue + rotateValue;
-		}
-		else
-		{
-			frontLeft = moveValue - rotateValue;
-			frontRight = -max (-moveValue, -rotateValue);
-		}
-	}
-	
-	// Calculate the desired rear mecanum speeds.
-	float rearLeft  = frontLeft  * (0.5 + wheelRatio) + frontRight * (0.5 - wheelRatio);
-	float rearRight = frontRight * (0.5 + wheelRatio) + frontLeft  * (0.5 - wheelRatio);
-
-	// Scale the rear speeds down if either of them exceed 1
-	const float maxSpeed = max (fabs (rearLeft), fabs (rearRight));
-	if (maxSpeed > 1.0)
-	{
-		rearLeft /= maxSpeed;
-		rearRight /= maxSpeed;
-	}
+	m_driveChassis = &AdvancedRobotDrive::DriveChassisAs<Mode>;
+	m_driveAutonomous = &AdvancedRobotDrive::DriveAutonomousAs<Mode>;
+}
 
-	this->PowerMotors (frontLeft, rearLeft, frontRight, rearRight);
+/**
+ * @brief DriveChassis for a drive mode.
+ */
+template <DriveMode Mode>
+void AdvancedRobotDrive::DriveChassisAs(float move, float strafe, float rotate)
+{
+	float outputs[kDriveWheels];
+	DriveKinematics<Mode>::Mix(Limit(move, 1.0), Limit(strafe, 1.0), Limit(rotate, 1.0), outputs);
+	this->PowerMotors(outputs[kFrontLeftWheel], outputs[kRearLeftWheel],
+		outputs[kFrontRightWheel], outputs[kRearRightWheel]);
 }
 
 /**
- * @brief Drives the robot in Skid Steer drive mode. 
+ * @brief DriveAutonomous for a drive mode. When the wheels saturate the
+ * robot slows down rather than turning less, so it turns at the commanded
+ * rate whenever the drive can turn that fast.
+ */
+template <DriveMode Mode>
+void AdvancedRobotDrive::DriveAutonomousAs(float forward, float strafe, float turnRate)
+{
+	// A command of 1 drives the wheels at kDriveMaxSpeed
+	const float rotate = turnRate / (kDriveMaxSpeed * DriveKinematics<Mode>::RotationGain());
+	float outputs[kDriveWheels];
+	DriveKinematics<Mode>::MixTurnFirst(Limit(forward / kDriveMaxSpeed, 1.0),
+		Limit(strafe / kDriveMaxSpeed, 1.0), rotate, outputs);
+	this->PowerMotors(outputs[kFrontLeftWheel], outputs[kRearLeftWheel],
+		outputs[kFrontRightWheel], outputs[kRearRightWheel]);
+}
 
+/**
+ * @brief Stops the drive motors.
  */
-void AdvancedRobotDrive::DriveSkidSteer(FRCXboxJoystick& joystick)
+void AdvancedRobotDrive::Stop()
 {
-	m_safetyHelper->Feed();
-	//@TODO Derive math for SkidSteer.
+	this->StopMotor();
 }
 
 /**
- * @brief Drives the robot in Swivel Steer drive mode. 
+ * @brief Stops the drive motors, called by the motor safety when the
+ * drive has not been fed in time. The DriveSpeedController is stopped
+ * too, otherwise its task would start the motors again with the last
+ * setpoints.
  */
-void AdvancedRobotDrive::DriveSwivelSteer(FRCXboxJoystick& joystick)
+void AdvancedRobotDrive::StopMotor()
 {
-	m_safetyHelper->Feed();
-	//@TODO Derive math for SwivelSteer. (Do we even need this?)
+	RobotDrive::StopMotor();
+	m_speedController.Stop();
 }
 
 /**
@@ -236,7 +331,11 @@ float AdvancedRobotDrive::Limit(float input, float max)
 /**
  * @brief Powers the motors on the drive train. All values
  * are taken literally. No transormations are done on the
- * values fed into this class. 
+ * values fed into this class, the motor inversions for the
+ * drive mode are applied by the DriveKinematics. In the closed
+ * loop control modes the values are scaled by kDriveMaxRPM
+ * into speed setpoints, and in kDriveCRIOSpeedControl they
+ * are handed to the DriveSpeedController. 
  *
  * @param frontLeft The speed of the front left motor.
  * @param frontRight The speed of the front right motor.
@@ -251,41 +350,54 @@ void AdvancedRobotDrive::PowerMotors (
 		float rearRight)
 {
 	m_safetyHelper->Feed();
-	//I added this switch so that we can change what the power motors does for each drive mode. Sometimes
-	//values need to be reversed for a certain chassis. This would allow for that to happen.
-	switch (m_driveMode)
+	CommandBase::s_Log->SampleTelemetry(m_frontLeftChannel, frontLeft);
+	CommandBase::s_Log->SampleTelemetry(m_rearLeftChannel, rearLeft);
+	CommandBase::s_Log->SampleTelemetry(m_frontRightChannel, frontRight);
+	CommandBase::s_Log->SampleTelemetry(m_rearRightChannel, rearRight);
+
+	if (m_controlMode == kDriveCRIOSpeedControl)
 	{
-		case kMecanumDrive:
-			DriveMotors::m_rearRightMotor.SetOutput(rearRight);
-			DriveMotors::m_rearLeftMotor.SetOutput(rearLeft);
-			DriveMotors::m_frontRightMotor.SetOutput(frontRight);
-			DriveMotors::m_frontLeftMotor.SetOutput(frontLeft);
-			break;
-		case kBSBotDrive:
-			DriveMotors::m_rearRightMotor.SetOutput(-rearRight);
-			DriveMotors::m_rearLeftMotor.SetOutput(rearLeft);
-			DriveMotors::m_frontRightMotor.SetOutput(-frontRight);
-			DriveMotors::m_frontLeftMotor.SetOutput(frontLeft);
-			break;
-		case kSkidSteer:
-			DriveMotors::m_rearRightMotor.SetOutput(-rearRight);
-			DriveMotors::m_rearLeftMotor.SetOutput(rearLeft);
-			DriveMotors::m_frontRightMotor.SetOutput(-frontRight);
-			DriveMotors::m_frontLeftMotor.SetOutput(frontLeft);
-			break;
-		case kSwivelSteer:
-			DriveMotors::m_rearRightMotor.SetOutput(-rearRight);
-			DriveMotors::m_rearLeftMotor.SetOutput(rearLeft);
-			DriveMotors::m_frontRightMotor.SetOutput(-frontRight);
-			DriveMotors::m_frontLeftMotor.SetOutput(frontLeft);
-			break;
-		default:
-			DriveMotors::m_rearRightMotor.SetOutput(rearRight);
-			DriveMotors::m_rearLeftMotor.SetOutput(rearLeft);
-			DriveMotors::m_frontRightMotor.SetOutput(frontRight);
-			DriveMotors::m_frontLeftMotor.SetOutput(frontLeft);
-			break;
+		// The speed controller task drives the motors
+		float speeds[kDriveWheels];
+		speeds[kFrontLeftWheel] = frontLeft * m_outputScale;
+		speeds[kRearLeftWheel] = rearLeft * m_outputScale;
+		speeds[kFrontRightWheel] = frontRight * m_outputScale;
+		speeds[kRearRightWheel] = rearRight * m_outputScale;
+		m_speedController.SetSpeeds(speeds);
+	}
+	else
+	{
+		const UINT32 writeCount = RampedCANJaguar::GetWriteCount();
+
+		DriveMotors::m_rearRightMotor.SetOutput(rearRight * m_outputScale);
+		DriveMotors::m_rearLeftMotor.SetOutput(rearLeft * m_outputScale);
+		DriveMotors::m_frontRightMotor.SetOutput(frontRight * m_outputScale);
+		DriveMotors::m_frontLeftMotor.SetOutput(frontLeft * m_outputScale);
+
+		// Only apply the sync group if one of the setpoints was sent
+		if (RampedCANJaguar::GetWriteCount() != writeCount)
+		{
+			RampedCANJaguar::UpdateSyncGroup(kDriveSyncGroup);
+		}
 	}
-	
+	UpdateCANRate();
+
 	m_safetyHelper->Feed();
 }
+
+/**
+ * @brief Updates the CAN message rate once a second and samples it to
+ * the telemetry every cycle.
+ */
+void AdvancedRobotDrive::UpdateCANRate()
+{
+	const UINT32 curTime = RobotClock::GetTime();
+	if (curTime - m_canRateStartTime >= 1000000)
+	{
+		const UINT32 count = RampedCANJaguar::GetMessageCount();
+		m_canRate = (INT32)((count - m_canRateStartCount) * 1e6 / (curTime - m_canRateStartTime));
+		m_canRateStartTime = curTime;
+		m_canRateStartCount = count;
+	}
+	CommandBase::s_Log->SampleTelemetry(m_canRateChannel, m_canRate);
+}
@@ -2,8 +2,10 @@
 #define ADVANCEDROBOTDRIVE_H
 #include <WPILib.h>
 #include "../Robotmap.h"
-#include "FRCXboxJoystick.h"
-#include "RampedCanJaguar.h"
+#include "RampedCANJaguar.h"
+#include "DriveKinematics.h"
+#include "PoseEstimator.h"
+#include "DriveSpeedController.h"
 
 /** @brief Initializes the drive motors
  *
@@ -17,6 +19,9 @@ public:
 	mutable RampedCANJaguar m_frontRightMotor;
 	mutable RampedCANJaguar m_rearLeftMotor;
 	mutable RampedCANJaguar m_rearRightMotor;
+
+private:
+	static void ConfigEncoder(RampedCANJaguar& motor);
 };
 
 class AdvancedRobotDrive:
@@ -25,10 +30,29 @@ class AdvancedRobotDrive:
 {
 public:
 	AdvancedRobotDrive(DriveMode mode);
-	void DriveRobot(FRCXboxJoystick &joystick);
-	void DriveAutonomous();
+	void DriveRobot(float moveValue, float strafeValue, float rotateValue);
+	void DriveAutonomous(float forward, float strafe, float turnRate);
+	void DriveChassis(float move, float strafe, float rotate);
 
 	void Stop();
+	virtual void StopMotor();
+
+	/**
+	 * @brief Returns the latest pose estimated from the drive encoders.
+	 * The pose stays at the origin unless kUseEncoders is set.
+	 */
+	inline RobotPose GetPose() const
+	{
+		return m_poseEstimator.GetPose();
+	}
+
+	/**
+	 * @brief Makes the current position of the robot the origin of the pose.
+	 */
+	inline void ResetPose()
+	{
+		m_poseEstimator.Reset();
+	}
 
 	/**
 	 * @brief Returns whether or not the drive system is alive.
@@ -39,15 +63,41 @@ public:
     }
 
 private:
-	void DriveMecanum(FRCXboxJoystick& joystick);
-	void DriveBSBot(FRCXboxJoystick& joystick);
-	void DriveSkidSteer(FRCXboxJoystick& joystick);
-	void DriveSwivelSteer(FRCXboxJoystick& joystick);
-
 	void PowerMotors(float frontLeft, float rearLeft, float frontRight, float rearRight);
 	float Limit(float input, float max);
+	void UpdateCANRate();
+	void ConfigControlMode();
+	static void ConfigJaguarSpeedControl(RampedCANJaguar& motor);
+	template <DriveMode Mode> void SelectDriveMode();
+	template <DriveMode Mode> void DriveChassisAs(float move, float strafe, float rotate);
+	template <DriveMode Mode> void DriveAutonomousAs(float forward, float strafe, float turnRate);
+
+	typedef void (AdvancedRobotDrive::*DriveFunction)(float, float, float);
 
 	DriveMode m_driveMode;
+	//! DriveChassisAs and DriveAutonomousAs for the drive mode
+	DriveFunction m_driveChassis;
+	DriveFunction m_driveAutonomous;
+	PoseEstimator m_poseEstimator;
+	DriveSpeedController m_speedController;
+	//! The control mode in use, kDriveControlMode unless it needs encoders we do not have
+	DriveControlMode m_controlMode;
+	//! The mixer outputs are multiplied by this to give the motor setpoints
+	float m_outputScale;
+
+	//! Telemetry channels for the driver inputs and the motor outputs
+	int m_moveChannel;
+	int m_rotateChannel;
+	int m_frontLeftChannel;
+	int m_rearLeftChannel;
+	int m_frontRightChannel;
+	int m_rearRightChannel;
+
+	//! The CAN messages per second sent to the drive Jaguars
+	int m_canRateChannel;
+	UINT32 m_canRateStartTime;
+	UINT32 m_canRateStartCount;
+	INT32 m_canRate;
 
 	/**
 	 * @brief Returns the square of the val preserving the sign of val
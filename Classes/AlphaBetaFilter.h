@@ -2,7 +2,7 @@
 #define ALPHA_BETA_FILTER_H_
 
 #include <ostream>
-#include <vector>
+#include "RingBuffer.h"
 
 /** @brief Implements an Alpha-Beta filter
  *
@@ -14,19 +14,28 @@
  *
  * When logging is enabled the values are added to a container rather than being
  * written directly to the log.  This is to keep the filter running fast and
- * not be bogged down with slow IO code.
+ * not be bogged down with slow IO code.  The container is a fixed capacity
+ * ring buffer, so logging never allocates memory, and it may be drained by
+ * \c WriteLog or \c DrainHistory from another task while the filter carries
+ * on updating.  If the history is not drained fast enough the newest entries
+ * are dropped.  \c HistoryCapacity must be a power of 2.  The history is
+ * only allocated the first time logging is enabled, so a filter that never
+ * logs does not carry it around.
  *
  * @author Stephen Nutt
- * @version 1.0
+ * @version 1.1
  */
-template <typename T>
+template <typename T, unsigned HistoryCapacity = 1024>
 class AlphaBetaFilter
 {
 public:
+	struct FilterHistory;
+
 	//! Initializes everything in the filter to 0
 	inline AlphaBetaFilter () :
 		m_lastTime(), m_alpha(), m_beta(), m_value(), m_rateOfChange(),
-		m_enableLogging (false), m_hasValue (false)
+		m_enableLogging (false), m_hasValue (false), m_headerWritten (false),
+		m_history (0)
 	{
 	}
 
@@ -34,8 +43,48 @@ public:
 	//! gains, everything else is initialized to 0
 	inline AlphaBetaFilter (const T& alpha, const T& beta) :
 		m_lastTime(), m_alpha(alpha), m_beta(beta), m_value(), m_rateOfChange(),
-		m_enableLogging (false), m_hasValue (false)
+		m_enableLogging (false), m_hasValue (false), m_headerWritten (false),
+		m_history (0)
+	{
+	}
+
+	//! Copies the filter state.  The copy starts with an empty history.
+	inline AlphaBetaFilter (const AlphaBetaFilter& other) :
+		m_lastTime(other.m_lastTime), m_alpha(other.m_alpha), m_beta(other.m_beta),
+		m_value(other.m_value), m_rateOfChange(other.m_rateOfChange),
+		m_enableLogging (false), m_hasValue (other.m_hasValue),
+		m_headerWritten (false), m_history (0)
+	{
+		if (other.m_enableLogging)
+		{
+			EnableLogging();
+		}
+	}
+
+	//! Frees the history
+	inline ~AlphaBetaFilter ()
 	{
+		delete m_history;
+	}
+
+	//! Copies the filter state, keeping this filter's history
+	inline AlphaBetaFilter& operator= (const AlphaBetaFilter& other)
+	{
+		m_lastTime = other.m_lastTime;
+		m_alpha = other.m_alpha;
+		m_beta = other.m_beta;
+		m_value = other.m_value;
+		m_rateOfChange = other.m_rateOfChange;
+		m_hasValue = other.m_hasValue;
+		if (other.m_enableLogging)
+		{
+			EnableLogging();
+		}
+		else
+		{
+			DisableLogging();
+		}
+		return *this;
 	}
 
 	//! Clears the filter
@@ -71,11 +120,16 @@ public:
 		m_hasValue = true;
 	}
 
-	//! Initializes the logging for the filter
+	//! Initializes the logging for the filter, allocating the history the
+	//! first time
 	inline void EnableLogging()
 	{
+		if (m_history == 0)
+		{
+			m_history = new HistoryContainer;
+			MemoryBarrier();
+		}
 		m_enableLogging = true;
-		m_history.reserve (1000);
 	}
 
 	//! Disabled the filter logging
@@ -91,15 +145,46 @@ public:
 	}
 
 	//! Writes the filter's history to the specified stream in a comma
-	//! delimitered file format with a header line
+	//! delimitered file format, removing it from the history.  The header
+	//! line is written by the first call only, so the history can be
+	//! drained into the same file periodically.  This may be called from a
+	//! task other than the one updating the filter.
 	void WriteLog (std::ostream& os)
 	{
-		FilterHistory::WriteHeader (os);
-		for (typename HistoryContainer::const_iterator i =
-			m_history.begin(); i != m_history.end(); ++i)
+		if (m_history == 0)
+		{
+			return;
+		}
+		if (m_headerWritten == false)
+		{
+			FilterHistory::WriteHeader (os);
+			m_headerWritten = true;
+		}
+		FilterHistory item;
+		while (m_history->Pop (item))
+		{
+			os << item;
+		}
+	}
+
+	//! Moves up to \c maxCount of the oldest history entries into \c items,
+	//! returning the number moved.  This may be called from a task other than
+	//! the one updating the filter.
+	unsigned DrainHistory (FilterHistory* items, unsigned maxCount)
+	{
+		unsigned count = 0;
+		while (m_history != 0 && count < maxCount && m_history->Pop (items[count]))
 		{
-			os << *i;
+			++count;
 		}
+		return count;
+	}
+
+	//! Returns the number of history entries dropped because the history
+	//! was full
+	inline unsigned GetDroppedHistoryCount() const
+	{
+		return (m_history != 0) ? m_history->GetDroppedCount() : 0;
 	}
 
 	//! Updates the filter with using the new measured value and
@@ -130,15 +215,18 @@ public:
 			// history container.
 			if (m_enableLogging)
 			{
-				m_history.resize (m_history.size() + 1);
-				FilterHistory& last = m_history.back();
-				last.m_measuredVal = measuredVal;
-				last.m_time = measurementTime;
-				last.m_dTime = dTime;
-				last.m_predictedValue = predictedValue;
-				last.m_residual = residual;
-				last.m_rateOfChange = m_rateOfChange;
-				last.m_value = m_value;
+				FilterHistory* const last = m_history->BeginPush();
+				if (last != 0)
+				{
+					last->m_measuredVal = measuredVal;
+					last->m_time = measurementTime;
+					last->m_dTime = dTime;
+					last->m_predictedValue = predictedValue;
+					last->m_residual = residual;
+					last->m_rateOfChange = m_rateOfChange;
+					last->m_value = m_value;
+					m_history->EndPush();
+				}
 			}
 		}
 
@@ -167,7 +255,6 @@ public:
 		return m_rateOfChange;
 	}
 
-private:
 	/** @brief Contains the evaluation state of the filter for a single reading
 	 *
 	 * @version 1.0
@@ -207,8 +294,9 @@ private:
 		}
 	};
 
+private:
 	//! The container type used for the filter logging
-	typedef std::vector<FilterHistory> HistoryContainer;
+	typedef RingBuffer<FilterHistory, HistoryCapacity> HistoryContainer;
 
 	UINT32 m_lastTime;			//!< Time of last measurement
 	T m_alpha;					//!< Alpha correction gain, used to smooth the value
@@ -217,7 +305,8 @@ private:
 	T m_rateOfChange;			//!< The smoothed rate of change of the value
 	bool m_enableLogging;		//!< When set to true, the filter state is stored in \c m_history
 	bool m_hasValue;			//!< When set to false, the filter has yet to be seeded or fed a value
-	HistoryContainer m_history;	//!< The filter history, only used for logging purposes
+	bool m_headerWritten;		//!< Set once \c WriteLog has written the header line
+	HistoryContainer* m_history;	//!< The filter history, only used for logging purposes
 };
 
 #endif
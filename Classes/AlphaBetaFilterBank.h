@@ -0,0 +1,196 @@
+#ifndef ALPHA_BETA_FILTER_BANK_H_
+#define ALPHA_BETA_FILTER_BANK_H_
+
+/** @brief Implements a bank of \c N Alpha-Beta filters that are all
+ * updated at the same time
+ *
+ * This behaves like \c N separate \c AlphaBetaFilter objects that are always
+ * updated together with the same measurement time, for example the axes of
+ * the accelerometer or the four wheel speeds.  Sharing the time means the
+ * time increment and its reciprocal are calculated once per update rather
+ * than once per signal, and the per-channel state is stored as separate
+ * arrays (structure of arrays) so that the update is a single loop over
+ * contiguous memory which the compiler can unroll and, on targets with
+ * vector units, vectorize.
+ *
+ * The semantics follow \c AlphaBetaFilter: an unseeded channel takes the
+ * first measured value as its value, and \c SeedFilter and \c Clear work
+ * per channel.  Because all channels share a measurement time, seeding a
+ * channel also sets the time of the last measurement for the whole bank.
+ * The arithmetic is done in \c T rather than \c double, so a \c float bank
+ * differs from \c AlphaBetaFilter<float> by float rounding only.
+ *
+ * @version 1.0
+ */
+template <typename T, unsigned N>
+class AlphaBetaFilterBank
+{
+public:
+	//! Initializes everything in the filter bank to 0
+	inline AlphaBetaFilterBank () :
+		m_lastTime(), m_unseededCount (N)
+	{
+		for (unsigned i = 0; i < N; ++i)
+		{
+			m_alpha[i] = m_beta[i] = m_value[i] = m_rateOfChange[i] = T();
+			m_hasValue[i] = false;
+		}
+	}
+
+	//! Initializes the filter bank using the same alpha and beta correction
+	//! gains for every channel, everything else is initialized to 0
+	inline AlphaBetaFilterBank (const T& alpha, const T& beta) :
+		m_lastTime(), m_unseededCount (N)
+	{
+		for (unsigned i = 0; i < N; ++i)
+		{
+			m_alpha[i] = alpha;
+			m_beta[i] = beta;
+			m_value[i] = m_rateOfChange[i] = T();
+			m_hasValue[i] = false;
+		}
+	}
+
+	//! Clears every channel in the bank
+	inline void Clear()
+	{
+		for (unsigned i = 0; i < N; ++i)
+		{
+			m_hasValue[i] = false;
+			m_value[i] = T();
+		}
+		m_unseededCount = N;
+	}
+
+	//! Clears a single channel
+	inline void Clear (unsigned channel)
+	{
+		if (m_hasValue[channel])
+		{
+			m_hasValue[channel] = false;
+			++m_unseededCount;
+		}
+		m_value[channel] = T();
+	}
+
+	//! Sets the alpha beta correction gains of a single channel
+	inline void SetCorrectionGains (unsigned channel, const T& alpha, const T& beta)
+	{
+		m_alpha[channel] = alpha;
+		m_beta[channel] = beta;
+	}
+
+	//! Seeds a channel with an initial value and rate of change at a
+	//! given time
+	inline void SeedFilter (unsigned channel, const T& value, const T& speed, const UINT32 now)
+	{
+		m_rateOfChange[channel] = speed;
+		SeedFilter (channel, value, now);
+	}
+
+	//! Seeds a channel with an initial value at a given time but does not
+	//! change the rate of change
+	inline void SeedFilter (unsigned channel, const T& value, const UINT32 now)
+	{
+		m_value[channel] = value;
+		m_lastTime = now;
+		if (m_hasValue[channel] == false)
+		{
+			m_hasValue[channel] = true;
+			--m_unseededCount;
+		}
+	}
+
+	//! Updates every channel using the \c N new measured values, all taken
+	//! at the same measurement time, returning the \c N smoothed values
+	const T* Update (const T* measuredVals, const UINT32 measurementTime)
+	{
+		const T dTime = static_cast<T> ((measurementTime - m_lastTime) * 1e-6);
+
+		if (m_unseededCount == 0)
+		{
+			// Every channel has a value so run the branch free update
+			const T invDTime = T(1) / dTime;
+			const T* __restrict__ measured = measuredVals;
+			T* __restrict__ value = m_value;
+			T* __restrict__ rateOfChange = m_rateOfChange;
+			const T* __restrict__ alpha = m_alpha;
+			const T* __restrict__ beta = m_beta;
+			for (unsigned i = 0; i < N; ++i)
+			{
+				const T predictedValue = value[i] + rateOfChange[i] * dTime;
+				const T residual = measured[i] - predictedValue;
+				value[i] = predictedValue + alpha[i] * residual;
+				rateOfChange[i] += beta[i] * residual * invDTime;
+			}
+		}
+		else
+		{
+			// Some channels are taking their first value, see
+			// AlphaBetaFilter::Update
+			for (unsigned i = 0; i < N; ++i)
+			{
+				if (m_hasValue[i] == false)
+				{
+					m_value[i] = measuredVals[i];
+					m_hasValue[i] = true;
+				}
+				else
+				{
+					const T predictedValue = m_value[i] + m_rateOfChange[i] * dTime;
+					const T residual = measuredVals[i] - predictedValue;
+					m_value[i] = predictedValue + m_alpha[i] * residual;
+					m_rateOfChange[i] += m_beta[i] * residual / dTime;
+				}
+			}
+			m_unseededCount = 0;
+		}
+
+		// Set the last measurement time
+		m_lastTime = measurementTime;
+
+		return m_value;
+	}
+
+	//! Returns the current filter values, the same as the last values
+	//! returned by \c Update
+	inline const T* GetValues() const
+	{
+		return m_value;
+	}
+
+	//! Returns the current value of a single channel
+	inline const T& GetValue (unsigned channel) const
+	{
+		return m_value[channel];
+	}
+
+	//! Returns the rate of change of a single channel
+	inline const T& GetRateOfChange (unsigned channel) const
+	{
+		return m_rateOfChange[channel];
+	}
+
+	//! Returns the time of the last measurement passed to \c Update
+	inline UINT32 GetLastMeasurementTime() const
+	{
+		return m_lastTime;
+	}
+
+	//! Returns the number of channels in the bank
+	static inline unsigned GetChannelCount()
+	{
+		return N;
+	}
+
+private:
+	UINT32 m_lastTime;				//!< Time of last measurement
+	unsigned m_unseededCount;		//!< The number of channels without a value
+	T m_value[N] __attribute__ ((aligned (16)));		//!< The smoothed values
+	T m_rateOfChange[N] __attribute__ ((aligned (16)));	//!< The smoothed rates of change
+	T m_alpha[N] __attribute__ ((aligned (16)));		//!< Alpha correction gains
+	T m_beta[N] __attribute__ ((aligned (16)));			//!< Beta correction gains
+	bool m_hasValue[N];				//!< False until a channel has been seeded or fed a value
+};
+
+#endif
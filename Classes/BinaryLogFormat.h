@@ -0,0 +1,69 @@
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+/**
+ * @brief The layout of the binary logfile written by LogSystem when it is
+ * in kLogFormatBinary mode. This header is shared with the host side
+ * decoder in Tools/LogDecoder.cpp, so it must not include any WPILib or
+ * VxWorks headers.
+ *
+ * A binary logfile starts with a BinaryLogHeader followed by a stream of
+ * BinaryLogRecords. Messages are interned, so the text of a message is only
+ * written once, in a kBinaryLogString record that maps the message ID to its
+ * text. Every other record only carries the ID. A kBinaryLogString or
+ * kBinaryLogText record is followed by m_length characters of text, with no
+ * terminating null.
+ *
+ * Records are written in the byte order of the robot. The decoder uses
+ * m_byteOrder in the header to detect when it needs to swap bytes.
+ */
+
+//! "NFLG", the first four bytes of every binary logfile
+static const unsigned int kBinaryLogMagic = 0x4E464C47;
+//! The version of the binary log format
+static const unsigned short kBinaryLogVersion = 1;
+//! Written in the native byte order to allow the decoder to detect swapping
+static const unsigned int kBinaryLogByteOrder = 0x01020304;
+//! The message ID used for messages that could not be interned
+static const unsigned short kBinaryLogNoMessageId = 0xFFFF;
+
+/**
+ * @brief The types of record found in a binary logfile.
+ */
+enum BinaryLogRecordType
+{
+	kBinaryLogMessage = 1,		//!< An interned message
+	kBinaryLogValue = 2,		//!< An interned message with a numeric value
+	kBinaryLogString = 3,		//!< Defines the text of a message ID
+	kBinaryLogText = 4,			//!< A message that was not interned, followed by its text
+	kBinaryLogDropped = 5		//!< m_length messages were dropped
+};
+
+/**
+ * @brief The header at the start of every binary logfile.
+ */
+struct BinaryLogHeader
+{
+	unsigned int m_magic;		//!< Always kBinaryLogMagic
+	unsigned int m_byteOrder;	//!< Always kBinaryLogByteOrder in the writer's byte order
+	unsigned short m_version;	//!< The format version, kBinaryLogVersion
+	unsigned short m_recordSize;//!< sizeof (BinaryLogRecord)
+};
+
+/**
+ * @brief A single fixed size record in a binary logfile.
+ */
+struct BinaryLogRecord
+{
+	unsigned int m_time;		//!< The FPGA time in microseconds
+	unsigned char m_type;		//!< One of BinaryLogRecordType
+	unsigned char m_priority;	//!< The LogPriority of the message
+	unsigned short m_messageId;	//!< The interned message ID
+	union
+	{
+		float m_value;			//!< The value of a kBinaryLogValue record
+		unsigned int m_length;	//!< The length of the text following the record
+	};
+};
+
+#endif
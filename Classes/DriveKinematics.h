@@ -0,0 +1,380 @@
+#ifndef DRIVEKINEMATICS_H
+#define DRIVEKINEMATICS_H
+
+#include "../Robotmap.h"
+#include <math.h>
+
+/**
+ * @brief The index of each wheel in the drive outputs.
+ */
+enum DriveWheel
+{
+	kFrontLeftWheel = 0,
+	kRearLeftWheel = 1,
+	kFrontRightWheel = 2,
+	kRearRightWheel = 3,
+	kDriveWheels = 4,
+};
+
+/** @brief The wheel geometry of the robot, in inches.
+ *
+ * The geometry is given as inline functions rather than constants so that
+ * it can be passed as a template parameter to DriveKinematics and still
+ * fold into the kinematics at compile time.
+ *
+ * @author Stephen Nutt
+ */
+struct RobotGeometry
+{
+	//! The robot wheel base
+	static inline float WheelBase() { return 25.0; }
+	//! The robot track (assumes front and rear track is the same)
+	static inline float WheelTrack() { return 22.25; }
+	//! The ratio of wheelBase to wheelTrack
+	static inline float WheelRatio() { return WheelBase() / WheelTrack(); }
+	//! The diameter of the Big Wheels on the BS Bot
+	static inline float BigWheelDiameter() { return 12.5; }
+	//! The diameter of the BS bot's Mecanum wheels
+	static inline float MecanumWheelDiameter() { return 5.5; }
+	//! The rotate command is divided by this in the BSBot and skid steer modes
+	static inline float RotateReduce() { return 1.5; }
+};
+
+/** @brief Operations on a set of wheel speeds shared by the drive modes.
+ */
+struct WheelSpeeds
+{
+	//! Returns the largest wheel speed magnitude, or 1 if they are all less
+	static inline float MaxMagnitude(const float wheels[kDriveWheels])
+	{
+		float maxMagnitude = 1.0;
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			const float magnitude = fabs(wheels[i]);
+			if (magnitude > maxMagnitude)
+			{
+				maxMagnitude = magnitude;
+			}
+		}
+		return maxMagnitude;
+	}
+
+	//! Scales the wheel speeds down together if any of them exceeds 1,
+	//! which keeps the ratios between the wheels and so the direction of
+	//! travel
+	static inline void ScaleToFit(float wheels[kDriveWheels])
+	{
+		const float scale = 1.0 / MaxMagnitude(wheels);
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			wheels[i] *= scale;
+		}
+	}
+};
+
+/** @brief The wheel speeds of each drive mode.
+ *
+ * Each specialization gives the rows of the drive mode's mixing matrix as
+ * expressions, with one row per wheel giving how much of the move, strafe
+ * and rotate command the wheel gets, and the inversion of each wheel's
+ * motor. Drive gives the wheel speeds for a driver's command, each within
+ * -1 to 1, which is the linear mix scaled to fit except on the BSBot.
+ *
+ * Each also gives the forward kinematics used for odometry: the diameter
+ * of each wheel, and how far the robot moved given how far each wheel
+ * travelled.
+ */
+template <DriveMode Mode, class Geometry>
+struct DriveModeMix;
+
+//! The standard mecanum mix, strafing moves the diagonals opposite ways
+template <class Geometry>
+struct DriveModeMix<kMecanumDrive, Geometry>
+{
+	static inline void Wheels(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		wheels[kFrontLeftWheel]  = move + strafe - rotate;
+		wheels[kRearLeftWheel]   = move - strafe - rotate;
+		wheels[kFrontRightWheel] = move - strafe + rotate;
+		wheels[kRearRightWheel]  = move + strafe + rotate;
+	}
+
+	static inline void Drive(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		Wheels(move, strafe, rotate, wheels);
+		WheelSpeeds::ScaleToFit(wheels);
+	}
+
+	static inline float Inversion(int wheel)
+	{
+		return 1.0;
+	}
+
+	static inline float WheelDiameter(int wheel)
+	{
+		return Geometry::MecanumWheelDiameter();
+	}
+
+	static inline void Motion(const float distances[kDriveWheels], float& forward, float& strafe, float& rotation)
+	{
+		const float fl = distances[kFrontLeftWheel];
+		const float rl = distances[kRearLeftWheel];
+		const float fr = distances[kFrontRightWheel];
+		const float rr = distances[kRearRightWheel];
+		forward = (fl + rl + fr + rr) * 0.25;
+		strafe = (fl - rl - fr + rr) * 0.25;
+		rotation = (fr + rr - fl - rl) * 0.5 / (Geometry::WheelBase() + Geometry::WheelTrack());
+	}
+};
+
+//! The rear mecanum wheels are set from the big front wheels so that the
+//! rear of the robot swings about the front axle, which multiplies the
+//! rotate gain by twice the wheel ratio.
+//!
+//! Drive keeps the driver's feel of the original DriveBSBot: the front
+//! wheels mix like arcade drive, where the outside wheel gets the larger
+//! of the move and the turn rather than their sum, and only the rear
+//! wheels are scaled down when they saturate.
+template <class Geometry>
+struct DriveModeMix<kBSBotDrive, Geometry>
+{
+	static inline void Wheels(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		const float front = rotate / Geometry::RotateReduce();
+		const float rear = 2.0 * Geometry::WheelRatio() * front;
+		wheels[kFrontLeftWheel]  = move - front;
+		wheels[kRearLeftWheel]   = move - rear;
+		wheels[kFrontRightWheel] = move + front;
+		wheels[kRearRightWheel]  = move + rear;
+	}
+
+	static inline void Drive(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		move = Limit(move);
+		rotate = Limit(rotate) / Geometry::RotateReduce();
+		float left;
+		float right;
+		if (move >= 0.0)
+		{
+			left = (rotate > 0.0) ? move - rotate : Max(move, -rotate);
+			right = (rotate > 0.0) ? Max(move, rotate) : move + rotate;
+		}
+		else
+		{
+			left = (rotate > 0.0) ? -Max(-move, rotate) : move - rotate;
+			right = (rotate > 0.0) ? move + rotate : -Max(-move, -rotate);
+		}
+
+		// The rear wheels turn about the front axle
+		const float ratio = Geometry::WheelRatio();
+		float rearLeft = left * (0.5 + ratio) + right * (0.5 - ratio);
+		float rearRight = right * (0.5 + ratio) + left * (0.5 - ratio);
+		const float rearMax = Max(fabs(rearLeft), fabs(rearRight));
+		if (rearMax > 1.0)
+		{
+			rearLeft /= rearMax;
+			rearRight /= rearMax;
+		}
+
+		wheels[kFrontLeftWheel]  = left;
+		wheels[kRearLeftWheel]   = rearLeft;
+		wheels[kFrontRightWheel] = right;
+		wheels[kRearRightWheel]  = rearRight;
+	}
+
+	static inline float Inversion(int wheel)
+	{
+		return (wheel == kFrontRightWheel || wheel == kRearRightWheel) ? -1.0 : 1.0;
+	}
+
+	static inline float WheelDiameter(int wheel)
+	{
+		return (wheel == kFrontLeftWheel || wheel == kFrontRightWheel) ?
+			Geometry::BigWheelDiameter() : Geometry::MecanumWheelDiameter();
+	}
+
+	//! Only the big front wheels are used, the rear mecanum wheels slip
+	//! sideways as the rear of the robot swings
+	static inline void Motion(const float distances[kDriveWheels], float& forward, float& strafe, float& rotation)
+	{
+		const float left = distances[kFrontLeftWheel];
+		const float right = distances[kFrontRightWheel];
+		forward = (left + right) * 0.5;
+		strafe = 0.0;
+		rotation = (right - left) / Geometry::WheelTrack();
+	}
+
+private:
+	static inline float Limit(float value)
+	{
+		return (value > 1.0) ? 1.0 : ((value < -1.0) ? -1.0 : value);
+	}
+
+	static inline float Max(float a, float b)
+	{
+		return (a > b) ? a : b;
+	}
+};
+
+//! Both sides turn together like a tank
+template <class Geometry>
+struct DriveModeMix<kSkidSteer, Geometry>
+{
+	static inline void Wheels(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		const float turn = rotate / Geometry::RotateReduce();
+		wheels[kFrontLeftWheel]  = move - turn;
+		wheels[kRearLeftWheel]   = move - turn;
+		wheels[kFrontRightWheel] = move + turn;
+		wheels[kRearRightWheel]  = move + turn;
+	}
+
+	static inline void Drive(float move, float strafe, float rotate, float wheels[kDriveWheels])
+	{
+		Wheels(move, strafe, rotate, wheels);
+		WheelSpeeds::ScaleToFit(wheels);
+	}
+
+	static inline float Inversion(int wheel)
+	{
+		return (wheel == kFrontRightWheel || wheel == kRearRightWheel) ? -1.0 : 1.0;
+	}
+
+	static inline float WheelDiameter(int wheel)
+	{
+		return Geometry::MecanumWheelDiameter();
+	}
+
+	static inline void Motion(const float distances[kDriveWheels], float& forward, float& strafe, float& rotation)
+	{
+		const float left = (distances[kFrontLeftWheel] + distances[kRearLeftWheel]) * 0.5;
+		const float right = (distances[kFrontRightWheel] + distances[kRearRightWheel]) * 0.5;
+		forward = (left + right) * 0.5;
+		strafe = 0.0;
+		rotation = (right - left) / Geometry::WheelTrack();
+	}
+};
+
+//! Swivel steer drives its wheels the same way as skid steer
+template <class Geometry>
+struct DriveModeMix<kSwivelSteer, Geometry> :
+	public DriveModeMix<kSkidSteer, Geometry>
+{
+};
+
+/** @brief The drive kinematics of a drive mode, fixed at compile time.
+ *
+ * Turns a move, strafe and rotate command into the four motor outputs,
+ * and the motor encoder positions back into the motion of the robot.
+ * Mix uses the drive mode's Drive mix, which scales the wheel speeds down
+ * together if any of them exceeds 1 except on the BSBot, see
+ * DriveModeMix, and then applies the motor inversions. Because the mode and
+ * geometry are template parameters the whole calculation inlines with the
+ * gains folded into constants.
+ *
+ * MixTurnFirst desaturates differently, scaling down only the move and
+ * strafe so that the robot turns at RotationGain times the rotate command
+ * whenever it can. AdvancedRobotDrive uses it in autonomous, where the turn
+ * rate matters more than the speed.
+ *
+ * AdvancedRobotDrive instantiates its drive functions for each mode and
+ * chooses between them at run time, and DriveMixer does the same for code
+ * that is not templated.
+ *
+ * @version 1.0
+ */
+template <DriveMode Mode, class Geometry = RobotGeometry>
+class DriveKinematics
+{
+public:
+	//! Mixes a drive command, each -1 to 1, into the motor outputs indexed
+	//! by DriveWheel.  Rotation is anticlockwise.
+	static inline void Mix(float move, float strafe, float rotate, float outputs[kDriveWheels])
+	{
+		DriveModeMix<Mode, Geometry>::Drive(move, strafe, rotate, outputs);
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			outputs[i] *= DriveModeMix<Mode, Geometry>::Inversion(i);
+		}
+	}
+
+	//! Mixes a drive command with the linear mix, and if a wheel saturates
+	//! only the move and strafe are scaled down, so the rotation is kept. The rotate
+	//! command is limited to MaxRotate. The mixes are linear, so the turn
+	//! and the travel can be worked out separately and added.
+	static inline void MixTurnFirst(float move, float strafe, float rotate, float outputs[kDriveWheels])
+	{
+		const float maxRotate = MaxRotate();
+		if (rotate > maxRotate)
+		{
+			rotate = maxRotate;
+		}
+		else if (rotate < -maxRotate)
+		{
+			rotate = -maxRotate;
+		}
+		float turn[kDriveWheels];
+		DriveModeMix<Mode, Geometry>::Wheels(0.0, 0.0, rotate, turn);
+		DriveModeMix<Mode, Geometry>::Wheels(move, strafe, 0.0, outputs);
+
+		// The largest fraction of the travel that fits beside the turn
+		float scale = 1.0;
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			if (fabs(turn[i] + outputs[i]) > 1.0)
+			{
+				const float room = ((outputs[i] > 0.0) ? 1.0 : -1.0) - turn[i];
+				const float fraction = room / outputs[i];
+				if (fraction < scale)
+				{
+					scale = (fraction > 0.0) ? fraction : 0.0;
+				}
+			}
+		}
+
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			outputs[i] = (turn[i] + scale * outputs[i]) * DriveModeMix<Mode, Geometry>::Inversion(i);
+		}
+	}
+
+	//! Returns how far the robot moved, in inches and radians, given the
+	//! change in the motor encoder positions in revolutions. The motor
+	//! inversions are undone so that forward is positive on every wheel.
+	static inline void Odometry(const float revolutions[kDriveWheels], float& forward, float& strafe, float& rotation)
+	{
+		float distances[kDriveWheels];
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			distances[i] = revolutions[i] * DriveModeMix<Mode, Geometry>::Inversion(i) *
+				3.14159265 * DriveModeMix<Mode, Geometry>::WheelDiameter(i);
+		}
+		DriveModeMix<Mode, Geometry>::Motion(distances, forward, strafe, rotation);
+	}
+
+	//! Returns the rotation, in radians per inch of wheel travel, that a
+	//! rotate command of 1 gives before desaturation. Mix scales the
+	//! rotation down with the other wheels when a wheel saturates, so this
+	//! only holds for MixTurnFirst with rotate commands up to MaxRotate.
+	static inline float RotationGain()
+	{
+		float wheels[kDriveWheels];
+		float forward;
+		float strafe;
+		float rotation;
+		DriveModeMix<Mode, Geometry>::Wheels(0.0, 0.0, 1.0, wheels);
+		DriveModeMix<Mode, Geometry>::Motion(wheels, forward, strafe, rotation);
+		return rotation;
+	}
+
+	//! Returns the largest rotate command that does not saturate a wheel,
+	//! which gives the fastest turn the robot can make
+	static inline float MaxRotate()
+	{
+		float wheels[kDriveWheels];
+		DriveModeMix<Mode, Geometry>::Wheels(0.0, 0.0, 1.0, wheels);
+		return 1.0 / WheelSpeeds::MaxMagnitude(wheels);
+	}
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "DriveMixer.h"
+
+/**
+ * @brief Chooses the kinematics for a drive mode.
+ * @param mode The drive mode.
+ *
+ * @author Stephen Nutt
+ */
+DriveMixer::DriveMixer(DriveMode mode)
+{
+	switch (mode)
+	{
+		case kMecanumDrive:
+			m_mix = &DriveKinematics<kMecanumDrive>::Mix;
+			m_odometry = &DriveKinematics<kMecanumDrive>::Odometry;
+			m_rotationGain = DriveKinematics<kMecanumDrive>::RotationGain();
+			break;
+		case kSkidSteer:
+			m_mix = &DriveKinematics<kSkidSteer>::Mix;
+			m_odometry = &DriveKinematics<kSkidSteer>::Odometry;
+			m_rotationGain = DriveKinematics<kSkidSteer>::RotationGain();
+			break;
+		case kSwivelSteer:
+			m_mix = &DriveKinematics<kSwivelSteer>::Mix;
+			m_odometry = &DriveKinematics<kSwivelSteer>::Odometry;
+			m_rotationGain = DriveKinematics<kSwivelSteer>::RotationGain();
+			break;
+		case kBSBotDrive:
+		default:
+			m_mix = &DriveKinematics<kBSBotDrive>::Mix;
+			m_odometry = &DriveKinematics<kBSBotDrive>::Odometry;
+			m_rotationGain = DriveKinematics<kBSBotDrive>::RotationGain();
+			break;
+	}
+}
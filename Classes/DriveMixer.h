@@ -0,0 +1,69 @@
+#ifndef DRIVEMIXER_H
+#define DRIVEMIXER_H
+
+#include "../Robotmap.h"
+#include "DriveKinematics.h"
+
+/** @brief Turns a move, strafe and rotate command into the four wheel
+ * outputs for a drive mode chosen at run time.
+ *
+ * This is a thin facade over DriveKinematics. The instantiation for the
+ * drive mode is chosen once when the mixer is created, so mixing each
+ * cycle is a single call to the inlined kinematics for that mode.
+ * AdvancedRobotDrive instantiates its own drive functions on the mode
+ * instead, so the kinematics inline into them.
+ *
+ * @author Stephen Nutt
+ */
+class DriveMixer
+{
+public:
+	DriveMixer(DriveMode mode);
+
+	/**
+	 * @brief Mixes a drive command into the motor outputs.
+	 * @param move The forward speed, -1 to 1.
+	 * @param strafe The sideways speed to the right, -1 to 1. Ignored by
+	 * the drive modes that cannot strafe.
+	 * @param rotate The anticlockwise rotation speed, -1 to 1.
+	 * @param outputs Set to the motor outputs, indexed by DriveWheel. These
+	 * include the motor inversions so they are sent to the motors as they are.
+	 */
+	inline void Mix(float move, float strafe, float rotate, float outputs[kDriveWheels]) const
+	{
+		m_mix(move, strafe, rotate, outputs);
+	}
+
+	/**
+	 * @brief Works out how far the robot moved from how far the motors turned.
+	 * @param revolutions The change in each motor's encoder position, in
+	 * revolutions, indexed by DriveWheel.
+	 * @param forward Set to the distance moved forward, in inches.
+	 * @param strafe Set to the distance moved to the right, in inches.
+	 * @param rotation Set to the anticlockwise rotation, in radians.
+	 */
+	inline void Odometry(const float revolutions[kDriveWheels], float& forward, float& strafe, float& rotation) const
+	{
+		m_odometry(revolutions, forward, strafe, rotation);
+	}
+
+	/**
+	 * @brief Returns the rotation, in radians per inch of wheel travel,
+	 * that a rotate command of 1 gives.
+	 */
+	inline float GetRotationGain() const
+	{
+		return m_rotationGain;
+	}
+
+private:
+	typedef void (*MixFunction)(float move, float strafe, float rotate, float outputs[kDriveWheels]);
+	typedef void (*OdometryFunction)(const float revolutions[kDriveWheels], float& forward, float& strafe, float& rotation);
+
+	//! The kinematics of the drive mode
+	MixFunction m_mix;
+	OdometryFunction m_odometry;
+	float m_rotationGain;
+};
+
+#endif
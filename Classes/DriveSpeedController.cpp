@@ -0,0 +1,193 @@
+#include "DriveSpeedController.h"
+#include "RampedCANJaguar.h"
+#include "RobotClock.h"
+#include <math.h>
+
+/**
+ * @brief Creates the speed controller. The motors are not driven until
+ * Start is called.
+ */
+DriveSpeedController::DriveSpeedController(
+	RampedCANJaguar* frontLeft,
+	RampedCANJaguar* rearLeft,
+	RampedCANJaguar* frontRight,
+	RampedCANJaguar* rearRight) :
+	m_previousTime(0),
+	m_controllerTask("DriveSpeedController", (FUNCPTR)DriveSpeedController::ControllerTask, Task::kDefaultPriority - 5)
+{
+	m_jaguars[kFrontLeftWheel] = frontLeft;
+	m_jaguars[kRearLeftWheel] = rearLeft;
+	m_jaguars[kFrontRightWheel] = frontRight;
+	m_jaguars[kRearRightWheel] = rearRight;
+	Reset();
+	Stop();
+}
+
+/**
+ * @brief Stops the controller task.
+ */
+DriveSpeedController::~DriveSpeedController()
+{
+	m_controllerTask.Stop();
+}
+
+/**
+ * @brief Starts the controller task. The motors must already be in
+ * voltage mode with their encoders configured.
+ */
+void DriveSpeedController::Start()
+{
+	m_controllerTask.Start(reinterpret_cast<UINT32>(this));
+}
+
+/**
+ * @brief Sets the speed of each motor, called from the control loop.
+ * @param speeds The speed setpoints in RPM, indexed by DriveWheel.
+ */
+void DriveSpeedController::SetSpeeds(const float speeds[kDriveWheels])
+{
+	Setpoints setpoints;
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		setpoints.m_speeds[i] = speeds[i];
+	}
+	setpoints.m_time = RobotClock::GetTime();
+	setpoints.m_stopped = false;
+	m_setpoints.Write(setpoints);
+}
+
+/**
+ * @brief Stops the motors until SetSpeeds is next called, for example when
+ * the motor safety times out.
+ */
+void DriveSpeedController::Stop()
+{
+	Setpoints setpoints;
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		setpoints.m_speeds[i] = 0.0;
+	}
+	setpoints.m_time = 0;
+	setpoints.m_stopped = true;
+	m_setpoints.Write(setpoints);
+}
+
+/**
+ * @brief Clears the state of the control loops, so they start again from
+ * a standstill. Only called from the controller task, or before it starts.
+ */
+void DriveSpeedController::Reset()
+{
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		m_ramped[i] = 0.0;
+		m_integral[i] = 0.0;
+		m_previousError[i] = 0.0;
+		m_derivative[i] = 0.0;
+		m_statusTime[i] = 0;
+	}
+	m_previousTime = 0;
+}
+
+/**
+ * @brief Runs one step of each motor's control loop.
+ */
+void DriveSpeedController::Update()
+{
+	const Setpoints setpoints = m_setpoints.Read();
+	const UINT32 now = RobotClock::GetTime();
+	const bool stale = setpoints.m_stopped ||
+		(now - setpoints.m_time) > static_cast<UINT32>(kDriveSetpointTimeout * 1e6);
+	if (stale || !DriverStation::GetInstance()->IsEnabled())
+	{
+		Reset();
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			m_jaguars[i]->SetOutput(0.0);
+		}
+		return;
+	}
+
+	// Use the measured period, clamped so a long pause does not wind up
+	// the integral or jump the ramp
+	float period = kDriveControlPeriod;
+	if (m_previousTime != 0)
+	{
+		period = (now - m_previousTime) * 1e-6;
+		if (period > kDriveMaxPeriod)
+		{
+			period = kDriveMaxPeriod;
+		}
+	}
+	m_previousTime = now;
+	const float rampFraction = (kDriveRamp >= 1.0) ? 1.0 : 1.0 - pow(1.0 - kDriveRamp, period / kDrivePeriod);
+
+	// The integral is limited to what can change the output by the full
+	// voltage, so it cannot wind up while the motor is saturated
+	const float integralLimit = (kDriveI > 0) ? kDriveOutputVoltageLimit / kDriveI : 0;
+
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		m_ramped[i] += (setpoints.m_speeds[i] - m_ramped[i]) * rampFraction;
+		float volts = kDriveF * m_ramped[i];
+
+		// Until the poller has read the motor there is only the feed-forward
+		const JaguarStatus status = m_jaguars[i]->GetStatus();
+		if (status.m_time != 0)
+		{
+			const float error = m_ramped[i] - status.m_speed;
+			m_integral[i] += error * period;
+			if (m_integral[i] > integralLimit)
+			{
+				m_integral[i] = integralLimit;
+			}
+			else if (m_integral[i] < -integralLimit)
+			{
+				m_integral[i] = -integralLimit;
+			}
+
+			// The speed only changes when the poller reads the motor, so the
+			// derivative is taken between statuses. The first status after a
+			// reset only seeds the previous error.
+			if (status.m_time != m_statusTime[i])
+			{
+				if (m_statusTime[i] != 0)
+				{
+					const float statusPeriod = (status.m_time - m_statusTime[i]) * 1e-6;
+					m_derivative[i] = (error - m_previousError[i]) / statusPeriod;
+				}
+				m_previousError[i] = error;
+				m_statusTime[i] = status.m_time;
+			}
+			volts += kDriveP * error + kDriveI * m_integral[i] + kDriveD * m_derivative[i];
+		}
+		if (volts > kDriveOutputVoltageLimit)
+		{
+			volts = kDriveOutputVoltageLimit;
+		}
+		else if (volts < -kDriveOutputVoltageLimit)
+		{
+			volts = -kDriveOutputVoltageLimit;
+		}
+		m_jaguars[i]->SetOutput(volts);
+	}
+}
+
+/**
+ * @brief The controller task, runs the control loops every
+ * kDriveControlPeriod, the rate the motor speeds are read at, and applies
+ * the outputs together.
+ */
+void DriveSpeedController::ControllerTask(DriveSpeedController& controller)
+{
+	while (true)
+	{
+		const UINT32 writeCount = RampedCANJaguar::GetWriteCount();
+		controller.Update();
+		if (RampedCANJaguar::GetWriteCount() != writeCount)
+		{
+			RampedCANJaguar::UpdateSyncGroup(kDriveSyncGroup);
+		}
+		RobotClock::Delay(kDriveControlPeriod);
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef DRIVESPEEDCONTROLLER_H
+#define DRIVESPEEDCONTROLLER_H
+
+#include "WPILib.h"
+#include "../Robotmap.h"
+#include "DriveKinematics.h"
+#include "SeqLock.h"
+
+class RampedCANJaguar;
+
+/**
+ * @brief Runs the speed control loops for the drive motors on the cRIO,
+ * for kDriveCRIOSpeedControl.
+ *
+ * A task runs every kDriveControlPeriod. It ramps each motor's speed
+ * setpoint with kDriveRamp, reads the motor's speed from its encoder, and
+ * sets the motor voltage to a feed-forward of kDriveF volts per RPM plus a
+ * PID correction with kDriveP, kDriveI and kDriveD. The motors run in
+ * voltage mode, so the response does not change as the battery runs down.
+ *
+ * The control loop only publishes the setpoints, with SetSpeeds, and the
+ * speeds are the statuses cached by the JaguarStatusPoller, so neither
+ * task waits on the CAN bus to read the motors. The poller reads each of
+ * the four drive Jaguars once every 4 * kCANStatusPollPeriod, 40 ms, so
+ * kDriveControlPeriod matches that and the loops run at 25 Hz. Running
+ * them faster would only act on the same speed again. With a 25 Hz sample
+ * rate and up to a period of delay on each speed, the PID correction is
+ * only good for disturbances below about 2 Hz. Faster changes of the
+ * setpoint are followed by the feed-forward alone.
+ *
+ * The motors are only driven while the robot is enabled and the setpoints
+ * are fresh. If the robot is disabled, Stop is called, or no setpoints
+ * have been published for kDriveSetpointTimeout, the motors are set to 0
+ * volts and the ramps, integrals and derivatives start again from 0, so
+ * a hung control loop cannot leave the robot driving.
+ */
+class DriveSpeedController
+{
+public:
+	DriveSpeedController(RampedCANJaguar* frontLeft, RampedCANJaguar* rearLeft,
+		RampedCANJaguar* frontRight, RampedCANJaguar* rearRight);
+	~DriveSpeedController();
+	void Start();
+	void SetSpeeds(const float speeds[kDriveWheels]);
+	void Stop();
+
+private:
+	//! The speed setpoints in RPM, indexed by DriveWheel
+	struct Setpoints
+	{
+		float m_speeds[kDriveWheels];
+		UINT32 m_time;		//!< When the setpoints were published
+		bool m_stopped;		//!< Set by Stop, the motors are stopped
+	};
+
+	static void ControllerTask(DriveSpeedController& controller);
+	void Update();
+	void Reset();
+
+	//! The drive motors, indexed by DriveWheel
+	RampedCANJaguar* m_jaguars[kDriveWheels];
+	//! The setpoints published by the control loop
+	SeqLock<Setpoints> m_setpoints;
+	//! The ramped setpoint of each motor
+	float m_ramped[kDriveWheels];
+	//! The integral of each motor's speed error, in RPM seconds
+	float m_integral[kDriveWheels];
+	//! Each motor's speed error at the previous status
+	float m_previousError[kDriveWheels];
+	//! The derivative of each motor's speed error, in RPM per second
+	float m_derivative[kDriveWheels];
+	//! The time of the status each motor's m_previousError came from, 0 if none
+	UINT32 m_statusTime[kDriveWheels];
+	//! The FPGA time of the previous update
+	UINT32 m_previousTime;
+	//! The task that runs the control loops
+	Task m_controllerTask;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef FIXED_POINT_ALPHA_BETA_FILTER_H_
+#define FIXED_POINT_ALPHA_BETA_FILTER_H_
+
+#include "AlphaBetaFilter.h"
+
+/** @brief Selects the fixed point specialization of \c AlphaBetaFilter
+ *
+ * Values passed to and returned from the specialization are Q16.16 fixed
+ * point numbers, that is a 32 bit integer holding the value multiplied by
+ * 65536.
+ */
+struct FixedPointQ16
+{
+	//! The number of fraction bits
+	static const int kFractionBits = 16;
+
+	//! The fixed point representation of 1.0
+	static const INT32 kOne = 1 << kFractionBits;
+
+	//! Converts an integer to Q16.16
+	static inline INT32 FromInteger (INT32 value)
+	{
+		return value << kFractionBits;
+	}
+
+	//! Converts a Q16.16 value to the nearest integer
+	static inline INT32 ToInteger (INT32 value)
+	{
+		return (value + (kOne >> 1)) >> kFractionBits;
+	}
+
+	//! Converts a floating point value to Q16.16.  This is intended for
+	//! initialization, not for use in the control loop.
+	static inline INT32 FromFloat (double value)
+	{
+		return static_cast<INT32> (value * kOne + (value < 0 ? -0.5 : 0.5));
+	}
+};
+
+/** @brief A fixed point Alpha-Beta filter for integer sensor streams
+ *
+ * This behaves like \c AlphaBetaFilter but never uses floating point
+ * arithmetic in \c Update, which suits raw integer readings such as ADC
+ * counts.  Measurements are integers, and the filtered value, the alpha and
+ * beta gains and the rate of change (in units per second) are all Q16.16.
+ * Internally the rate of change is kept as a Q32 value in units per
+ * microsecond using 64 bit intermediates.
+ *
+ * The division by the time increment is replaced by a multiplication by the
+ * reciprocal of the nominal sample period, which is calculated when the
+ * period is set.  If a time increment is more than 1/64 away from the
+ * nominal period its reciprocal is calculated with a single integer divide
+ * instead, so late samples are still handled correctly.  A time increment
+ * longer than \c kMaxPeriods nominal periods is treated as that long, so
+ * that the prediction cannot overflow after a gap in the readings.
+ *
+ * Compared with \c AlphaBetaFilter<double> on 12 bit readings, with samples
+ * exactly at the nominal period the filtered value stays within 0.001
+ * counts and the rate of change within 0.01% of its peak.  With the sample
+ * period jittering by up to 25% the filtered value stays within 0.15 counts
+ * and the rate of change within 0.6% of its peak, the error coming from
+ * using the nominal reciprocal for samples inside the 1/64 window.  These
+ * are checked by Tools/FixedPointFilterTest.cpp.
+ *
+ * Filter logging is not available in this specialization.
+ *
+ * @version 1.0
+ */
+template <unsigned HistoryCapacity>
+class AlphaBetaFilter<FixedPointQ16, HistoryCapacity>
+{
+public:
+	//! The longest time increment used, in nominal periods
+	static const UINT32 kMaxPeriods = 16;
+
+	//! Initializes the filter using the specified Q16.16 alpha and beta
+	//! correction gains and the nominal time between samples in
+	//! microseconds, everything else is initialized to 0
+	inline AlphaBetaFilter (INT32 alpha, INT32 beta, UINT32 nominalPeriod) :
+		m_lastTime(), m_alpha(alpha), m_beta(beta), m_value(),
+		m_rateOfChange(), m_hasValue (false)
+	{
+		SetNominalPeriod (nominalPeriod);
+	}
+
+	//! Clears the filter
+	inline void Clear()
+	{
+		m_hasValue = false;
+		m_value = 0;
+	}
+
+	//! Sets the Q16.16 alpha beta correction gains
+	inline void SetCorrectionGains (INT32 alpha, INT32 beta)
+	{
+		m_alpha = alpha;
+		m_beta = beta;
+	}
+
+	//! Sets the nominal time between samples in microseconds, and
+	//! precalculates its reciprocal
+	inline void SetNominalPeriod (UINT32 nominalPeriod)
+	{
+		m_nominalPeriod = nominalPeriod;
+		m_periodTolerance = nominalPeriod >> 6;
+		m_maxPeriod = nominalPeriod * kMaxPeriods;
+		m_invNominalPeriod = 0xFFFFFFFFU / nominalPeriod;
+	}
+
+	//! Seeds the filter with an initial Q16.16 value and rate of change in
+	//! Q16.16 units per second at a given time
+	inline void SeedFilter (INT32 value, INT32 speed, const UINT32 now)
+	{
+		m_rateOfChange = (static_cast<INT64> (speed) << 16) / 1000000;
+		SeedFilter (value, now);
+	}
+
+	//! Seeds the filter with an initial Q16.16 value at a given time but
+	//! does not change the rate of change
+	inline void SeedFilter (INT32 value, const UINT32 now)
+	{
+		m_value = value;
+		m_lastTime = now;
+		m_hasValue = true;
+	}
+
+	//! Updates the filter with using the new integer measured value and
+	//! the time of the measurement, returning the Q16.16 smoothed value
+	const INT32& Update (INT32 measuredVal, const UINT32 measurementTime)
+	{
+		const INT32 measured = FixedPointQ16::FromInteger (measuredVal);
+		if (m_hasValue == false)
+		{
+			// See AlphaBetaFilter::Update
+			m_value = measured;
+			m_hasValue = true;
+		}
+		else
+		{
+			UINT32 dTime = measurementTime - m_lastTime;
+			if (dTime > m_maxPeriod)
+			{
+				dTime = m_maxPeriod;
+			}
+
+			// Q32 per microsecond * microseconds >> 16 gives Q16
+			const INT32 predictedValue = m_value +
+				static_cast<INT32> ((m_rateOfChange * dTime) >> 16);
+			const INT32 residual = measured - predictedValue;
+			m_value = predictedValue +
+				static_cast<INT32> ((static_cast<INT64> (m_alpha) * residual) >> 16);
+
+			// Only divide when the sample is well away from the nominal
+			// period
+			const UINT32 deviation = (dTime > m_nominalPeriod) ?
+				dTime - m_nominalPeriod : m_nominalPeriod - dTime;
+			const UINT32 invDTime = (deviation <= m_periodTolerance || dTime == 0) ?
+				m_invNominalPeriod : 0xFFFFFFFFU / dTime;
+
+			// beta * residual is Q16 after the shift, multiplied by the Q32
+			// reciprocal gives Q48 per microsecond, shifted back to Q32
+			const INT64 correction = (static_cast<INT64> (m_beta) * residual) >> 16;
+			m_rateOfChange += (correction * invDTime) >> 16;
+		}
+
+		// Set the last measurement time
+		m_lastTime = measurementTime;
+
+		return m_value;
+	}
+
+	//! Returns the current Q16.16 filter value, this is the same as the
+	//! last value returned by \c Update
+	inline const INT32& GetValue() const
+	{
+		return m_value;
+	}
+
+	//! Returns the time of the last measurement passed to \c Update
+	inline UINT32 GetLastMeasurementTime() const
+	{
+		return m_lastTime;
+	}
+
+	//! Returns the rate of change in Q16.16 units per second
+	inline INT32 GetRateOfChange() const
+	{
+		return static_cast<INT32> ((m_rateOfChange * 1000000) >> 16);
+	}
+
+private:
+	UINT32 m_lastTime;			//!< Time of last measurement
+	INT32 m_alpha;				//!< Q16.16 alpha correction gain
+	INT32 m_beta;				//!< Q16.16 beta correction gain
+	INT32 m_value;				//!< The Q16.16 smoothed value
+	INT64 m_rateOfChange;		//!< Q32 rate of change per microsecond
+	UINT32 m_nominalPeriod;		//!< The nominal time between samples in microseconds
+	UINT32 m_periodTolerance;	//!< How far from nominal the nominal reciprocal is used
+	UINT32 m_maxPeriod;			//!< The longest time increment used in microseconds
+	UINT32 m_invNominalPeriod;	//!< Q32 reciprocal of the nominal period
+	bool m_hasValue;			//!< When set to false, the filter has yet to be seeded or fed a value
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "JaguarStatusPoller.h"
+#include "RampedCANJaguar.h"
+#include "RobotClock.h"
+
+JaguarStatusPoller* JaguarStatusPoller::s_instance = NULL;
+
+/**
+ * @brief Returns the status poller, creating it and starting its task the
+ * first time it is called.
+ */
+JaguarStatusPoller* JaguarStatusPoller::GetInstance()
+{
+	if (s_instance == NULL)
+	{
+		s_instance = new JaguarStatusPoller();
+	}
+	return s_instance;
+}
+
+/**
+ * @brief Creates the status poller and starts its task. The task runs
+ * below the control loop but above the log writer.
+ */
+JaguarStatusPoller::JaguarStatusPoller() :
+	m_jaguarCount(0),
+	m_next(0),
+	m_polling(NULL),
+	m_semaphore(semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE)),
+	m_pollSemaphore(semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE)),
+	m_pollerTask("JaguarStatusPoller", (FUNCPTR)JaguarStatusPoller::PollerTask, Task::kDefaultPriority + 10)
+{
+	for (int i = 0; i < kCANStatusMaxJaguars; ++i)
+	{
+		m_jaguars[i] = NULL;
+	}
+	m_pollerTask.Start(reinterpret_cast<UINT32>(this));
+}
+
+/**
+ * @brief Stops the poller task.
+ */
+JaguarStatusPoller::~JaguarStatusPoller()
+{
+	m_pollerTask.Stop();
+	semDelete(m_pollSemaphore);
+	semDelete(m_semaphore);
+}
+
+/**
+ * @brief Adds a Jaguar to the ones that are polled. Jaguars past
+ * kCANStatusMaxJaguars are not polled.
+ */
+void JaguarStatusPoller::Register(RampedCANJaguar* jaguar)
+{
+	const Synchronized sync(m_semaphore);
+	for (int i = 0; i < m_jaguarCount; ++i)
+	{
+		if (m_jaguars[i] == NULL)
+		{
+			m_jaguars[i] = jaguar;
+			return;
+		}
+	}
+	if (m_jaguarCount < kCANStatusMaxJaguars)
+	{
+		m_jaguars[m_jaguarCount++] = jaguar;
+	}
+	else
+	{
+		printf("JaguarStatusPoller: too many Jaguars, increase kCANStatusMaxJaguars\n");
+	}
+}
+
+/**
+ * @brief Stops polling a Jaguar. When this returns the Jaguar is not being
+ * polled and will not be polled again.
+ */
+void JaguarStatusPoller::Unregister(RampedCANJaguar* jaguar)
+{
+	const Synchronized sync(m_semaphore);
+	for (int i = 0; i < m_jaguarCount; ++i)
+	{
+		if (m_jaguars[i] == jaguar)
+		{
+			m_jaguars[i] = NULL;
+		}
+	}
+	if (m_polling == jaguar)
+	{
+		// The poller releases m_pollSemaphore without taking m_semaphore,
+		// so waiting for it here cannot deadlock
+		const Synchronized waitForPoll(m_pollSemaphore);
+	}
+}
+
+/**
+ * @brief Polls the next registered Jaguar. The Jaguar is chosen under
+ * m_semaphore but polled outside it.
+ */
+void JaguarStatusPoller::PollNext()
+{
+	RampedCANJaguar* jaguar = NULL;
+	{
+		const Synchronized sync(m_semaphore);
+		for (int i = 0; i < m_jaguarCount && jaguar == NULL; ++i)
+		{
+			jaguar = m_jaguars[m_next];
+			m_next = (m_next + 1) % m_jaguarCount;
+		}
+		m_polling = jaguar;
+		if (jaguar == NULL)
+		{
+			return;
+		}
+		// Taken before m_semaphore is released, so an Unregister that
+		// sees m_polling always waits for this poll
+		semTake(m_pollSemaphore, WAIT_FOREVER);
+	}
+	jaguar->PollStatus();
+	semGive(m_pollSemaphore);
+}
+
+/**
+ * @brief The poller task, reads one Jaguar every kCANStatusPollPeriod.
+ */
+void JaguarStatusPoller::PollerTask(JaguarStatusPoller& poller)
+{
+	while (true)
+	{
+		poller.PollNext();
+		RobotClock::Delay(kCANStatusPollPeriod);
+	}
+}
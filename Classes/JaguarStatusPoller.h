@@ -0,0 +1,56 @@
+#ifndef JAGUARSTATUSPOLLER_H
+#define JAGUARSTATUSPOLLER_H
+
+#include "WPILib.h"
+#include "../Robotmap.h"
+
+class RampedCANJaguar;
+
+/**
+ * @brief A background task that reads the status of the registered
+ * RampedCANJaguars, so that the control loop never waits on the CAN bus
+ * to read a Jaguar.
+ *
+ * Each RampedCANJaguar registers itself when it is constructed. Every
+ * kCANStatusPollPeriod the task reads the status of the next registered
+ * Jaguar in turn, which the Jaguar caches and publishes through a SeqLock.
+ * With n Jaguars registered each one's position and speed are refreshed
+ * every n * kCANStatusPollPeriod seconds, and its voltage, current and
+ * temperature every kCANElectricalPollPeriod. See RampedCANJaguar::PollStatus.
+ *
+ * The CAN transactions of a poll are made without holding the lock that
+ * Register takes, so registering never waits on the bus. Unregistering
+ * only waits if the Jaguar is being polled at that moment.
+ */
+class JaguarStatusPoller
+{
+public:
+	static JaguarStatusPoller* GetInstance();
+	void Register(RampedCANJaguar* jaguar);
+	void Unregister(RampedCANJaguar* jaguar);
+
+private:
+	JaguarStatusPoller();
+	~JaguarStatusPoller();
+	static void PollerTask(JaguarStatusPoller& poller);
+	void PollNext();
+
+	static JaguarStatusPoller* s_instance;
+
+	//! The registered Jaguars, NULL where one has been unregistered
+	RampedCANJaguar* m_jaguars[kCANStatusMaxJaguars];
+	//! The number of used entries in m_jaguars
+	int m_jaguarCount;
+	//! The entry in m_jaguars that is polled next
+	int m_next;
+	//! The Jaguar being polled, NULL between polls
+	RampedCANJaguar* m_polling;
+	//! Guards m_jaguars, m_jaguarCount, m_next and m_polling
+	const SEM_ID m_semaphore;
+	//! Held for the whole of a poll, so Unregister can wait for it to end
+	const SEM_ID m_pollSemaphore;
+	//! The task that polls the Jaguars
+	Task m_pollerTask;
+};
+
+#endif
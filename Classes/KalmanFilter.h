@@ -0,0 +1,489 @@
+#ifndef KALMAN_FILTER_H_
+#define KALMAN_FILTER_H_
+
+#include <ostream>
+#include "RingBuffer.h"
+
+/** @brief Implements a linear Kalman filter for a single signal and its
+ * first \c N - 1 derivatives
+ *
+ * The state is the value followed by its derivatives, so \c N = 2 is a
+ * constant velocity model (value and rate of change) and \c N = 3 is a
+ * constant acceleration model.  The highest derivative is driven by white
+ * noise with a variance of \c processNoise per second.  Unlike the
+ * Alpha-Beta filter the gains are not fixed, they are calculated from the
+ * process and measurement noise every update.
+ *
+ * The interface mirrors \c AlphaBetaFilter, so the two can be swapped.  In
+ * addition \c UpdateRate corrects the filter with a measurement of the
+ * rate of change, which allows sensors measuring different things to be
+ * fused, for example a heading from wheel odometry passed to \c Update and
+ * a turn rate from the gyro passed to \c UpdateRate.
+ *
+ * All of the matrices have a compile time size, so nothing is allocated
+ * and the compiler can fully unroll the matrix arithmetic.  Logging works
+ * as in \c AlphaBetaFilter, using a fixed capacity ring buffer that is
+ * only allocated the first time logging is enabled.
+ *
+ * See http://en.wikipedia.org/wiki/Kalman_filter for more information.
+ *
+ * @version 1.0
+ */
+template <typename T, unsigned N, unsigned HistoryCapacity = 1024>
+class KalmanFilter
+{
+public:
+	struct FilterHistory;
+
+	//! Initializes the filter using the variance of the process noise (per
+	//! second) and of the measurements, everything else is initialized to 0
+	inline KalmanFilter (const T& processNoise, const T& measurementNoise) :
+		m_lastTime(), m_processNoise (processNoise),
+		m_measurementNoise (measurementNoise), m_rateNoise (measurementNoise),
+		m_initialVariance (1000), m_enableLogging (false), m_hasValue (false),
+		m_headerWritten (false), m_history (0)
+	{
+		Clear();
+	}
+
+	//! Copies the filter state.  The copy starts with an empty history.
+	inline KalmanFilter (const KalmanFilter& other) :
+		m_enableLogging (false), m_headerWritten (false), m_history (0)
+	{
+		CopyState (other);
+	}
+
+	//! Frees the history
+	inline ~KalmanFilter ()
+	{
+		delete m_history;
+	}
+
+	//! Copies the filter state, keeping this filter's history
+	inline KalmanFilter& operator= (const KalmanFilter& other)
+	{
+		CopyState (other);
+		return *this;
+	}
+
+	//! Clears the filter
+	inline void Clear()
+	{
+		m_hasValue = false;
+		for (unsigned i = 0; i < N; ++i)
+		{
+			m_state[i] = T();
+		}
+		ResetCovariance();
+	}
+
+	//! Sets the variance of the process noise per second and of the value
+	//! measurements passed to \c Update
+	inline void SetNoise (const T& processNoise, const T& measurementNoise)
+	{
+		m_processNoise = processNoise;
+		m_measurementNoise = measurementNoise;
+	}
+
+	//! Sets the variance of the rate measurements passed to \c UpdateRate
+	inline void SetRateNoise (const T& rateNoise)
+	{
+		m_rateNoise = rateNoise;
+	}
+
+	//! Sets the variance given to every state when the filter is seeded
+	inline void SetInitialVariance (const T& variance)
+	{
+		m_initialVariance = variance;
+	}
+
+	//! Seeds the filter with an initial value and rate of change at a
+	//! given time
+	inline void SeedFilter (const T& value, const T& speed, const UINT32 now)
+	{
+		// A single state filter has no rate, the value then overwrites it
+		m_state[N > 1 ? 1 : 0] = speed;
+		SeedFilter (value, now);
+	}
+
+	//! Seeds the filter with an initial value at a given time but does not
+	//! change the rate of change
+	inline void SeedFilter (const T& value, const UINT32 now)
+	{
+		m_state[0] = value;
+		m_lastTime = now;
+		m_hasValue = true;
+		ResetCovariance();
+	}
+
+	//! Initializes the logging for the filter, allocating the history the
+	//! first time
+	inline void EnableLogging()
+	{
+		if (m_history == 0)
+		{
+			m_history = new HistoryContainer;
+			MemoryBarrier();
+		}
+		m_enableLogging = true;
+	}
+
+	//! Disabled the filter logging
+	inline void DisableLogging()
+	{
+		m_enableLogging = false;
+	}
+
+	//! Returns true if filter logging is currently enabled
+	inline bool IsLoggingEnabled() const
+	{
+		return m_enableLogging;
+	}
+
+	//! Writes the filter's history to the specified stream in a comma
+	//! delimitered file format, removing it from the history.  The header
+	//! line is written by the first call only.  This may be called from a
+	//! task other than the one updating the filter.
+	void WriteLog (std::ostream& os)
+	{
+		if (m_history == 0)
+		{
+			return;
+		}
+		if (m_headerWritten == false)
+		{
+			FilterHistory::WriteHeader (os);
+			m_headerWritten = true;
+		}
+		FilterHistory item;
+		while (m_history->Pop (item))
+		{
+			os << item;
+		}
+	}
+
+	//! Moves up to \c maxCount of the oldest history entries into \c items,
+	//! returning the number moved
+	unsigned DrainHistory (FilterHistory* items, unsigned maxCount)
+	{
+		unsigned count = 0;
+		while (m_history != 0 && count < maxCount && m_history->Pop (items[count]))
+		{
+			++count;
+		}
+		return count;
+	}
+
+	//! Updates the filter with using the new measured value and
+	//! the time of the measurement, returning the smoothed value
+	const T& Update (const T& measuredVal, const UINT32 measurementTime)
+	{
+		if (m_hasValue == false)
+		{
+			// See AlphaBetaFilter::Update
+			m_state[0] = measuredVal;
+			m_hasValue = true;
+			m_lastTime = measurementTime;
+			return m_state[0];
+		}
+
+		const double dTime = Predict (measurementTime);
+		const T predictedValue = m_state[0];
+		const T residual = Correct (0, measuredVal, m_measurementNoise);
+		Log (measuredVal, measurementTime, dTime, predictedValue, residual);
+		return m_state[0];
+	}
+
+	//! Updates the filter with a measured rate of change and the time of
+	//! the measurement, returning the smoothed value
+	const T& UpdateRate (const T& measuredRate, const UINT32 measurementTime)
+	{
+		if (N < 2 || m_hasValue == false)
+		{
+			// Without a value there is nothing to integrate the rate into
+			return m_state[0];
+		}
+
+		const double dTime = Predict (measurementTime);
+		const T predictedValue = m_state[0];
+		const T residual = Correct (1, measuredRate, m_rateNoise);
+		Log (measuredRate, measurementTime, dTime, predictedValue, residual);
+		return m_state[0];
+	}
+
+	//! Returns the current filter value, this is the same as the last value
+	//! returned by \c Update
+	inline const T& GetValue() const
+	{
+		return m_state[0];
+	}
+
+	//! Returns the time of the last measurement passed to \c Update
+	inline UINT32 GetLastMeasurementTime() const
+	{
+		return m_lastTime;
+	}
+
+	//! Returns the rate of change in the filter
+	inline const T& GetRateOfChange() const
+	{
+		return m_state[N > 1 ? 1 : 0];
+	}
+
+	//! Returns a single state, 0 being the value, 1 the rate of change
+	//! and so on
+	inline const T& GetState (unsigned index) const
+	{
+		return m_state[index];
+	}
+
+	//! Returns the estimated variance of the value
+	inline const T& GetVariance() const
+	{
+		return m_covariance[0][0];
+	}
+
+	/** @brief Contains the evaluation state of the filter for a single reading
+	 *
+	 * The columns match those of \c AlphaBetaFilter so the same tools can read
+	 * either log.
+	 *
+	 * @version 1.0
+	 */
+	struct FilterHistory
+	{
+		T m_measuredVal;	//!< The measured value or rate
+		UINT32 m_time;		//!< The time of the reading
+		double m_dTime;		//!< The time increment since the previous reading
+		T m_predictedValue;	//!< The predicted value for this reading
+		T m_residual;		//!< The residual between the prediction and the measurement
+		T m_rateOfChange;	//!< The rate of change of the filter at the reading
+		T m_value;			//!< The new filter value
+
+		//! Writes out the header for the log
+		static inline void WriteHeader (std::ostream& os)
+		{
+			os << "Raw,Time,DeltaTime,Predicted,Residual,ROC,Value" << std::endl;
+		}
+
+		//! Writes out a single log line
+		friend ostream& operator << (ostream& os, const FilterHistory& item)
+		{
+			char buffer[128];
+			sprintf (buffer, "%.8f,%.8f,%.8f,%.8f,%.8f,%.8f,%.8f",
+				static_cast<double> (item.m_measuredVal),
+				static_cast<double> (item.m_time),
+				static_cast<double> (item.m_dTime),
+				static_cast<double> (item.m_predictedValue),
+				static_cast<double> (item.m_residual),
+				static_cast<double> (item.m_rateOfChange),
+				static_cast<double> (item.m_value));
+
+			return os << buffer << std::endl;
+		}
+	};
+
+private:
+	//! Copies everything but the history from another filter
+	void CopyState (const KalmanFilter& other)
+	{
+		m_lastTime = other.m_lastTime;
+		for (unsigned i = 0; i < N; ++i)
+		{
+			m_state[i] = other.m_state[i];
+			for (unsigned j = 0; j < N; ++j)
+			{
+				m_covariance[i][j] = other.m_covariance[i][j];
+			}
+		}
+		m_processNoise = other.m_processNoise;
+		m_measurementNoise = other.m_measurementNoise;
+		m_rateNoise = other.m_rateNoise;
+		m_initialVariance = other.m_initialVariance;
+		m_hasValue = other.m_hasValue;
+		if (other.m_enableLogging)
+		{
+			EnableLogging();
+		}
+		else
+		{
+			DisableLogging();
+		}
+	}
+
+	//! Sets the covariance to the initial variance on the diagonal
+	inline void ResetCovariance()
+	{
+		for (unsigned i = 0; i < N; ++i)
+		{
+			for (unsigned j = 0; j < N; ++j)
+			{
+				m_covariance[i][j] = (i == j) ? m_initialVariance : T();
+			}
+		}
+	}
+
+	//! Moves the state and covariance forward to the measurement time,
+	//! returning the time increment in seconds
+	double Predict (const UINT32 measurementTime)
+	{
+		const double dTime = (measurementTime - m_lastTime) * 1e-6;
+		m_lastTime = measurementTime;
+
+		// The transition matrix is upper triangular with
+		// F[i][j] = dTime^(j-i) / (j-i)!, so only powers are needed
+		T powers[N + 1];
+		powers[0] = 1;
+		for (unsigned k = 1; k <= N; ++k)
+		{
+			powers[k] = static_cast<T> (powers[k - 1] * dTime / k);
+		}
+
+		// state = F * state
+		for (unsigned i = 0; i < N; ++i)
+		{
+			T sum = T();
+			for (unsigned j = i; j < N; ++j)
+			{
+				sum += powers[j - i] * m_state[j];
+			}
+			m_state[i] = sum;
+		}
+
+		// covariance = F * covariance * F' + G * G' * processNoise
+		T fp[N][N];
+		for (unsigned i = 0; i < N; ++i)
+		{
+			for (unsigned j = 0; j < N; ++j)
+			{
+				T sum = T();
+				for (unsigned k = i; k < N; ++k)
+				{
+					sum += powers[k - i] * m_covariance[k][j];
+				}
+				fp[i][j] = sum;
+			}
+		}
+		for (unsigned i = 0; i < N; ++i)
+		{
+			for (unsigned j = 0; j < N; ++j)
+			{
+				T sum = T();
+				for (unsigned k = j; k < N; ++k)
+				{
+					sum += fp[i][k] * powers[k - j];
+				}
+				// The noise enters through the highest derivative, so
+				// G[i] = dTime^(N-i) / (N-i)!
+				m_covariance[i][j] = sum + powers[N - i] * powers[N - j] * m_processNoise;
+			}
+		}
+
+		return dTime;
+	}
+
+	//! Corrects the filter with a measurement of a single state, returning
+	//! the residual
+	T Correct (unsigned index, const T& measured, const T& noise)
+	{
+		const T residual = measured - m_state[index];
+		const T innovationVariance = m_covariance[index][index] + noise;
+
+		T gain[N];
+		for (unsigned i = 0; i < N; ++i)
+		{
+			gain[i] = m_covariance[i][index] / innovationVariance;
+			m_state[i] += gain[i] * residual;
+		}
+
+		// covariance = (I - K * H) * covariance, where H selects one state
+		T row[N];
+		for (unsigned j = 0; j < N; ++j)
+		{
+			row[j] = m_covariance[index][j];
+		}
+		for (unsigned i = 0; i < N; ++i)
+		{
+			for (unsigned j = 0; j < N; ++j)
+			{
+				m_covariance[i][j] -= gain[i] * row[j];
+			}
+		}
+		return residual;
+	}
+
+	//! Adds the filter state to the history if logging is enabled
+	inline void Log (const T& measured, UINT32 time, double dTime,
+		const T& predictedValue, const T& residual)
+	{
+		if (m_enableLogging)
+		{
+			FilterHistory* const last = m_history->BeginPush();
+			if (last != 0)
+			{
+				last->m_measuredVal = measured;
+				last->m_time = time;
+				last->m_dTime = dTime;
+				last->m_predictedValue = predictedValue;
+				last->m_residual = residual;
+				last->m_rateOfChange = GetRateOfChange();
+				last->m_value = m_state[0];
+				m_history->EndPush();
+			}
+		}
+	}
+
+	//! The container type used for the filter logging
+	typedef RingBuffer<FilterHistory, HistoryCapacity> HistoryContainer;
+
+	UINT32 m_lastTime;			//!< Time of last measurement
+	T m_state[N];				//!< The value followed by its derivatives
+	T m_covariance[N][N];		//!< The estimated covariance of the state
+	T m_processNoise;			//!< Variance per second of the highest derivative
+	T m_measurementNoise;		//!< Variance of the value measurements
+	T m_rateNoise;				//!< Variance of the rate measurements
+	T m_initialVariance;		//!< Variance of each state when the filter is seeded
+	bool m_enableLogging;		//!< When set to true, the filter state is stored in \c m_history
+	bool m_hasValue;			//!< When set to false, the filter has yet to be seeded or fed a value
+	bool m_headerWritten;		//!< Set once \c WriteLog has written the header line
+	HistoryContainer* m_history;	//!< The filter history, only used for logging purposes
+};
+
+/** @brief A Kalman filter tracking a value and its rate of change
+ *
+ * @version 1.0
+ */
+template <typename T, unsigned HistoryCapacity = 1024>
+class ConstantVelocityKalmanFilter : public KalmanFilter<T, 2, HistoryCapacity>
+{
+public:
+	//! See \c KalmanFilter::KalmanFilter
+	inline ConstantVelocityKalmanFilter (const T& processNoise, const T& measurementNoise) :
+		KalmanFilter<T, 2, HistoryCapacity> (processNoise, measurementNoise)
+	{
+	}
+};
+
+/** @brief A Kalman filter tracking a value, its rate of change and its
+ * acceleration
+ *
+ * @version 1.0
+ */
+template <typename T, unsigned HistoryCapacity = 1024>
+class ConstantAccelerationKalmanFilter : public KalmanFilter<T, 3, HistoryCapacity>
+{
+public:
+	//! See \c KalmanFilter::KalmanFilter
+	inline ConstantAccelerationKalmanFilter (const T& processNoise, const T& measurementNoise) :
+		KalmanFilter<T, 3, HistoryCapacity> (processNoise, measurementNoise)
+	{
+	}
+
+	//! Returns the acceleration of the value
+	inline const T& GetAcceleration() const
+	{
+		return this->GetState (2);
+	}
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "LoopProfiler.h"
+
+#ifdef LOOP_PROFILER
+
+#include "../CommandBase.h"
+#include "RobotClock.h"
+#include <stdio.h>
+
+/**
+ * @brief Creates an empty histogram.
+ */
+LoopProfiler::Histogram::Histogram()
+{
+	Clear();
+}
+
+/**
+ * @brief Empties the histogram.
+ */
+void LoopProfiler::Histogram::Clear()
+{
+	for (int i = 0; i < kProfilerBuckets; ++i)
+	{
+		m_buckets[i] = 0;
+	}
+	m_count = 0;
+	m_min = 0xFFFFFFFF;
+	m_max = 0;
+}
+
+/**
+ * @brief Returns the time that percent of the times are at or below, to
+ * the top of the bucket it falls in.
+ */
+UINT32 LoopProfiler::Histogram::GetPercentile(int percent) const
+{
+	const UINT32 target = (m_count * percent + 99) / 100;
+	UINT32 total = 0;
+	for (int i = 0; i < kProfilerBuckets; ++i)
+	{
+		total += m_buckets[i];
+		if (total >= target)
+		{
+			const UINT32 top = (i + 1) * kProfilerBucketWidth;
+			return (top < m_max) ? top : m_max;
+		}
+	}
+	return m_max;
+}
+
+/**
+ * @brief Creates a profiler.
+ * @param name The name logged with the summary, which must stay valid
+ * for the life of the profiler.
+ */
+LoopProfiler::LoopProfiler(const char* name) :
+	m_name(name),
+	m_begin(0),
+	m_lastBegin(0),
+	m_lastReport(0)
+{
+}
+
+/**
+ * @brief Marks the start of the code being profiled.
+ */
+void LoopProfiler::Begin()
+{
+	m_begin = RobotClock::GetTime();
+	if (m_lastBegin != 0)
+	{
+		m_period.Add(m_begin - m_lastBegin);
+	}
+	m_lastBegin = m_begin;
+}
+
+/**
+ * @brief Marks the end of the code being profiled, logging the summary
+ * if it is due.
+ */
+void LoopProfiler::End()
+{
+	const UINT32 now = RobotClock::GetTime();
+	m_run.Add(now - m_begin);
+	if (m_lastReport == 0)
+	{
+		m_lastReport = now;
+	}
+	else if (now - m_lastReport >= kProfilerReportPeriod * 1e6)
+	{
+		this->Report(now);
+	}
+}
+
+/**
+ * @brief Logs the summary and empties the histograms.
+ */
+void LoopProfiler::Report(UINT32 now)
+{
+	char summary[kLogMessageLength];
+	snprintf(summary, sizeof (summary),
+		"%s: n=%u run %u/%u/%u/%u period %u/%u/%u/%u us",
+		m_name, (unsigned)m_run.m_count,
+		(unsigned)m_run.m_min, (unsigned)m_run.GetPercentile(50),
+		(unsigned)m_run.GetPercentile(99), (unsigned)m_run.m_max,
+		(unsigned)m_period.m_min, (unsigned)m_period.GetPercentile(50),
+		(unsigned)m_period.GetPercentile(99), (unsigned)m_period.m_max);
+	LOG_TEXT(summary, kLogPriorityDebug);
+	m_run.Clear();
+	m_period.Clear();
+	m_lastReport = now;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef LOOPPROFILER_H
+#define LOOPPROFILER_H
+
+#include "WPILib.h"
+#include "../Robotmap.h"
+
+/**
+ * @brief Measures how long a piece of code takes each time it runs, and
+ * how long it is between the times it starts, for finding out how long
+ * the periodic methods and commands take and how much the loop jitters.
+ *
+ * Call Begin and End around the code, or create a LoopProfiler::Scope at
+ * the top of the block. The times are counted in fixed histograms of
+ * kProfilerBuckets buckets each kProfilerBucketWidth microseconds wide.
+ * Every kProfilerReportPeriod seconds End logs the count, then the minimum,
+ * median, 99th percentile and maximum of both, then starts again.
+ *
+ * The profiler is only compiled in when LOOP_PROFILER is defined, for
+ * example with -DLOOP_PROFILER. Otherwise every method is an empty inline
+ * function, so the profiling calls can be left in the code for free.
+ */
+class LoopProfiler
+{
+public:
+	/**
+	 * @brief Profiles the rest of the block it is declared in.
+	 */
+	class Scope
+	{
+	public:
+		inline explicit Scope(LoopProfiler& profiler) :
+			m_profiler(profiler)
+		{
+			m_profiler.Begin();
+		}
+
+		inline ~Scope()
+		{
+			m_profiler.End();
+		}
+
+	private:
+		LoopProfiler& m_profiler;
+	};
+
+#ifdef LOOP_PROFILER
+	explicit LoopProfiler(const char* name);
+	void Begin();
+	void End();
+
+private:
+	/**
+	 * @brief A histogram of times in microseconds.
+	 */
+	class Histogram
+	{
+	public:
+		Histogram();
+		void Clear();
+		UINT32 GetPercentile(int percent) const;
+
+		//! Counts a time
+		inline void Add(UINT32 time)
+		{
+			UINT32 bucket = time / kProfilerBucketWidth;
+			if (bucket >= static_cast<UINT32>(kProfilerBuckets))
+			{
+				bucket = kProfilerBuckets - 1;
+			}
+			++m_buckets[bucket];
+			++m_count;
+			if (time < m_min)
+			{
+				m_min = time;
+			}
+			if (time > m_max)
+			{
+				m_max = time;
+			}
+		}
+
+		UINT32 m_buckets[kProfilerBuckets];
+		UINT32 m_count;
+		UINT32 m_min;
+		UINT32 m_max;
+	};
+
+	void Report(UINT32 now);
+
+	const char* m_name;		//!< The name logged with the summary
+	Histogram m_run;		//!< The time from Begin to End
+	Histogram m_period;		//!< The time from one Begin to the next
+	UINT32 m_begin;			//!< The FPGA time of the latest Begin
+	UINT32 m_lastBegin;		//!< The FPGA time of the Begin before that
+	UINT32 m_lastReport;	//!< The FPGA time of the last summary
+#else
+	inline explicit LoopProfiler(const char* name) {}
+	inline void Begin() {}
+	inline void End() {}
+#endif
+};
+
+#endif
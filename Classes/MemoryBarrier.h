@@ -0,0 +1,23 @@
+#ifndef MEMORYBARRIER_H
+#define MEMORYBARRIER_H
+
+/**
+ * @brief Stops both the compiler and the processor from reordering memory
+ * accesses across the call. This is needed by the lock-free structures that
+ * hand data from one VxWorks task to another, so that a reader never sees a
+ * flag set before the data it guards has been written.
+ *
+ * The cRIO is a single core PowerPC, but the PowerPC is still free to reorder
+ * stores, hence the \c sync instruction.  On other hosts a compiler barrier is
+ * used which is enough for the x86 memory model.
+ */
+inline void MemoryBarrier()
+{
+#if defined(__PPC__) || defined(_ARCH_PPC) || defined(__ppc__)
+	__asm__ __volatile__ ("sync" : : : "memory");
+#else
+	__asm__ __volatile__ ("" : : : "memory");
+#endif
+}
+
+#endif
@@ -0,0 +1,233 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+namespace
+{
+	//! The most segments a profile can have: a stop, then accelerate,
+	//! cruise and decelerate
+	const int maxSegments = 4;
+
+	/**
+	 * @brief A part of the profile with constant acceleration.
+	 */
+	struct Segment
+	{
+		float m_duration;
+		float m_acceleration;
+	};
+
+	//! Returns -1, 0 or 1 depending on the sign of value
+	inline float Sign(float value)
+	{
+		return (value > 0) ? 1.0f : ((value < 0) ? -1.0f : 0.0f);
+	}
+}
+
+/**
+ * @brief Creates an empty motion profile.
+ */
+MotionProfile::MotionProfile() :
+	m_count(0),
+	m_step(kMotionProfileStep),
+	m_invStep(1.0f / kMotionProfileStep),
+	m_target(0)
+{
+}
+
+/**
+ * @brief Discards the current profile.
+ */
+void MotionProfile::Clear()
+{
+	m_count = 0;
+}
+
+/**
+ * @brief Calculates the profile.
+ * @param start The position to start from.
+ * @param startVelocity The velocity at the start.
+ * @param target The position to end at, with 0 velocity.
+ * @param maxVelocity The maximum velocity, in position units per second.
+ * @param maxAcceleration The maximum acceleration, in position units per second squared.
+ * @param maxJerk The maximum jerk, or 0 for a trapezoidal profile.
+ */
+void MotionProfile::Generate(
+	float start,
+	float startVelocity,
+	float target,
+	float maxVelocity,
+	float maxAcceleration,
+	float maxJerk)
+{
+	m_target = target;
+	if (maxVelocity <= 0 || maxAcceleration <= 0)
+	{
+		// Without limits the only profile is to jump to the target
+		m_positions[0] = target;
+		m_velocities[0] = 0;
+		m_count = 1;
+		return;
+	}
+
+	// Work out the constant acceleration segments
+	Segment segments[maxSegments];
+	int segmentCount = 0;
+	float position = start;
+	float velocity = startVelocity;
+	float distance = target - position;
+
+	// If we are moving away from the target, or too fast to stop before
+	// it, or faster than the maximum velocity, we first stop
+	if (velocity != 0 && (Sign(velocity) != Sign(distance) ||
+		velocity * velocity / (2 * maxAcceleration) > fabs(distance) ||
+		fabs(velocity) > maxVelocity))
+	{
+		const float duration = fabs(velocity) / maxAcceleration;
+		const float acceleration = -Sign(velocity) * maxAcceleration;
+		segments[segmentCount].m_duration = duration;
+		segments[segmentCount].m_acceleration = acceleration;
+		++segmentCount;
+		position += velocity * duration + 0.5f * acceleration * duration * duration;
+		velocity = 0;
+		distance = target - position;
+	}
+
+	// Now we are either stopped or heading towards the target and able to
+	// stop in time. Accelerate to the peak velocity, cruise, then stop.
+	const float direction = Sign(distance);
+	const float speed = fabs(velocity);
+	const float remaining = fabs(distance);
+	float peakSpeed = sqrt(maxAcceleration * remaining + 0.5f * speed * speed);
+	float cruiseTime = 0;
+	if (peakSpeed > maxVelocity)
+	{
+		peakSpeed = maxVelocity;
+		const float rampDistance = (peakSpeed * peakSpeed - speed * speed) / (2 * maxAcceleration) +
+			peakSpeed * peakSpeed / (2 * maxAcceleration);
+		cruiseTime = (remaining - rampDistance) / peakSpeed;
+	}
+	segments[segmentCount].m_duration = (peakSpeed - speed) / maxAcceleration;
+	segments[segmentCount].m_acceleration = direction * maxAcceleration;
+	++segmentCount;
+	segments[segmentCount].m_duration = cruiseTime;
+	segments[segmentCount].m_acceleration = 0;
+	++segmentCount;
+	segments[segmentCount].m_duration = peakSpeed / maxAcceleration;
+	segments[segmentCount].m_acceleration = -direction * maxAcceleration;
+	++segmentCount;
+
+	// The S-curve smoothing lengthens the profile by the smoothing window
+	float duration = 0;
+	for (int i = 0; i < segmentCount; ++i)
+	{
+		duration += segments[i].m_duration;
+	}
+	const float window = (maxJerk > 0) ? maxAcceleration / maxJerk : 0;
+
+	// Use the standard step unless the table is too small for the profile
+	m_step = kMotionProfileStep;
+	if ((duration + window) / m_step + 2 > kMotionProfileMaxPoints)
+	{
+		m_step = (duration + window) / (kMotionProfileMaxPoints - 2);
+	}
+	m_invStep = 1.0f / m_step;
+	const int windowSteps = static_cast<int>(window * m_invStep + 0.5f);
+
+	// Sample the velocity of the trapezoidal profile at each step
+	int segment = 0;
+	float segmentStart = 0;
+	float segmentVelocity = startVelocity;
+	m_count = static_cast<int>(ceil(duration * m_invStep)) + windowSteps + 1;
+	for (int i = 0; i < m_count; ++i)
+	{
+		const float time = i * m_step;
+		while (segment < segmentCount && time > segmentStart + segments[segment].m_duration)
+		{
+			segmentVelocity += segments[segment].m_acceleration * segments[segment].m_duration;
+			segmentStart += segments[segment].m_duration;
+			++segment;
+		}
+		m_velocities[i] = (segment < segmentCount) ?
+			segmentVelocity + segments[segment].m_acceleration * (time - segmentStart) : 0;
+	}
+
+	// Smooth the velocity with a trailing moving average to limit the jerk
+	if (windowSteps > 1)
+	{
+		// Before the window is full it is padded with the start velocity
+		float sum = startVelocity * windowSteps;
+		float history[kMotionProfileMaxPoints];
+		for (int i = 0; i < m_count; ++i)
+		{
+			history[i] = m_velocities[i];
+			sum += history[i];
+			sum -= (i >= windowSteps) ? history[i - windowSteps] : startVelocity;
+			m_velocities[i] = sum / windowSteps;
+		}
+	}
+
+	// Integrate the velocities into positions, then remove the small error
+	// left by the integration so the profile ends exactly on the target
+	m_positions[0] = start;
+	for (int i = 1; i < m_count; ++i)
+	{
+		m_positions[i] = m_positions[i - 1] + 0.5f * (m_velocities[i - 1] + m_velocities[i]) * m_step;
+	}
+	const float travelled = m_positions[m_count - 1] - start;
+	if (travelled != 0)
+	{
+		const float scale = (target - start) / travelled;
+		for (int i = 1; i < m_count; ++i)
+		{
+			m_positions[i] = start + (m_positions[i] - start) * scale;
+		}
+	}
+	m_positions[m_count - 1] = target;
+	m_velocities[m_count - 1] = 0;
+}
+
+/**
+ * @brief Returns the position time seconds after the start of the profile.
+ */
+float MotionProfile::GetPosition(float time) const
+{
+	if (m_count == 0)
+	{
+		return m_target;
+	}
+	const float index = time * m_invStep;
+	if (index <= 0)
+	{
+		return m_positions[0];
+	}
+	const int i = static_cast<int>(index);
+	if (i >= m_count - 1)
+	{
+		return m_target;
+	}
+	const float fraction = index - i;
+	return m_positions[i] + (m_positions[i + 1] - m_positions[i]) * fraction;
+}
+
+/**
+ * @brief Returns the velocity time seconds after the start of the profile.
+ */
+float MotionProfile::GetVelocity(float time) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+	const float index = time * m_invStep;
+	if (index <= 0)
+	{
+		return m_velocities[0];
+	}
+	const int i = static_cast<int>(index);
+	if (i >= m_count - 1)
+	{
+		return 0;
+	}
+	const float fraction = index - i;
+	return m_velocities[i] + (m_velocities[i + 1] - m_velocities[i]) * fraction;
+}
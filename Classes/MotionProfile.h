@@ -0,0 +1,75 @@
+#ifndef MOTIONPROFILE_H
+#define MOTIONPROFILE_H
+
+#include "../Robotmap.h"
+
+/**
+ * @brief A precomputed motion profile from a start position and velocity
+ * to a target position, limited by a maximum velocity and acceleration and
+ * optionally a maximum jerk.
+ *
+ * Generate calculates the whole trajectory once and stores the positions
+ * in a table at fixed time steps. The profile is then sampled at the time
+ * since it started, which is a table lookup and a linear interpolation, so
+ * the per-cycle cost does not depend on the length of the move and the
+ * profile follows the real elapsed time however long each cycle takes.
+ *
+ * Without a jerk limit the profile is trapezoidal. With one, the velocity
+ * of the trapezoidal profile is smoothed with a moving average whose length
+ * is the time to reach full acceleration at the jerk limit, which gives an
+ * S-curve profile that covers the same distance.
+ */
+class MotionProfile
+{
+public:
+	MotionProfile();
+
+	void Generate(float start, float startVelocity, float target,
+		float maxVelocity, float maxAcceleration, float maxJerk = 0);
+	void Clear();
+
+	float GetPosition(float time) const;
+	float GetVelocity(float time) const;
+
+	/**
+	 * @brief Returns true if a profile has been generated.
+	 */
+	inline bool IsValid() const
+	{
+		return m_count > 0;
+	}
+
+	/**
+	 * @brief Returns the position the profile ends at.
+	 */
+	inline float GetTarget() const
+	{
+		return m_target;
+	}
+
+	/**
+	 * @brief Returns the time in seconds the profile takes to reach its target.
+	 */
+	inline float GetDuration() const
+	{
+		return (m_count - 1) * m_step;
+	}
+
+	/**
+	 * @brief Returns true once time is past the end of the profile.
+	 */
+	inline bool IsFinished(float time) const
+	{
+		return time >= GetDuration();
+	}
+
+private:
+	float m_positions[kMotionProfileMaxPoints];	//!< The position at each step
+	float m_velocities[kMotionProfileMaxPoints];	//!< The velocity at each step
+	int m_count;		//!< The number of points in the table
+	float m_step;		//!< The time between points in seconds
+	float m_invStep;	//!< The reciprocal of m_step
+	float m_target;		//!< The final position
+};
+
+#endif
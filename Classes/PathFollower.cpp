@@ -0,0 +1,102 @@
+#include "PathFollower.h"
+#include <math.h>
+
+/**
+ * @brief Creates a path follower with no trajectory.
+ */
+PathFollower::PathFollower() :
+	m_trajectory(NULL),
+	m_closest(0),
+	m_lookahead(0),
+	m_finished(true)
+{
+}
+
+/**
+ * @brief Starts following a trajectory from its first point. The pose
+ * should have been reset to the start of the trajectory.
+ */
+void PathFollower::Start(const Trajectory* trajectory)
+{
+	m_trajectory = trajectory;
+	m_closest = 0;
+	m_lookahead = 0;
+	m_finished = (trajectory == NULL || trajectory->GetCount() == 0);
+}
+
+/**
+ * @brief Calculates the chassis velocity to follow the path for this cycle.
+ * @param pose The current pose of the robot.
+ * @param forward Set to the forward speed in inches per second.
+ * @param turnRate Set to the anticlockwise turn rate in radians per second.
+ * @return true once the end of the path has been reached, in which case
+ * both speeds are 0.
+ */
+bool PathFollower::Update(const RobotPose& pose, float& forward, float& turnRate)
+{
+	forward = 0;
+	turnRate = 0;
+	if (m_finished)
+	{
+		return true;
+	}
+
+	// Find the closest point, only looking a short way ahead of the last one
+	const int count = m_trajectory->GetCount();
+	const int searchEnd = (m_closest + kPathSearchWindow < count) ? m_closest + kPathSearchWindow : count;
+	float closestDistance = 1e30;
+	for (int i = m_closest; i < searchEnd; ++i)
+	{
+		const TrajectoryPoint& point = m_trajectory->GetPoint(i);
+		const float dx = point.m_x - pose.m_x;
+		const float dy = point.m_y - pose.m_y;
+		const float distance = dx * dx + dy * dy;
+		if (distance < closestDistance)
+		{
+			closestDistance = distance;
+			m_closest = i;
+		}
+	}
+	if (m_closest >= count - 1)
+	{
+		m_finished = true;
+		return true;
+	}
+
+	// Move the lookahead point on until it is kPathLookahead further along
+	// the path than the closest point. It only ever moves forward, so it
+	// never has far to go.
+	const float lookaheadDistance = m_trajectory->GetPoint(m_closest).m_distance + kPathLookahead;
+	if (m_lookahead < m_closest)
+	{
+		m_lookahead = m_closest;
+	}
+	for (int i = 0; i < kPathSearchWindow && m_lookahead < count - 1 &&
+		m_trajectory->GetPoint(m_lookahead).m_distance < lookaheadDistance; ++i)
+	{
+		++m_lookahead;
+	}
+	const TrajectoryPoint& target = m_trajectory->GetPoint(m_lookahead);
+
+	// Put the lookahead point in the robot's frame, x forward and y left
+	const float dx = target.m_x - pose.m_x;
+	const float dy = target.m_y - pose.m_y;
+	const float cosHeading = cos(pose.m_heading);
+	const float sinHeading = sin(pose.m_heading);
+	const float ahead = dx * cosHeading + dy * sinHeading;
+	const float left = dy * cosHeading - dx * sinHeading;
+	const float squared = ahead * ahead + left * left;
+
+	// The arc through the robot and the lookahead point has curvature
+	// 2 * left / distance^2
+	const float curvature = (squared > 0) ? 2 * left / squared : 0;
+	// The path starts and ends stopped, so take the faster of the closest
+	// point and the next one to get moving at the start
+	forward = m_trajectory->GetPoint(m_closest).m_velocity;
+	if (m_trajectory->GetPoint(m_closest + 1).m_velocity > forward)
+	{
+		forward = m_trajectory->GetPoint(m_closest + 1).m_velocity;
+	}
+	turnRate = forward * curvature;
+	return false;
+}
@@ -0,0 +1,41 @@
+#ifndef PATHFOLLOWER_H
+#define PATHFOLLOWER_H
+
+#include "../Robotmap.h"
+#include "Trajectory.h"
+#include "PoseEstimator.h"
+
+/**
+ * @brief Follows a Trajectory with pure pursuit.
+ *
+ * Each cycle the follower finds the trajectory point closest to the robot,
+ * searching only the kPathSearchWindow points after the previous closest
+ * point, then steers along the arc that passes through the point
+ * kPathLookahead inches further along the path, at the speed the
+ * trajectory gives for the closest point. The lookahead point only moves
+ * forward, by at most kPathSearchWindow points a cycle, so the cost of
+ * each cycle is bounded whatever the path.
+ */
+class PathFollower
+{
+public:
+	PathFollower();
+	void Start(const Trajectory* trajectory);
+	bool Update(const RobotPose& pose, float& forward, float& turnRate);
+
+	/**
+	 * @brief Returns true once the robot has reached the end of the path.
+	 */
+	inline bool IsFinished() const
+	{
+		return m_finished;
+	}
+
+private:
+	const Trajectory* m_trajectory;	//!< The trajectory being followed
+	int m_closest;					//!< The index of the closest point found last cycle
+	int m_lookahead;				//!< The index of the lookahead point
+	bool m_finished;				//!< Set when the end of the path is reached
+};
+
+#endif
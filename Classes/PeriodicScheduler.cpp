@@ -0,0 +1,257 @@
+#include "PeriodicScheduler.h"
+#include "MemoryBarrier.h"
+#include "RobotClock.h"
+#include "../CommandBase.h"
+#include <stdio.h>
+
+PeriodicScheduler* PeriodicScheduler::s_instance = NULL;
+
+/**
+ * @brief Returns the scheduler, creating it the first time it is called.
+ * The rate group tasks do not run until Start is called.
+ */
+PeriodicScheduler* PeriodicScheduler::GetInstance()
+{
+	if (s_instance == NULL)
+	{
+		s_instance = new PeriodicScheduler();
+	}
+	return s_instance;
+}
+
+/**
+ * @brief Creates the rate groups. The sensor group runs above the drive
+ * speed controller, the control group alongside it and the telemetry
+ * group below the periodic methods.
+ */
+PeriodicScheduler::PeriodicScheduler() :
+	m_semaphore(semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE)),
+	m_started(false),
+	m_reporter(*this)
+{
+	m_groups[kSensorRateGroup].m_name = "SensorRateGroup";
+	m_groups[kSensorRateGroup].m_period = static_cast<UINT32>(kSensorRatePeriod * 1e6);
+	m_groups[kSensorRateGroup].m_task = new Task(m_groups[kSensorRateGroup].m_name,
+		(FUNCPTR)PeriodicScheduler::GroupTask, Task::kDefaultPriority - 10);
+	m_groups[kControlRateGroup].m_name = "ControlRateGroup";
+	m_groups[kControlRateGroup].m_period = static_cast<UINT32>(kControlRatePeriod * 1e6);
+	m_groups[kControlRateGroup].m_task = new Task(m_groups[kControlRateGroup].m_name,
+		(FUNCPTR)PeriodicScheduler::GroupTask, Task::kDefaultPriority - 5);
+	m_groups[kTelemetryRateGroup].m_name = "TelemetryRateGroup";
+	m_groups[kTelemetryRateGroup].m_period = static_cast<UINT32>(kTelemetryRatePeriod * 1e6);
+	m_groups[kTelemetryRateGroup].m_task = new Task(m_groups[kTelemetryRateGroup].m_name,
+		(FUNCPTR)PeriodicScheduler::GroupTask, Task::kDefaultPriority + 5);
+	for (int i = 0; i < kRateGroups; ++i)
+	{
+		m_groups[i].m_jobCount = 0;
+		m_groups[i].m_overruns = 0;
+		m_groups[i].m_maxLateness = 0;
+	}
+	this->Register(&m_reporter, kTelemetryRateGroup, "SchedulerStatistics");
+}
+
+/**
+ * @brief Stops the rate group tasks.
+ */
+PeriodicScheduler::~PeriodicScheduler()
+{
+	for (int i = 0; i < kRateGroups; ++i)
+	{
+		m_groups[i].m_task->Stop();
+		delete m_groups[i].m_task;
+	}
+	semDelete(m_semaphore);
+}
+
+/**
+ * @brief Adds a job to the end of a rate group. Jobs past
+ * kSchedulerMaxJobs are logged and not run.
+ * @param job The job, which must never be deleted.
+ * @param group The rate group to run the job in.
+ * @param name The name of the job in the statistics, a string literal.
+ */
+void PeriodicScheduler::Register(PeriodicJob* job, RateGroup group, const char* name)
+{
+	const Synchronized sync(m_semaphore);
+	Group& rateGroup = m_groups[group];
+	if (rateGroup.m_jobCount >= kSchedulerMaxJobs)
+	{
+		LOG_MESSAGE("Too many periodic jobs in a rate group, not running the job.", kLogPriorityError);
+		return;
+	}
+	ScheduledJob& scheduled = rateGroup.m_jobs[rateGroup.m_jobCount];
+	const PeriodicJobStatistics statistics = {name, 0, 0, 0, 0};
+	scheduled.m_job = job;
+	scheduled.m_statistics = statistics;
+	// The group's task may already be running, so the job must be filled
+	// in before it is counted
+	MemoryBarrier();
+	rateGroup.m_jobCount = rateGroup.m_jobCount + 1;
+}
+
+/**
+ * @brief Starts the rate group tasks. Calling this again does nothing.
+ */
+void PeriodicScheduler::Start()
+{
+	const Synchronized sync(m_semaphore);
+	if (m_started)
+	{
+		return;
+	}
+	m_started = true;
+	for (int i = 0; i < kRateGroups; ++i)
+	{
+		m_groups[i].m_task->Start(reinterpret_cast<UINT32>(&m_groups[i]));
+	}
+}
+
+/**
+ * @brief Returns the timing of a job. The fields are each read without
+ * stopping the job, so they may come from consecutive runs.
+ * @param index The job's position in the group, from 0 to GetJobCount - 1.
+ */
+PeriodicJobStatistics PeriodicScheduler::GetStatistics(RateGroup group, int index) const
+{
+	return m_groups[group].m_jobs[index].m_statistics;
+}
+
+/**
+ * @brief Returns the number of jobs registered in a rate group.
+ */
+int PeriodicScheduler::GetJobCount(RateGroup group) const
+{
+	return m_groups[group].m_jobCount;
+}
+
+/**
+ * @brief Returns the number of cycles of a rate group that ended after
+ * the next cycle should have started.
+ */
+UINT32 PeriodicScheduler::GetOverrunCount(RateGroup group) const
+{
+	return m_groups[group].m_overruns;
+}
+
+/**
+ * @brief Returns the longest a cycle of a rate group has started after its
+ * deadline, in microseconds. This is the jitter of the group.
+ */
+UINT32 PeriodicScheduler::GetMaxLateness(RateGroup group) const
+{
+	return m_groups[group].m_maxLateness;
+}
+
+/**
+ * @brief Logs the overruns and lateness of each rate group and the average
+ * and longest run of each job.
+ */
+void PeriodicScheduler::LogStatistics() const
+{
+	char text[kLogMessageLength];
+	for (int i = 0; i < kRateGroups; ++i)
+	{
+		const Group& group = m_groups[i];
+		snprintf(text, sizeof(text), "%s: %u overruns, %u us max lateness",
+			group.m_name, group.m_overruns, group.m_maxLateness);
+		LOG_TEXT(text, kLogPriorityDebug);
+		const int jobCount = group.m_jobCount;
+		for (int j = 0; j < jobCount; ++j)
+		{
+			const PeriodicJobStatistics statistics = group.m_jobs[j].m_statistics;
+			snprintf(text, sizeof(text), "%s: %u runs, %u us average, %u us max",
+				statistics.m_name, statistics.m_runs,
+				statistics.m_runs > 0 ? statistics.m_totalTime / statistics.m_runs : 0,
+				statistics.m_maxTime);
+			LOG_TEXT(text, kLogPriorityDebug);
+		}
+	}
+}
+
+/**
+ * @brief Creates the reporter, which waits a whole kSchedulerReportPeriod
+ * before its first report.
+ */
+PeriodicScheduler::StatisticsReporter::StatisticsReporter(const PeriodicScheduler& scheduler) :
+	m_scheduler(scheduler),
+	m_lastReport(0)
+{
+}
+
+/**
+ * @brief Logs the statistics if a report is due.
+ */
+void PeriodicScheduler::StatisticsReporter::RunPeriodic()
+{
+	const UINT32 now = RobotClock::GetTime();
+	if (m_lastReport == 0)
+	{
+		m_lastReport = now;
+	}
+	else if (now - m_lastReport >= kSchedulerReportPeriod * 1e6)
+	{
+		m_lastReport = now;
+		m_scheduler.LogStatistics();
+	}
+}
+
+/**
+ * @brief Runs each of a group's jobs once, timing them.
+ */
+void PeriodicScheduler::RunJobs(Group& group)
+{
+	const int jobCount = group.m_jobCount;
+	MemoryBarrier();
+	for (int i = 0; i < jobCount; ++i)
+	{
+		ScheduledJob& scheduled = group.m_jobs[i];
+		const UINT32 start = RobotClock::GetTime();
+		scheduled.m_job->RunPeriodic();
+		const UINT32 time = RobotClock::GetTime() - start;
+		PeriodicJobStatistics& statistics = scheduled.m_statistics;
+		++statistics.m_runs;
+		statistics.m_lastTime = time;
+		statistics.m_totalTime += time;
+		if (time > statistics.m_maxTime)
+		{
+			statistics.m_maxTime = time;
+		}
+	}
+}
+
+/**
+ * @brief A rate group task. Runs the group's jobs, then sleeps until the
+ * next deadline, which is always a whole number of periods after the
+ * first so that the rate does not drift.
+ */
+void PeriodicScheduler::GroupTask(Group& group)
+{
+	UINT32 deadline = RobotClock::GetTime();
+	while (true)
+	{
+		// Never run the jobs early, even if the task woke before the deadline
+		INT32 lateness = static_cast<INT32>(RobotClock::GetTime() - deadline);
+		while (lateness < 0)
+		{
+			RobotClock::DelayUntil(deadline);
+			lateness = static_cast<INT32>(RobotClock::GetTime() - deadline);
+		}
+		if (static_cast<UINT32>(lateness) > group.m_maxLateness)
+		{
+			group.m_maxLateness = lateness;
+		}
+
+		RunJobs(group);
+
+		deadline += group.m_period;
+		const UINT32 now = RobotClock::GetTime();
+		if (static_cast<INT32>(deadline - now) <= 0)
+		{
+			// Skip the cycles that were missed rather than running them
+			// back to back, which would only make the next cycles late too
+			++group.m_overruns;
+			deadline += ((now - deadline) / group.m_period + 1) * group.m_period;
+		}
+		RobotClock::DelayUntil(deadline);
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef PERIODICSCHEDULER_H
+#define PERIODICSCHEDULER_H
+
+#include "WPILib.h"
+#include "../Robotmap.h"
+
+/**
+ * @brief Something that is run at a fixed rate by the PeriodicScheduler.
+ */
+class PeriodicJob
+{
+public:
+	virtual ~PeriodicJob() {}
+
+	/**
+	 * @brief Called once every period of the job's rate group. This runs
+	 * on the rate group's task, so it must not wait on anything slow.
+	 */
+	virtual void RunPeriodic() = 0;
+};
+
+/**
+ * @brief The timing statistics of a PeriodicJob, in microseconds.
+ */
+struct PeriodicJobStatistics
+{
+	const char* m_name;		//!< The name the job was registered with
+	UINT32 m_runs;			//!< The number of times the job has run
+	UINT32 m_lastTime;		//!< How long the latest run took
+	UINT32 m_maxTime;		//!< The longest run
+	UINT32 m_totalTime;		//!< The time taken by all of the runs
+};
+
+/**
+ * @brief Runs PeriodicJobs at fixed rates, independent of the driver
+ * station paced periodic methods.
+ *
+ * Each RateGroup has its own task, at a higher priority the faster the
+ * group, that runs the group's jobs in the order they were registered
+ * and then sleeps until the next multiple of the group's period. Sleeping
+ * to an absolute deadline means the time the jobs take does not add to
+ * the period. A cycle that ends after the next deadline is counted as an
+ * overrun, and the missed cycles are dropped rather than run back to back.
+ *
+ * Jobs are registered, normally by the subsystem that owns them, before
+ * or after Start. Jobs cannot be removed, and a group runs at most
+ * kSchedulerMaxJobs jobs. The scheduler registers its own job in the
+ * telemetry group that logs the statistics every kSchedulerReportPeriod.
+ */
+class PeriodicScheduler
+{
+public:
+	static PeriodicScheduler* GetInstance();
+	void Register(PeriodicJob* job, RateGroup group, const char* name);
+	void Start();
+	PeriodicJobStatistics GetStatistics(RateGroup group, int index) const;
+	int GetJobCount(RateGroup group) const;
+	UINT32 GetOverrunCount(RateGroup group) const;
+	UINT32 GetMaxLateness(RateGroup group) const;
+	void LogStatistics() const;
+
+private:
+	/**
+	 * @brief Logs the scheduler's statistics every kSchedulerReportPeriod,
+	 * from the telemetry rate group.
+	 */
+	class StatisticsReporter: public PeriodicJob
+	{
+	public:
+		explicit StatisticsReporter(const PeriodicScheduler& scheduler);
+		virtual void RunPeriodic();
+
+	private:
+		const PeriodicScheduler& m_scheduler;
+		UINT32 m_lastReport;
+	};
+
+	/**
+	 * @brief A registered job and its timing, only written by its group's task.
+	 */
+	struct ScheduledJob
+	{
+		PeriodicJob* m_job;
+		PeriodicJobStatistics m_statistics;
+	};
+
+	/**
+	 * @brief The jobs that run at one rate, and the task that runs them.
+	 */
+	struct Group
+	{
+		const char* m_name;						//!< The name of the group's task
+		UINT32 m_period;						//!< The period in microseconds
+		ScheduledJob m_jobs[kSchedulerMaxJobs];	//!< The jobs in the order they run
+		volatile int m_jobCount;				//!< Only incremented once the job is filled in
+		volatile UINT32 m_overruns;				//!< The number of cycles that missed the next deadline
+		volatile UINT32 m_maxLateness;			//!< The latest a cycle has started after its deadline
+		Task* m_task;							//!< The task that runs the group
+	};
+
+	PeriodicScheduler();
+	~PeriodicScheduler();
+	static void GroupTask(Group& group);
+	static void RunJobs(Group& group);
+
+	static PeriodicScheduler* s_instance;
+
+	Group m_groups[kRateGroups];
+	//! Serializes Register and Start
+	const SEM_ID m_semaphore;
+	bool m_started;
+	StatisticsReporter m_reporter;
+};
+
+#endif
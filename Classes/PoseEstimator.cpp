@@ -0,0 +1,150 @@
+#include "PoseEstimator.h"
+#include "RampedCANJaguar.h"
+#include "RobotClock.h"
+#include <math.h>
+
+/**
+ * @brief Creates the pose estimator. The pose is not updated until Start
+ * is called.
+ * @param mode The drive mode, which decides the kinematics.
+ * @param frontLeft The front left drive motor.
+ * @param rearLeft The rear left drive motor.
+ * @param frontRight The front right drive motor.
+ * @param rearRight The rear right drive motor.
+ */
+PoseEstimator::PoseEstimator(
+	DriveMode mode,
+	RampedCANJaguar* frontLeft,
+	RampedCANJaguar* rearLeft,
+	RampedCANJaguar* frontRight,
+	RampedCANJaguar* rearRight) :
+	m_mixer(mode),
+	m_estimatorTask("PoseEstimator", (FUNCPTR)PoseEstimator::EstimatorTask, Task::kDefaultPriority + 5)
+{
+	m_jaguars[kFrontLeftWheel] = frontLeft;
+	m_jaguars[kRearLeftWheel] = rearLeft;
+	m_jaguars[kFrontRightWheel] = frontRight;
+	m_jaguars[kRearRightWheel] = rearRight;
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		m_positions[i] = 0.0;
+		m_statusTimes[i] = 0;
+	}
+	const RobotPose origin = {0, 0.0, 0.0, 0.0};
+	m_current = origin;
+	m_pose.Write(origin);
+	const PoseOrigin poseOrigin = {origin, 1.0, 0.0};
+	m_origin.Write(poseOrigin);
+}
+
+/**
+ * @brief Stops the estimator task.
+ */
+PoseEstimator::~PoseEstimator()
+{
+	m_estimatorTask.Stop();
+}
+
+/**
+ * @brief Starts the estimator task. Only call this when the drive motors
+ * have encoders.
+ */
+void PoseEstimator::Start()
+{
+	m_estimatorTask.Start(reinterpret_cast<UINT32>(this));
+}
+
+/**
+ * @brief Makes the current position of the robot the origin, facing along
+ * the x axis. GetPose returns the new origin as soon as this returns.
+ * Only call this from the task that runs the commands.
+ */
+void PoseEstimator::Reset()
+{
+	PoseOrigin origin;
+	origin.m_pose = m_pose.Read();
+	origin.m_cosHeading = cos(origin.m_pose.m_heading);
+	origin.m_sinHeading = sin(origin.m_pose.m_heading);
+	m_origin.Write(origin);
+}
+
+/**
+ * @brief Returns the latest pose, relative to where the robot was at the
+ * last Reset.
+ */
+RobotPose PoseEstimator::GetPose() const
+{
+	const RobotPose current = m_pose.Read();
+	const PoseOrigin origin = m_origin.Read();
+	const float dx = current.m_x - origin.m_pose.m_x;
+	const float dy = current.m_y - origin.m_pose.m_y;
+	RobotPose pose;
+	pose.m_time = current.m_time;
+	pose.m_x = dx * origin.m_cosHeading + dy * origin.m_sinHeading;
+	pose.m_y = dy * origin.m_cosHeading - dx * origin.m_sinHeading;
+	pose.m_heading = current.m_heading - origin.m_pose.m_heading;
+	return pose;
+}
+
+/**
+ * @brief Integrates the change in the encoder positions into the pose.
+ */
+void PoseEstimator::Update()
+{
+	float revolutions[kDriveWheels];
+	UINT32 newestTime = 0;
+	bool moved = false;
+	for (int i = 0; i < kDriveWheels; ++i)
+	{
+		const JaguarStatus status = m_jaguars[i]->GetStatus();
+		revolutions[i] = 0.0;
+		if (status.m_time == 0)
+		{
+			// The motor has not been read yet
+			continue;
+		}
+		if (m_statusTimes[i] != 0 && status.m_time != m_statusTimes[i])
+		{
+			revolutions[i] = status.m_position - m_positions[i];
+			moved = true;
+		}
+		m_positions[i] = status.m_position;
+		m_statusTimes[i] = status.m_time;
+		if (newestTime == 0 || static_cast<INT32>(status.m_time - newestTime) > 0)
+		{
+			newestTime = status.m_time;
+		}
+	}
+
+	if (!moved)
+	{
+		return;
+	}
+
+	float forward;
+	float strafe;
+	float rotation;
+	m_mixer.Odometry(revolutions, forward, strafe, rotation);
+
+	// Move along the average heading over the update
+	const float heading = m_current.m_heading + rotation * 0.5;
+	const float cosHeading = cos(heading);
+	const float sinHeading = sin(heading);
+	m_current.m_x += forward * cosHeading + strafe * sinHeading;
+	m_current.m_y += forward * sinHeading - strafe * cosHeading;
+	m_current.m_heading += rotation;
+	m_current.m_time = newestTime;
+	m_pose.Write(m_current);
+}
+
+/**
+ * @brief The estimator task, updates the pose every kPoseEstimatorPeriod.
+ */
+void PoseEstimator::EstimatorTask(PoseEstimator& estimator)
+{
+	while (true)
+	{
+		estimator.Update();
+		RobotClock::Delay(kPoseEstimatorPeriod);
+	}
+}
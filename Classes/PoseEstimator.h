@@ -0,0 +1,83 @@
+#ifndef POSEESTIMATOR_H
+#define POSEESTIMATOR_H
+
+#include "WPILib.h"
+#include "../Robotmap.h"
+#include "DriveMixer.h"
+#include "SeqLock.h"
+
+class RampedCANJaguar;
+
+/**
+ * @brief The position and heading of the robot on the field, relative to
+ * where it was when the pose was last reset.
+ */
+struct RobotPose
+{
+	UINT32 m_time;		//!< The FPGA time of the newest encoder reading used
+	float m_x;			//!< Inches forward of the starting position
+	float m_y;			//!< Inches to the left of the starting position
+	float m_heading;	//!< Radians anticlockwise from the starting heading
+};
+
+/**
+ * @brief Estimates the pose of the robot from the drive motor encoders.
+ *
+ * A task runs every kPoseEstimatorPeriod, takes the change in each drive
+ * motor's encoder position from the status cached by the
+ * JaguarStatusPoller, turns it into the motion of the robot with the drive
+ * mode's forward kinematics and integrates it into the pose. Commands read
+ * the latest pose with GetPose, which never blocks.
+ *
+ * The Jaguars are polled one at a time, so an update may only see some of
+ * the wheels move. The odometry is linear in the wheel distances, so the
+ * pose still adds up to the right answer, each wheel's movement is just
+ * counted when its encoder was read.
+ *
+ * The task integrates the pose from where the robot started and never
+ * resets it. Reset instead records the current pose as the origin, which
+ * GetPose subtracts, so a reset takes effect before Reset returns. The
+ * origin is published through its own SeqLock, so Reset must only ever be
+ * called from one task, the one running the commands.
+ */
+class PoseEstimator
+{
+public:
+	PoseEstimator(DriveMode mode, RampedCANJaguar* frontLeft, RampedCANJaguar* rearLeft,
+		RampedCANJaguar* frontRight, RampedCANJaguar* rearRight);
+	~PoseEstimator();
+	void Start();
+	void Reset();
+	RobotPose GetPose() const;
+
+private:
+	//! The pose at the last Reset, which GetPose makes the origin
+	struct PoseOrigin
+	{
+		RobotPose m_pose;
+		float m_cosHeading;
+		float m_sinHeading;
+	};
+
+	static void EstimatorTask(PoseEstimator& estimator);
+	void Update();
+
+	//! The kinematics of the drive mode
+	const DriveMixer m_mixer;
+	//! The drive motors, indexed by DriveWheel
+	RampedCANJaguar* m_jaguars[kDriveWheels];
+	//! The encoder position of each motor at the previous update
+	float m_positions[kDriveWheels];
+	//! The time of the status of each motor at the previous update
+	UINT32 m_statusTimes[kDriveWheels];
+	//! The pose being integrated, only used by the estimator task
+	RobotPose m_current;
+	//! The latest pose, published for the other tasks
+	SeqLock<RobotPose> m_pose;
+	//! The origin set by Reset, written only by the task calling Reset
+	SeqLock<PoseOrigin> m_origin;
+	//! The task that integrates the pose
+	Task m_estimatorTask;
+};
+
+#endif
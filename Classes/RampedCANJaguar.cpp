@@ -6,9 +6,16 @@
  */
 
 #include "RampedCANJaguar.h"
+#include "RobotClock.h"
+#include "JaguarStatusPoller.h"
 #include "../Robotmap.h"
+#include <intLib.h>
 #include <math.h>
 
+UINT32 RampedCANJaguar::s_messageCount = 0;
+UINT32 RampedCANJaguar::s_writeCount = 0;
+UINT32 RampedCANJaguar::s_suppressedCount = 0;
+
 RampedCANJaguar::RampedCANJaguar(int deviceNumber,
                                  float ramp,
                                  float maxAcceleration,
@@ -19,19 +26,34 @@ RampedCANJaguar::RampedCANJaguar(int deviceNumber,
     m_maxVelocity(ramp),
     m_tolerance(tolerance),
     m_thereTolerance(thereTolerance),
-    m_prevTime(0.0),
+    m_prevTime(0),
     m_prevPosition(0.0),
     m_prevVelocity(0.0),
     m_prevAccel(0.0),
-    m_ramp(ramp)
+    m_ramp(ramp),
+    m_maxJerk(0.0),
+    m_profileStartTime(0),
+    m_syncGroup(0),
+    m_written(false),
+    m_lastWritten(0.0),
+    m_lastWriteTime(0),
+    m_electricalPolled(false)
+{
+    JaguarStatus status = {0, 0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    m_status.Write(status);
+    JaguarStatusPoller::GetInstance()->Register(this);
+}
+
+RampedCANJaguar::~RampedCANJaguar()
 {
-	; // do nothing, all initialization is done above
+    JaguarStatusPoller::GetInstance()->Unregister(this);
 }
 
 void RampedCANJaguar::PrintLimits()
 {
     printf("max Velocity: %f",m_maxVelocity);
     printf("max Acceleration: %f",m_maxAcceleration);
+    printf("max Jerk: %f",m_maxJerk);
 }
 
 void RampedCANJaguar::SetTolerance(float tolerance, float thereTolerance)
@@ -50,86 +72,195 @@ void RampedCANJaguar::SetMaxAcceleration(float maxAcceleration)
     m_maxAcceleration = maxAcceleration;
 }
 
+/**
+ * @brief Sets the maximum jerk used in position mode. With a jerk limit
+ * the position profile is an S-curve, with 0 it is trapezoidal.
+ */
+void RampedCANJaguar::SetMaxJerk(float maxJerk)
+{
+    m_maxJerk = maxJerk;
+}
+
+/**
+ * @brief Sets the sync group the setpoints are sent in. Setpoints sent in
+ * a sync group take effect when UpdateSyncGroup is called for the group,
+ * so a set of motors can be updated together. 0 applies them immediately.
+ */
+void RampedCANJaguar::SetSyncGroup(UINT8 syncGroup)
+{
+    m_syncGroup = syncGroup;
+}
+
+/**
+ * @brief Applies the setpoints sent in a sync group, counting the message.
+ */
+void RampedCANJaguar::UpdateSyncGroup(UINT8 syncGroup)
+{
+    CANJaguar::UpdateSyncGroup(syncGroup);
+    CountMessages(1);
+}
+
+/**
+ * @brief Adds to the CAN message count. The drive and status poller tasks
+ * both send messages, so the count is updated with interrupts locked to
+ * stop a task switch losing an increment.
+ */
+void RampedCANJaguar::CountMessages(UINT32 count)
+{
+    const int lockKey = intLock();
+    s_messageCount += count;
+    intUnlock(lockKey);
+}
+
 void RampedCANJaguar::DisableControl()
 {
     //m_prevPosition = 0.0; // <-- Not sure why we did this last year
+    m_written = false;
     CANJaguar::DisableControl();
 }
 
+/**
+ * @brief Stops the motor, as RobotDrive::StopMotor does when the motor
+ * safety times out. The Jaguar forgets its setpoint, so the next one is
+ * always sent, and the ramp starts again from a standstill.
+ */
+void RampedCANJaguar::Disable()
+{
+    CANJaguar::Disable();
+    CountMessages(1);
+    m_written = false;
+    m_prevTime = 0;
+    m_prevVelocity = 0.0;
+    m_prevAccel = 0.0;
+    m_profile.Clear();
+}
+
 void RampedCANJaguar::EnableControl(float encoderInitialPosition)
 {
     CANJaguar::EnableControl(encoderInitialPosition);
+    m_written = false;
     m_prevPosition = encoderInitialPosition;
 }
 
 void RampedCANJaguar::EnableControl()
 {
     CANJaguar::EnableControl(m_prevPosition);
+    m_written = false;
 }
 
 void RampedCANJaguar::SetOutput(float outputValue)
 {
-    //float curTime = GetTime();
     float position = m_prevPosition;
     float velocity = m_prevVelocity;
     float accel = m_prevAccel;
+    const float period = GetPeriod();
     switch(GetControlMode()) 
     {
         case kPercentVbus:
         case kSpeed:
+        {
             //accel = Limit( (outputValue - m_prevVelocity)/deltaT, m_maxAcceleration );
             //velocity = Limit( m_prevVelocity + (accel * deltaT), m_maxVelocity );
         	
         	//accel = Limit( (outputValue - m_prevVelocity), m_maxVelocity /* 0.2 works*/ );
         	//velocity = Limit( m_prevVelocity + accel, 1 );
 
-        	velocity = m_prevVelocity + (outputValue-m_prevVelocity) * m_ramp;
-            CANJaguar::Set(velocity);
+        	// m_ramp is the fraction of the remaining change made each
+        	// kDrivePeriod, so compound it over the measured period. Only
+        	// the ramped modes pay for the pow.
+        	const float rampFraction = (m_ramp >= 1.0) ? 1.0 : 1.0 - pow(1.0 - m_ramp, period / kDrivePeriod);
+        	velocity = m_prevVelocity + (outputValue-m_prevVelocity) * rampFraction;
+            Write(velocity);
             break;
+        }
         case kPosition:
-            float deltaP = outputValue - m_prevPosition;
+        {
+            const float deltaP = outputValue - m_prevPosition;
             if ( fabs(deltaP) <= m_thereTolerance )
             {
-                CANJaguar::Set(outputValue);
+                m_profile.Clear();
+                position = outputValue;
+                velocity = 0.0;
+                accel = 0.0;
+                Write(position);
                 break;
             }
-            else if ( fabs(deltaP) <= m_tolerance )
+            // Plan a profile from where we are to the target whenever the
+            // target moves by more than the there tolerance. Planning is the
+            // only expensive part, following the profile is a table lookup.
+            // A looser threshold would let a profile finish outside the there
+            // tolerance of the target, and the output would never snap to it.
+            const UINT32 curTime = RobotClock::GetTime();
+            if ( !m_profile.IsValid() || fabs(outputValue - m_profile.GetTarget()) > m_thereTolerance )
             {
-                CANJaguar::Set(m_prevPosition + 0.4*(deltaP));
-                break;
-            }
-            velocity = Limit( deltaP/deltaT, m_maxVelocity );
-            accel = Limit( (velocity - m_prevVelocity) / deltaT, m_maxAcceleration );
-            velocity = m_prevVelocity + accel * deltaT;
-            position = m_prevPosition + m_prevVelocity * deltaT + 0.5 * accel * deltaT * deltaT;
-            if ( 
-                    (((outputValue - position) > 0) && 
-                     ((outputValue - position) < ((velocity*velocity) / (2*m_maxAcceleration)))) || 
-                    (((outputValue - position) < 0) && 
-                     ((outputValue - position) > -((velocity*velocity) / (2*m_maxAcceleration)))) 
-               )
-            {
-                if( (deltaP) > m_tolerance )
-                {
-                    accel = -m_maxAcceleration;
-                } else if ( (deltaP) < -m_tolerance )
-                {
-                    accel = m_maxAcceleration;
-                } 
-                velocity = m_prevVelocity + accel * deltaT;
-                position = m_prevPosition + m_prevVelocity * deltaT + 0.5 * accel * deltaT * deltaT;
+                m_profile.Generate(m_prevPosition, m_prevVelocity, outputValue,
+                                   m_maxVelocity, m_maxAcceleration, m_maxJerk);
+                m_profileStartTime = curTime;
             }
-            CANJaguar::Set(position);
+            // Sample the profile at the measured time since it started, so
+            // it stays on schedule however long each cycle actually takes
+            const float elapsed = (curTime - m_profileStartTime) * 1e-6;
+            position = m_profile.GetPosition(elapsed);
+            velocity = m_profile.GetVelocity(elapsed);
+            accel = 0.0;
+            Write(position);
             break;
+        }
         default:
-            CANJaguar::Set(outputValue);
+            Write(outputValue);
             break;
     }
-    //m_prevTime = curTime;
+    m_prevPosition = position;
     m_prevVelocity = velocity;
     m_prevAccel = accel;
 }
 
+/**
+ * @brief Returns the measured time in seconds since the previous call,
+ * clamped to kDriveMaxPeriod so that the first call and the first call
+ * after a long pause do not make a jump.
+ */
+float RampedCANJaguar::GetPeriod()
+{
+    const UINT32 curTime = RobotClock::GetTime();
+    float period = kDrivePeriod;
+    if (m_prevTime != 0)
+    {
+        period = (curTime - m_prevTime) * 1e-6;
+        if (period > kDriveMaxPeriod)
+        {
+            period = kDriveMaxPeriod;
+        }
+    }
+    m_prevTime = curTime;
+    return period;
+}
+
+/**
+ * @brief Sends a setpoint to the Jaguar unless it is within
+ * kCANWriteTolerance of the last one sent. The setpoint is resent every
+ * kCANRefreshPeriod anyway, so a Jaguar that has reset picks it up again.
+ */
+void RampedCANJaguar::Write(float value)
+{
+    // In whole microseconds, as the float period is not exactly 0.1 s
+    static const UINT32 refreshPeriod = static_cast<UINT32>(kCANRefreshPeriod * 1e6 + 0.5);
+    const UINT32 curTime = RobotClock::GetTime();
+    if (m_written &&
+        fabs(value - m_lastWritten) <= kCANWriteTolerance &&
+        (curTime - m_lastWriteTime) < refreshPeriod)
+    {
+        ++s_suppressedCount;
+        return;
+    }
+    CANJaguar::Set(value, m_syncGroup);
+    CountMessages(1);
+    ++s_writeCount;
+    m_written = true;
+    m_lastWritten = value;
+    m_lastWriteTime = curTime;
+}
+
 float RampedCANJaguar::Limit(float input, float max) 
 {
     if (input > max)
@@ -142,7 +273,44 @@ float RampedCANJaguar::Limit(float input, float max)
     return input;
 }
 
+/**
+ * @brief Returns the measured position last read by the JaguarStatusPoller,
+ * or the last position setpoint if the Jaguar has not been read yet.
+ */
 float RampedCANJaguar::Get()
 {
-    return m_prevPosition;
+    const JaguarStatus status = m_status.Read();
+    return (status.m_time != 0) ? status.m_position : m_prevPosition;
+}
+
+/**
+ * @brief Reads the status of the Jaguar over the CAN bus and publishes it
+ * for GetStatus. This is called by the JaguarStatusPoller task, never
+ * from the control loop.
+ *
+ * The position and speed, which the control loops use, are read on every
+ * poll. The bus voltage, current and temperature change slowly and are
+ * only for reporting, so they are read once every kCANElectricalPollPeriod
+ * and the previous values are republished in between.
+ */
+void RampedCANJaguar::PollStatus()
+{
+    // The poller is the only writer, so this is the last status it wrote
+    JaguarStatus status = m_status.Read();
+    const UINT32 start = RobotClock::GetTime();
+    if (!m_electricalPolled
+        || start - status.m_electricalTime >= kCANElectricalPollPeriod * 1e6)
+    {
+        m_electricalPolled = true;
+        status.m_busVoltage = GetBusVoltage();
+        status.m_outputCurrent = GetOutputCurrent();
+        status.m_temperature = GetTemperature();
+        status.m_electricalTime = start;
+        CountMessages(kJaguarElectricalRequests);
+    }
+    status.m_position = GetPosition();
+    status.m_speed = GetSpeed();
+    status.m_time = RobotClock::GetTime();
+    m_status.Write(status);
+    CountMessages(kJaguarMotionRequests);
 }
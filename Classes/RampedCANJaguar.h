@@ -3,6 +3,8 @@
 
 #include <WPILib.h>
 #include <CANJaguar.h>
+#include "MotionProfile.h"
+#include "SeqLock.h"
 /*
  * RampedCANJaguar.h
  *
@@ -10,6 +12,20 @@
  *      Author: Joseph Martin
  */
 
+/**
+ * @brief The status of a Jaguar as last read by the JaguarStatusPoller.
+ */
+struct JaguarStatus
+{
+    UINT32 m_time;          //!< The FPGA time the position and speed were read, 0 if never
+    UINT32 m_electricalTime; //!< The FPGA time the voltage, current and temperature were read
+    float m_busVoltage;
+    float m_outputCurrent;
+    float m_temperature;
+    float m_position;
+    float m_speed;
+};
+
 /*
  * Description:
  */
@@ -20,23 +36,81 @@ private:
     float m_maxVelocity;
     float m_tolerance;
     float m_thereTolerance;
-    float m_prevTime;
+    UINT32 m_prevTime;
     float m_prevPosition;
     float m_prevVelocity;
     float m_prevAccel;
     float m_ramp;
-    static const float deltaT = 0.02;
+    float m_maxJerk;
+    MotionProfile m_profile;
+    UINT32 m_profileStartTime;
+    UINT8 m_syncGroup;
+    bool m_written;
+    float m_lastWritten;
+    UINT32 m_lastWriteTime;
+    static UINT32 s_messageCount;
+    static UINT32 s_writeCount;
+    static UINT32 s_suppressedCount;
+    void Write(float value);
+    static void CountMessages(UINT32 count);
+    SeqLock<JaguarStatus> m_status;
+    bool m_electricalPolled;    //!< Only used by PollStatus, as the FPGA time can be 0
     float Limit(float in, float max);
+    float GetPeriod();
 public:
     RampedCANJaguar(int deviceNumber, float maxVelocity, float maxAcceleration, float m_tolerance, float m_thereTolerance);
+    virtual ~RampedCANJaguar();
     void PrintLimits();
     void SetMaxAcceleration(float maxAcceleration);
     void SetMaxVelocity(float maxVelocity);
+    void SetMaxJerk(float maxJerk);
     void SetTolerance(float tolerance, float thereTolerance);
     void DisableControl();
+    virtual void Disable();
     void EnableControl(float encoderInitialPosition);
     void EnableControl();
     void SetOutput(float outputValue);
     float Get();
+    void PollStatus();
+
+    /**
+     * @brief Returns the status last read by the JaguarStatusPoller,
+     * without touching the CAN bus.
+     */
+    JaguarStatus GetStatus() const
+    {
+        return m_status.Read();
+    }
+    void SetSyncGroup(UINT8 syncGroup);
+    static void UpdateSyncGroup(UINT8 syncGroup);
+
+    /**
+     * @brief Returns the number of CAN messages sent by all of the
+     * RampedCANJaguars, including the status requests made by
+     * PollStatus.
+     */
+    static UINT32 GetMessageCount()
+    {
+        return s_messageCount;
+    }
+
+    /**
+     * @brief Returns the number of setpoints sent by all of the
+     * RampedCANJaguars. This is only changed by the control loops, so
+     * it shows whether a sync group update is needed.
+     */
+    static UINT32 GetWriteCount()
+    {
+        return s_writeCount;
+    }
+
+    /**
+     * @brief Returns the number of setpoint writes skipped because the
+     * setpoint had not changed.
+     */
+    static UINT32 GetSuppressedCount()
+    {
+        return s_suppressedCount;
+    }
 };
 #endif
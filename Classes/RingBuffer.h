@@ -0,0 +1,104 @@
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include "MemoryBarrier.h"
+
+/** @brief A fixed capacity, allocation free, lock-free queue for passing
+ * items from one task to another.
+ *
+ * There must only be a single producer task and a single consumer task.
+ * The producer adds items with \c Push, or with \c BeginPush / \c EndPush
+ * to fill an item in place, and the consumer removes them with \c Pop.
+ * Neither side ever waits for the other: if the buffer is full the new
+ * item is dropped and counted.
+ *
+ * \c Capacity must be a power of 2 so that the free running indices stay
+ * correct when they wrap.
+ *
+ * @version 1.0
+ */
+template <typename T, unsigned Capacity>
+class RingBuffer
+{
+public:
+	//! Creates an empty ring buffer
+	inline RingBuffer () :
+		m_head (0), m_tail (0), m_dropped (0)
+	{
+	}
+
+	//! Returns a pointer to the next free item for the producer to fill
+	//! in, or NULL if the buffer is full in which case the item is counted
+	//! as dropped.  Call \c EndPush once the item has been filled in.
+	inline T* BeginPush()
+	{
+		if (m_head - m_tail >= Capacity)
+		{
+			++m_dropped;
+			return 0;
+		}
+		return &m_items[m_head & (Capacity - 1)];
+	}
+
+	//! Makes the item returned by \c BeginPush visible to the consumer
+	inline void EndPush()
+	{
+		MemoryBarrier();
+		m_head = m_head + 1;
+	}
+
+	//! Adds a copy of the item to the buffer, returning false if the buffer
+	//! was full and the item was dropped
+	inline bool Push (const T& item)
+	{
+		T* const slot = BeginPush();
+		if (slot == 0)
+		{
+			return false;
+		}
+		*slot = item;
+		EndPush();
+		return true;
+	}
+
+	//! Removes the oldest item from the buffer, returning false if the
+	//! buffer was empty
+	inline bool Pop (T& item)
+	{
+		if (m_tail == m_head)
+		{
+			return false;
+		}
+		MemoryBarrier();
+		item = m_items[m_tail & (Capacity - 1)];
+		MemoryBarrier();
+		m_tail = m_tail + 1;
+		return true;
+	}
+
+	//! Returns the number of items waiting in the buffer
+	inline unsigned Size() const
+	{
+		return m_head - m_tail;
+	}
+
+	//! Returns the number of items dropped because the buffer was full
+	inline unsigned GetDroppedCount() const
+	{
+		return m_dropped;
+	}
+
+	//! Returns the maximum number of items the buffer can hold
+	static inline unsigned GetCapacity()
+	{
+		return Capacity;
+	}
+
+private:
+	T m_items[Capacity];		//!< The storage for the items
+	volatile unsigned m_head;	//!< Total items pushed, only written by the producer
+	volatile unsigned m_tail;	//!< Total items popped, only written by the consumer
+	volatile unsigned m_dropped;//!< Items dropped because the buffer was full
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef ROBOTCLOCK_H
+#define ROBOTCLOCK_H
+
+#include "WPILib.h"
+
+/**
+ * @brief The time the control code runs on, the FPGA clock, with a
+ * DelayUntil that never wakes early.
+ *
+ * Code that measures periods, timestamps data or sleeps between the steps
+ * of a control loop should use RobotClock rather than GetFPGATime and Wait.
+ * The host simulation in Tools/Simulation runs GetFPGATime and taskDelay on
+ * a virtual clock, so all of that code then runs faster than real time and
+ * gives the same results on every run.
+ */
+class RobotClock
+{
+public:
+	/**
+	 * @brief Returns the time in microseconds, see GetFPGATime.
+	 */
+	static inline UINT32 GetTime()
+	{
+		return GetFPGATime();
+	}
+
+	/**
+	 * @brief Pauses the calling task for the number of seconds.
+	 */
+	static inline void Delay(double seconds)
+	{
+		Wait(seconds);
+	}
+
+	/**
+	 * @brief Pauses the calling task until the time, in microseconds, has
+	 * been reached. Unlike Wait, which rounds down to whole clock ticks,
+	 * this rounds up. A delay of n ticks ends on the nth tick, which can be
+	 * up to a tick short, so it then waits for one more tick if needed and
+	 * the task never wakes early.
+	 */
+	static inline void DelayUntil(UINT32 time)
+	{
+		INT32 remaining = static_cast<INT32>(time - GetFPGATime());
+		while (remaining > 0)
+		{
+			taskDelay(static_cast<int>((static_cast<double>(remaining) * sysClkRateGet() + 999999) / 1000000));
+			remaining = static_cast<INT32>(time - GetFPGATime());
+		}
+	}
+};
+
+#endif
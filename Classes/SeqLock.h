@@ -0,0 +1,81 @@
+#ifndef SEQ_LOCK_H_
+#define SEQ_LOCK_H_
+
+#include "MemoryBarrier.h"
+
+/** @brief Publishes a value from one writer task to any number of reader
+ * tasks without either side ever blocking.
+ *
+ * The writer fills in whichever of two copies readers are not using and
+ * then bumps the sequence number, which switches readers over to it. A
+ * reader copies the current value and retries if the sequence number
+ * changed while it was copying.
+ *
+ * Two copies are kept, rather than the usual one, because the cRIO has a
+ * single core. A high priority reader that spun waiting for a preempted
+ * writer to finish would never let the writer run. With two copies the
+ * writer never touches the copy readers are using, so a reader only has
+ * to retry if the writer published twice during its copy, which cannot
+ * happen when the reader has the higher priority.
+ *
+ * There must only be a single writer task. \c T must be copyable with
+ * plain assignment.
+ *
+ * @version 1.0
+ */
+template <typename T>
+class SeqLock
+{
+public:
+	//! Creates a seqlock holding a default constructed value
+	inline SeqLock () :
+		m_sequence (0)
+	{
+	}
+
+	//! Creates a seqlock holding a copy of value
+	inline explicit SeqLock (const T& value) :
+		m_sequence (0)
+	{
+		m_values[0] = value;
+	}
+
+	//! Publishes a new value, called from the single writer task
+	inline void Write (const T& value)
+	{
+		const unsigned next = m_sequence + 1;
+		m_values[next & 1] = value;
+		MemoryBarrier();
+		m_sequence = next;
+	}
+
+	//! Returns a consistent copy of the latest published value
+	inline T Read () const
+	{
+		T value;
+		unsigned sequence;
+		do
+		{
+			sequence = m_sequence;
+			MemoryBarrier();
+			value = m_values[sequence & 1];
+			MemoryBarrier();
+		}
+		while (sequence != m_sequence);
+		return value;
+	}
+
+	//! Returns the number of values published so far
+	inline unsigned GetSequence () const
+	{
+		return m_sequence;
+	}
+
+private:
+	//! Incremented each time a value is published
+	volatile unsigned m_sequence;
+	//! The latest value is m_values[m_sequence & 1]
+	T m_values[2];
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "TargetDetector.h"
+
+/**
+ * @brief Creates a detector. The working memory is large, so allocate the
+ * detector with new or as a member of a class that is.
+ */
+TargetDetector::TargetDetector() :
+	m_runCount(0)
+{
+}
+
+/**
+ * @brief Finds the blobs in an HSL image.
+ * @param pixels The top left pixel of the image.
+ * @param width The width of the image, at most kCameraImageWidth.
+ * @param height The height of the image, at most kCameraImageHeight.
+ * @param pixelsPerLine The distance in pixels from one row to the next.
+ * @param report Filled in with the blobs found, largest first. The frame
+ * number and time are left for the caller.
+ */
+void TargetDetector::Detect(const HSLValue* pixels, int width, int height, int pixelsPerLine, TargetReport& report)
+{
+	report.m_blobCount = 0;
+	report.m_overflow = false;
+	m_runCount = 0;
+	if (width > kCameraImageWidth || height > kCameraImageHeight)
+	{
+		report.m_overflow = true;
+		return;
+	}
+
+	int previousBegin = 0;
+	for (int row = 0; row < height; ++row)
+	{
+		Threshold(pixels + row * pixelsPerLine, width, m_mask[row]);
+		const int currentBegin = m_runCount;
+		if (!FindRuns(m_mask[row], width, row))
+		{
+			report.m_overflow = true;
+			JoinRuns(previousBegin, currentBegin, currentBegin, m_runCount);
+			break;
+		}
+		JoinRuns(previousBegin, currentBegin, currentBegin, m_runCount);
+		previousBegin = currentBegin;
+	}
+
+	SumBlobs(report);
+}
+
+/**
+ * @brief Returns 1 if a pixel value is at most max. A max of 255 passes
+ * every value, so the test is left out of the threshold by the compiler.
+ */
+static inline UINT32 AtMost(UINT8 value, int max)
+{
+	return (max >= 255) | (value <= max);
+}
+
+/**
+ * @brief Thresholds a row of pixels into a row of the mask. The pixel
+ * tests are combined without branches so that the loop runs at the same
+ * speed whatever the image.
+ */
+void TargetDetector::Threshold(const HSLValue* pixels, int width, UINT32* mask) const
+{
+	for (int word = 0; word < kMaskWords; ++word)
+	{
+		const int first = word * 32;
+		const int count = (width - first < 32) ? width - first : 32;
+		UINT32 bits = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const HSLValue& pixel = pixels[first + i];
+			const UINT32 inside =
+				(pixel.H >= kTargetHueMin) & AtMost(pixel.H, kTargetHueMax) &
+				(pixel.S >= kTargetSaturationMin) & AtMost(pixel.S, kTargetSaturationMax) &
+				(pixel.L >= kTargetLuminanceMin) & AtMost(pixel.L, kTargetLuminanceMax);
+			bits |= inside << (31 - i);
+		}
+		mask[word] = bits;
+	}
+}
+
+/**
+ * @brief Adds the runs in a row of the mask to m_runs, returning false if
+ * they did not all fit.
+ */
+bool TargetDetector::FindRuns(const UINT32* mask, int width, int row)
+{
+	bool inRun = false;
+	int start = 0;
+	for (int word = 0; word < kMaskWords; ++word)
+	{
+		const UINT32 bits = mask[word];
+		const int base = word * 32;
+		int position = 0;
+		while (position < 32)
+		{
+			if (!inRun)
+			{
+				// Skip to the next set pixel
+				const UINT32 rest = bits << position;
+				if (rest == 0)
+				{
+					break;
+				}
+				position += __builtin_clz(rest);
+				start = base + position;
+				inRun = true;
+			}
+			else
+			{
+				// Skip to the next clear pixel, the run carries on into
+				// the next word if there is none
+				const UINT32 rest = ~bits << position;
+				if (rest == 0)
+				{
+					break;
+				}
+				position += __builtin_clz(rest);
+				if (!AddRun(start, base + position - 1, row))
+				{
+					return false;
+				}
+				inRun = false;
+			}
+		}
+	}
+	// The mask is clear past the width, so a run is only still open here
+	// when the width is a multiple of 32
+	return !inRun || AddRun(start, width - 1, row);
+}
+
+/**
+ * @brief Adds a run as a blob of its own, returning false if there is no
+ * room for it.
+ */
+bool TargetDetector::AddRun(int start, int end, int row)
+{
+	if (m_runCount >= kTargetMaxRuns)
+	{
+		return false;
+	}
+	Run& run = m_runs[m_runCount];
+	run.m_start = start;
+	run.m_end = end;
+	run.m_row = row;
+	m_parents[m_runCount] = m_runCount;
+	++m_runCount;
+	return true;
+}
+
+/**
+ * @brief Joins each run of the current row to the runs of the previous row
+ * it touches. Both rows are in left to right order, so one pass over each
+ * is enough.
+ */
+void TargetDetector::JoinRuns(int previousBegin, int previousEnd, int currentBegin, int currentEnd)
+{
+	int previous = previousBegin;
+	for (int current = currentBegin; current < currentEnd; ++current)
+	{
+		const Run& run = m_runs[current];
+		// Runs that end before this one starts cannot touch any later run
+		while (previous < previousEnd && m_runs[previous].m_end + 1 < run.m_start)
+		{
+			++previous;
+		}
+		for (int above = previous; above < previousEnd && m_runs[above].m_start <= run.m_end + 1; ++above)
+		{
+			const int root = FindRoot(current);
+			const int aboveRoot = FindRoot(above);
+			// Keep the earlier run as the root
+			if (root < aboveRoot)
+			{
+				m_parents[aboveRoot] = root;
+			}
+			else if (aboveRoot < root)
+			{
+				m_parents[root] = aboveRoot;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Returns the root run of a run's blob, halving the path to it.
+ */
+int TargetDetector::FindRoot(int run)
+{
+	while (m_parents[run] != run)
+	{
+		m_parents[run] = m_parents[m_parents[run]];
+		run = m_parents[run];
+	}
+	return run;
+}
+
+/**
+ * @brief Sums the moments of each blob from its runs, and reports the
+ * largest blobs of at least kTargetMinArea pixels.
+ */
+void TargetDetector::SumBlobs(TargetReport& report)
+{
+	int blobCount = 0;
+	for (int i = 0; i < m_runCount; ++i)
+	{
+		const Run& run = m_runs[i];
+		const int root = FindRoot(i);
+		// A root always comes before the other runs of its blob
+		if (root == i)
+		{
+			m_blobIndex[i] = blobCount;
+			const BlobSums empty = {0, 0, 0, run.m_start, run.m_row, run.m_end, run.m_row};
+			m_sums[blobCount] = empty;
+			++blobCount;
+		}
+		BlobSums& sums = m_sums[m_blobIndex[root]];
+		const UINT32 length = run.m_end - run.m_start + 1;
+		sums.m_area += length;
+		sums.m_sumX2 += length * (run.m_start + run.m_end);
+		sums.m_sumY += length * run.m_row;
+		if (run.m_start < sums.m_left)
+		{
+			sums.m_left = run.m_start;
+		}
+		if (run.m_end > sums.m_right)
+		{
+			sums.m_right = run.m_end;
+		}
+		sums.m_bottom = run.m_row;
+	}
+
+	// Keep the largest blobs, in order, by insertion
+	for (int i = 0; i < blobCount; ++i)
+	{
+		const BlobSums& sums = m_sums[i];
+		if (sums.m_area < static_cast<UINT32>(kTargetMinArea))
+		{
+			continue;
+		}
+		int slot = report.m_blobCount;
+		while (slot > 0 && report.m_blobs[slot - 1].m_area < static_cast<int>(sums.m_area))
+		{
+			if (slot < kTargetMaxBlobs)
+			{
+				report.m_blobs[slot] = report.m_blobs[slot - 1];
+			}
+			--slot;
+		}
+		if (slot >= kTargetMaxBlobs)
+		{
+			continue;
+		}
+		TargetBlob& blob = report.m_blobs[slot];
+		blob.m_area = sums.m_area;
+		blob.m_centerX = sums.m_sumX2 * 0.5 / sums.m_area;
+		blob.m_centerY = static_cast<float>(sums.m_sumY) / sums.m_area;
+		blob.m_left = sums.m_left;
+		blob.m_top = sums.m_top;
+		blob.m_right = sums.m_right;
+		blob.m_bottom = sums.m_bottom;
+		blob.m_aspectRatio = static_cast<float>(sums.m_right - sums.m_left + 1) / (sums.m_bottom - sums.m_top + 1);
+		if (report.m_blobCount < kTargetMaxBlobs)
+		{
+			++report.m_blobCount;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#ifndef TARGETDETECTOR_H
+#define TARGETDETECTOR_H
+
+#include "WPILib.h"
+#include "nivision.h"
+#include "../Robotmap.h"
+
+/**
+ * @brief A blob of pixels found by the TargetDetector, in image coordinates
+ * with x to the right and y down from the top left pixel.
+ */
+struct TargetBlob
+{
+	int m_area;				//!< The number of pixels
+	float m_centerX;		//!< The centroid
+	float m_centerY;
+	INT16 m_left;			//!< The bounding box, inclusive
+	INT16 m_top;
+	INT16 m_right;
+	INT16 m_bottom;
+	float m_aspectRatio;	//!< The width of the bounding box over its height
+};
+
+/**
+ * @brief The targets found in one camera frame, largest first.
+ */
+struct TargetReport
+{
+	UINT32 m_frame;							//!< The number of the frame, from 1
+	UINT32 m_time;							//!< The FPGA time the frame was taken for processing
+	int m_blobCount;						//!< The number of entries used in m_blobs
+	bool m_overflow;						//!< Set if the frame had more than kTargetMaxRuns runs
+	TargetBlob m_blobs[kTargetMaxBlobs];	//!< The largest blobs of at least kTargetMinArea pixels
+};
+
+/**
+ * @brief Finds the vision targets in a camera image.
+ *
+ * Each row is thresholded against the kTarget HSL ranges into a packed row
+ * of the binary mask, 32 pixels a word. The row is then split into runs
+ * of set pixels by counting leading zeros a word at a time, and each run
+ * is joined to the runs it touches, diagonals included, in the row above
+ * with a union-find over the runs. Once every row is done the area,
+ * centroid and bounding box of each blob are summed from its runs, so
+ * each pixel is only looked at once and everything after the threshold
+ * works on runs rather than pixels.
+ *
+ * All of the working memory is allocated with the detector, so create it
+ * once, not per frame. A frame with more than kTargetMaxRuns runs, which
+ * means the thresholds are far too loose, is only labelled up to the run
+ * that did not fit and is marked as overflowed.
+ */
+class TargetDetector
+{
+public:
+	TargetDetector();
+	void Detect(const HSLValue* pixels, int width, int height, int pixelsPerLine, TargetReport& report);
+
+private:
+	//! The words in each row of the mask
+	static const int kMaskWords = (kCameraImageWidth + 31) / 32;
+
+	/**
+	 * @brief A horizontal run of set pixels in the mask.
+	 */
+	struct Run
+	{
+		INT16 m_start;	//!< The first pixel of the run
+		INT16 m_end;	//!< The last pixel of the run
+		INT16 m_row;
+	};
+
+	/**
+	 * @brief The sums a blob's moments are calculated from.
+	 */
+	struct BlobSums
+	{
+		UINT32 m_area;
+		UINT32 m_sumX2;		//!< Twice the sum of the x coordinates
+		UINT32 m_sumY;
+		INT16 m_left;
+		INT16 m_top;
+		INT16 m_right;
+		INT16 m_bottom;
+	};
+
+	void Threshold(const HSLValue* pixels, int width, UINT32* mask) const;
+	bool FindRuns(const UINT32* mask, int width, int row);
+	bool AddRun(int start, int end, int row);
+	void JoinRuns(int previousBegin, int previousEnd, int currentBegin, int currentEnd);
+	int FindRoot(int run);
+	void SumBlobs(TargetReport& report);
+
+	//! The packed binary mask of the last frame, bit 31 of the first word is pixel 0
+	UINT32 m_mask[kCameraImageHeight][kMaskWords];
+	//! The runs of the frame, in row order then left to right
+	Run m_runs[kTargetMaxRuns];
+	//! The union-find parent of each run, a root is its own parent
+	UINT16 m_parents[kTargetMaxRuns];
+	//! The index in m_sums of each root run's blob
+	UINT16 m_blobIndex[kTargetMaxRuns];
+	//! The sums for each blob
+	BlobSums m_sums[kTargetMaxRuns];
+	//! The number of runs in m_runs
+	int m_runCount;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TELEMETRYFORMAT_H
+#define TELEMETRYFORMAT_H
+
+/**
+ * @brief The layout of the columnar telemetry file written by
+ * TelemetryRecorder. This header is shared with the host side decoder in
+ * Tools/TelemetryDecoder.cpp, so it must not include any WPILib or VxWorks
+ * headers.
+ *
+ * A telemetry file starts with a TelemetryHeader, followed by
+ * m_channelCount TelemetryChannelInfo entries describing the channels.
+ * The rest of the file is a series of blocks. Each block starts with its
+ * row count, followed by the timestamp column and then one column per
+ * channel, each holding row count 4 byte values. Values are floats or
+ * signed integers depending on the channel type.
+ *
+ * Everything is written in the byte order of the robot. The decoder uses
+ * m_byteOrder in the header to detect when it needs to swap bytes.
+ */
+
+//! "NFTM", the first four bytes of every telemetry file
+static const unsigned int kTelemetryMagic = 0x4E46544D;
+//! The version of the telemetry file format
+static const unsigned short kTelemetryVersion = 1;
+//! Written in the native byte order to allow the decoder to detect swapping
+static const unsigned int kTelemetryByteOrder = 0x01020304;
+//! The maximum length of a channel name, including the terminating null
+static const int kTelemetryNameLength = 24;
+//! The maximum length of a channel's units, including the terminating null
+static const int kTelemetryUnitsLength = 12;
+
+/**
+ * @brief The types of value a telemetry channel can hold.
+ */
+enum TelemetryType
+{
+	kTelemetryFloat = 1,
+	kTelemetryInteger = 2,
+};
+
+/**
+ * @brief The header at the start of every telemetry file.
+ */
+struct TelemetryHeader
+{
+	unsigned int m_magic;			//!< Always kTelemetryMagic
+	unsigned int m_byteOrder;		//!< Always kTelemetryByteOrder in the writer's byte order
+	unsigned short m_version;		//!< The format version, kTelemetryVersion
+	unsigned short m_channelCount;	//!< The number of channels
+};
+
+/**
+ * @brief Describes a single telemetry channel.
+ */
+struct TelemetryChannelInfo
+{
+	char m_name[kTelemetryNameLength];		//!< The name of the channel
+	char m_units[kTelemetryUnitsLength];	//!< The units of the channel's values
+	unsigned int m_type;					//!< One of TelemetryType
+};
+
+/**
+ * @brief A single telemetry value. The channel type says which member
+ * is valid.
+ */
+union TelemetryValue
+{
+	float m_float;
+	int m_integer;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include "TelemetryRecorder.h"
+#include "MemoryBarrier.h"
+#include <string.h>
+
+/**
+ * @brief Creates the telemetry recorder.
+ * @param writeSemaphore The semaphore to give whenever a block is ready
+ * to be written, which should wake the task that calls WriteBlocks.
+ */
+TelemetryRecorder::TelemetryRecorder(SEM_ID writeSemaphore) :
+	m_channelCount(0),
+	m_currentBlock(0),
+	m_currentRow(0),
+	m_writeBlock(0),
+	m_started(false),
+	m_headerWritten(false),
+	m_droppedRows(0),
+	m_file(NULL),
+	m_fileSize(0),
+	m_writeSemaphore(writeSemaphore)
+{
+	memset(m_channels, 0, sizeof (m_channels));
+	for (int i = 0; i < kTelemetryBlocks; ++i)
+	{
+		m_blocks[i].m_full = false;
+		m_blocks[i].m_rowCount = 0;
+	}
+}
+
+/**
+ * @brief Registers a new channel. This must be done before the first row
+ * is committed.
+ * @param name The name of the channel, which is truncated if it is longer
+ * than kTelemetryNameLength - 1 characters.
+ * @param type The type of the values sampled for the channel.
+ * @param units The units of the channel values.
+ * @return The channel number to pass to Sample, or -1 if the channel could
+ * not be registered. Sampling channel -1 does nothing.
+ */
+int TelemetryRecorder::RegisterChannel(const char* name, TelemetryType type, const char* units)
+{
+	if (m_started || m_channelCount >= kTelemetryMaxChannels)
+	{
+		return -1;
+	}
+
+	TelemetryChannelInfo& info = m_channels[m_channelCount];
+	strncpy(info.m_name, name, kTelemetryNameLength - 1);
+	strncpy(info.m_units, units, kTelemetryUnitsLength - 1);
+	info.m_type = type;
+
+	m_blocks[m_currentBlock].m_values[m_channelCount][m_currentRow].m_integer = 0;
+	return m_channelCount++;
+}
+
+/**
+ * @brief Completes the current row, timestamping it. The sampled values
+ * are carried forward into the next row.
+ * @param time The FPGA time of the row.
+ */
+void TelemetryRecorder::CommitRow(UINT32 time)
+{
+	if (m_channelCount == 0)
+	{
+		return;
+	}
+	m_started = true;
+
+	Block& block = m_blocks[m_currentBlock];
+	block.m_times[m_currentRow] = time;
+
+	const int lastRow = m_currentRow;
+	Block* next = &block;
+	if (m_currentRow + 1 < kTelemetryBlockRows)
+	{
+		++m_currentRow;
+	}
+	else
+	{
+		const int nextBlock = (m_currentBlock + 1) % kTelemetryBlocks;
+		if (m_blocks[nextBlock].m_full)
+		{
+			// The writer has not kept up, so rather than wait we throw
+			// away this block and start filling it again
+			m_droppedRows += kTelemetryBlockRows;
+		}
+		else
+		{
+			block.m_rowCount = kTelemetryBlockRows;
+			MemoryBarrier();
+			block.m_full = true;
+			semGive(m_writeSemaphore);
+
+			m_currentBlock = nextBlock;
+			next = &m_blocks[nextBlock];
+		}
+		m_currentRow = 0;
+	}
+
+	for (int channel = 0; channel < m_channelCount; ++channel)
+	{
+		next->m_values[channel][m_currentRow] = block.m_values[channel][lastRow];
+	}
+}
+
+/**
+ * @brief Sets the file the telemetry is written to. The file header is
+ * written before the next block.
+ * @param file The file to write to, or NULL to discard the telemetry.
+ */
+void TelemetryRecorder::SetFile(FILE* file)
+{
+	m_file = file;
+	m_fileSize = 0;
+	m_headerWritten = false;
+}
+
+/**
+ * @brief Writes out all of the full blocks. This is called by the writer
+ * task when the write semaphore is given.
+ */
+void TelemetryRecorder::WriteBlocks()
+{
+	bool wrote = false;
+	while (m_blocks[m_writeBlock].m_full)
+	{
+		Block& block = m_blocks[m_writeBlock];
+		if (m_file != NULL)
+		{
+			this->WriteBlock(block);
+			wrote = true;
+		}
+
+		// Hand the block back to the control loop
+		MemoryBarrier();
+		block.m_full = false;
+		m_writeBlock = (m_writeBlock + 1) % kTelemetryBlocks;
+	}
+
+	if (wrote)
+	{
+		fflush(m_file);
+	}
+}
+
+/**
+ * @brief Writes out all of the full blocks and then the rows committed
+ * to the current block so far, which would otherwise be lost. Only call
+ * this once no more rows will be committed, for example at shutdown.
+ */
+void TelemetryRecorder::Flush()
+{
+	this->WriteBlocks();
+	if (m_file == NULL || m_currentRow == 0)
+	{
+		return;
+	}
+	Block& block = m_blocks[m_currentBlock];
+	block.m_rowCount = m_currentRow;
+	this->WriteBlock(block);
+	fflush(m_file);
+	m_currentRow = 0;
+}
+
+/**
+ * @brief Writes a block to the file, starting the file with the header
+ * if it has not been written yet.
+ */
+void TelemetryRecorder::WriteBlock(const Block& block)
+{
+	if (m_headerWritten == false)
+	{
+		this->WriteHeader();
+	}
+	fwrite(&block.m_rowCount, sizeof (block.m_rowCount), 1, m_file);
+	fwrite(block.m_times, sizeof (block.m_times[0]), block.m_rowCount, m_file);
+	for (int channel = 0; channel < m_channelCount; ++channel)
+	{
+		fwrite(block.m_values[channel], sizeof (TelemetryValue), block.m_rowCount, m_file);
+	}
+	m_fileSize += sizeof (block.m_rowCount) +
+		block.m_rowCount * (sizeof (block.m_times[0]) + m_channelCount * sizeof (TelemetryValue));
+}
+
+/**
+ * @brief Writes the file header and the channel descriptions.
+ */
+void TelemetryRecorder::WriteHeader()
+{
+	TelemetryHeader header;
+	header.m_magic = kTelemetryMagic;
+	header.m_byteOrder = kTelemetryByteOrder;
+	header.m_version = kTelemetryVersion;
+	header.m_channelCount = m_channelCount;
+	fwrite(&header, sizeof (header), 1, m_file);
+	fwrite(m_channels, sizeof (m_channels[0]), m_channelCount, m_file);
+	m_fileSize += sizeof (header) + m_channelCount * sizeof (m_channels[0]);
+	m_headerWritten = true;
+}
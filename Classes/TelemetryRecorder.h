@@ -0,0 +1,111 @@
+#ifndef TELEMETRYRECORDER_H
+#define TELEMETRYRECORDER_H
+
+#include <WPILib.h>
+#include <stdio.h>
+#include "../Robotmap.h"
+#include "TelemetryFormat.h"
+
+/**
+ * @brief Records numeric signals once per cycle into a columnar in-memory
+ * buffer which is written to a file in blocks by a background task.
+ *
+ * Channels are registered once at initialization, and then each cycle the
+ * control loop samples the channels it has new values for and commits the
+ * row. A channel that is not sampled in a cycle keeps its previous value.
+ * Sampling is a single store, and committing a row only does work when a
+ * block fills up, at which point the block is handed to the writer and the
+ * next free block is used. If the writer has fallen behind and there is no
+ * free block, the rows of the block being filled, the newest ones, are
+ * counted as dropped and the block is filled again. The full blocks are
+ * left alone, as the writer may be writing them, so a stalled writer
+ * loses the newest rows rather than the oldest.
+ *
+ * Channels must all be registered before the first row is committed, and
+ * sampling and committing must be done from a single task. The file format
+ * is described in TelemetryFormat.h, see Tools/TelemetryDecoder.cpp for
+ * converting it to CSV.
+ */
+class TelemetryRecorder
+{
+public:
+	TelemetryRecorder(SEM_ID writeSemaphore);
+
+	int RegisterChannel(const char* name, TelemetryType type, const char* units);
+	void CommitRow(UINT32 time);
+	void WriteBlocks();
+	void Flush();
+	void SetFile(FILE* file);
+
+	/**
+	 * @brief Returns the number of bytes written to the current file.
+	 */
+	inline UINT32 GetFileSize() const
+	{
+		return m_fileSize;
+	}
+
+	/**
+	 * @brief Returns the most bytes a single call to WriteBlocks can write,
+	 * including the file header.
+	 */
+	static inline UINT32 GetMaxWriteSize()
+	{
+		return sizeof (TelemetryHeader) + kTelemetryMaxChannels * sizeof (TelemetryChannelInfo) +
+			kTelemetryBlocks * (sizeof (UINT32) + kTelemetryBlockRows * (sizeof (UINT32) + kTelemetryMaxChannels * sizeof (TelemetryValue)));
+	}
+
+	/**
+	 * @brief Samples a floating point channel for the current row.
+	 */
+	inline void Sample(int channel, float value)
+	{
+		if (channel >= 0) m_blocks[m_currentBlock].m_values[channel][m_currentRow].m_float = value;
+	}
+
+	/**
+	 * @brief Samples an integer channel for the current row.
+	 */
+	inline void Sample(int channel, INT32 value)
+	{
+		if (channel >= 0) m_blocks[m_currentBlock].m_values[channel][m_currentRow].m_integer = value;
+	}
+
+	/**
+	 * @brief Returns the number of rows lost because the writer fell behind.
+	 */
+	inline UINT32 GetDroppedRowCount() const
+	{
+		return m_droppedRows;
+	}
+
+private:
+	/**
+	 * @brief A block of rows stored a column at a time.
+	 */
+	struct Block
+	{
+		volatile bool m_full;	//!< Set once the block is ready to be written
+		UINT32 m_rowCount;		//!< The number of rows in the block
+		UINT32 m_times[kTelemetryBlockRows];	//!< The FPGA time of each row
+		TelemetryValue m_values[kTelemetryMaxChannels][kTelemetryBlockRows];	//!< One column per channel
+	};
+
+	void WriteHeader();
+	void WriteBlock(const Block& block);
+
+	TelemetryChannelInfo m_channels[kTelemetryMaxChannels];
+	int m_channelCount;
+	Block m_blocks[kTelemetryBlocks];
+	int m_currentBlock;		//!< The block rows are being added to
+	int m_currentRow;		//!< The row in the current block being sampled
+	int m_writeBlock;		//!< The next block for the writer to write
+	bool m_started;			//!< Set once the first row has been committed
+	bool m_headerWritten;	//!< Set once the file header has been written
+	UINT32 m_droppedRows;
+	FILE* m_file;
+	UINT32 m_fileSize;		//!< The bytes written to m_file
+	const SEM_ID m_writeSemaphore;
+};
+
+#endif
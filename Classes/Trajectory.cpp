@@ -0,0 +1,169 @@
+#include "Trajectory.h"
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * @brief Creates an empty trajectory.
+ */
+Trajectory::Trajectory() :
+	m_count(0)
+{
+}
+
+/**
+ * @brief Loads a trajectory written by Tools/TrajectoryGenerator.cpp. The
+ * whole file is read in one go, straight into the table of points.
+ * @param filename The trajectory file.
+ * @return false if the file could not be read or is not a valid trajectory
+ * file, in which case the trajectory is empty.
+ */
+bool Trajectory::Load(const char* filename)
+{
+	m_count = 0;
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	const size_t length = fread(&m_file, 1, sizeof (m_file), file);
+	fclose(file);
+
+	const TrajectoryFileHeader& header = m_file.m_header;
+	if (length < sizeof (header) ||
+		header.m_magic != kTrajectoryMagic ||
+		header.m_byteOrder != kTrajectoryByteOrder ||
+		header.m_version != kTrajectoryVersion ||
+		header.m_pointSize != sizeof (TrajectoryPoint) ||
+		header.m_pointCount < 1 ||
+		header.m_pointCount > static_cast<unsigned int>(kTrajectoryMaxPoints) ||
+		length != sizeof (header) + header.m_pointCount * sizeof (TrajectoryPoint) ||
+		header.m_checksum != TrajectoryChecksum(m_file.m_points, header.m_pointCount * sizeof (TrajectoryPoint)))
+	{
+		return false;
+	}
+	m_count = header.m_pointCount;
+	return true;
+}
+
+/**
+ * @brief Builds the trajectory through a list of waypoints.
+ * @param waypoints The waypoints, starting where the robot starts.
+ * @param count The number of waypoints.
+ * @param maxVelocity The fastest to drive, in inches per second.
+ * @param maxAcceleration The fastest to speed up or slow down, in inches
+ * per second squared.
+ * @param spacing The distance between the trajectory points in inches.
+ * @return false if the path is too long for kTrajectoryMaxPoints points, in
+ * which case it is cut short.
+ */
+bool Trajectory::Build(
+	const Waypoint* waypoints,
+	int count,
+	float maxVelocity,
+	float maxAcceleration,
+	float spacing)
+{
+	m_count = 0;
+	if (count < 1)
+	{
+		return true;
+	}
+
+	// Walk along the straight lines between the waypoints, placing a point
+	// every spacing inches
+	bool complete = true;
+	int segment = 0;
+	float segmentStart = 0;		// The distance along the path of waypoint[segment]
+	float segmentLength = 0;
+	float heading = 0;
+	float distance = 0;
+	while (true)
+	{
+		// Find the segment the next point is on
+		while (segment + 1 < count)
+		{
+			const float dx = waypoints[segment + 1].m_x - waypoints[segment].m_x;
+			const float dy = waypoints[segment + 1].m_y - waypoints[segment].m_y;
+			segmentLength = sqrt(dx * dx + dy * dy);
+			if (segmentLength > 0)
+			{
+				heading = atan2(dy, dx);
+			}
+			if (distance < segmentStart + segmentLength)
+			{
+				break;
+			}
+			segmentStart += segmentLength;
+			++segment;
+		}
+		if (segment + 1 >= count)
+		{
+			break;
+		}
+		if (m_count >= kTrajectoryMaxPoints - 1)
+		{
+			complete = false;
+			break;
+		}
+		const float fraction = (distance - segmentStart) / segmentLength;
+		TrajectoryPoint& point = m_file.m_points[m_count++];
+		point.m_x = waypoints[segment].m_x + (waypoints[segment + 1].m_x - waypoints[segment].m_x) * fraction;
+		point.m_y = waypoints[segment].m_y + (waypoints[segment + 1].m_y - waypoints[segment].m_y) * fraction;
+		point.m_heading = heading;
+		point.m_distance = distance;
+		distance += spacing;
+	}
+
+	// The path always ends exactly on the last waypoint, unless it was cut
+	// short in which case it ends on the last point that fitted
+	TrajectoryPoint& end = m_file.m_points[m_count];
+	if (complete)
+	{
+		end.m_x = waypoints[count - 1].m_x;
+		end.m_y = waypoints[count - 1].m_y;
+		end.m_heading = heading;
+		end.m_distance = segmentStart;
+		++m_count;
+	}
+
+	ProfileVelocity(maxVelocity, maxAcceleration);
+	return complete;
+}
+
+/**
+ * @brief Sets the speed at each point, limited by the maximum velocity,
+ * speeding up from a stop at the start and slowing to a stop at the end.
+ */
+void Trajectory::ProfileVelocity(float maxVelocity, float maxAcceleration)
+{
+	// Speed up from the start, v^2 = u^2 + 2as
+	float velocity = 0;
+	m_file.m_points[0].m_velocity = 0;
+	for (int i = 1; i < m_count; ++i)
+	{
+		const float step = m_file.m_points[i].m_distance - m_file.m_points[i - 1].m_distance;
+		velocity = sqrt(velocity * velocity + 2 * maxAcceleration * step);
+		if (velocity > maxVelocity)
+		{
+			velocity = maxVelocity;
+		}
+		m_file.m_points[i].m_velocity = velocity;
+	}
+
+	// Slow down to the end
+	velocity = 0;
+	m_file.m_points[m_count - 1].m_velocity = 0;
+	for (int i = m_count - 2; i >= 0; --i)
+	{
+		const float step = m_file.m_points[i + 1].m_distance - m_file.m_points[i].m_distance;
+		velocity = sqrt(velocity * velocity + 2 * maxAcceleration * step);
+		if (velocity < m_file.m_points[i].m_velocity)
+		{
+			m_file.m_points[i].m_velocity = velocity;
+		}
+		else
+		{
+			velocity = m_file.m_points[i].m_velocity;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "../Robotmap.h"
+#include "TrajectoryFormat.h"
+
+/**
+ * @brief A point the robot should drive through, in inches on the field.
+ */
+struct Waypoint
+{
+	float m_x;
+	float m_y;
+};
+
+/**
+ * @brief A path for the robot to follow, as a table of points each with
+ * the speed to drive at.
+ *
+ * The trajectory is either loaded from a file made by
+ * Tools/TrajectoryGenerator.cpp, which has a point every 20 ms along a
+ * smooth spline, or built on the robot from a list of waypoints joined
+ * with straight lines, which has evenly spaced points. Either way it is
+ * made once and stored in a fixed size table. The speeds ramp up and down
+ * within the maximum acceleration and the path ends stopped, so following
+ * it only has to look points up.
+ */
+class Trajectory
+{
+public:
+	Trajectory();
+	bool Load(const char* filename);
+	bool Build(const Waypoint* waypoints, int count,
+		float maxVelocity, float maxAcceleration, float spacing = kTrajectorySpacing);
+
+	/**
+	 * @brief Returns the number of points on the trajectory.
+	 */
+	inline int GetCount() const
+	{
+		return m_count;
+	}
+
+	/**
+	 * @brief Returns a point, clamped to the ends of the trajectory.
+	 */
+	inline const TrajectoryPoint& GetPoint(int index) const
+	{
+		if (index < 0)
+		{
+			index = 0;
+		}
+		else if (index >= m_count)
+		{
+			index = m_count - 1;
+		}
+		return m_file.m_points[index];
+	}
+
+private:
+	void ProfileVelocity(float maxVelocity, float maxAcceleration);
+
+	/**
+	 * @brief A trajectory file as it is laid out on disk, so that it can be
+	 * loaded with a single read.
+	 */
+	struct TrajectoryFile
+	{
+		TrajectoryFileHeader m_header;
+		TrajectoryPoint m_points[kTrajectoryMaxPoints];
+	};
+
+	TrajectoryFile m_file;	//!< The points on the path, after the file header
+	int m_count;			//!< The number of points
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TRAJECTORYFORMAT_H
+#define TRAJECTORYFORMAT_H
+
+/**
+ * @brief The layout of the trajectory files written by
+ * Tools/TrajectoryGenerator.cpp and loaded by Trajectory::Load. This header
+ * is shared with the host side generator, so it must not include any
+ * WPILib or VxWorks headers.
+ *
+ * A trajectory file is a TrajectoryFileHeader followed by m_pointCount
+ * TrajectoryPoints, one every m_period seconds. The file is written in the
+ * byte order of the robot, so that the robot can read it straight into
+ * memory and use it without converting anything. m_byteOrder in the header
+ * lets the robot check that the generator got this right.
+ *
+ * m_checksum is the TrajectoryChecksum of the points.
+ */
+
+//! "NFTJ", the first four bytes of every trajectory file
+static const unsigned int kTrajectoryMagic = 0x4E46544A;
+//! The version of the trajectory file format
+static const unsigned short kTrajectoryVersion = 1;
+//! Written in the robot's byte order
+static const unsigned int kTrajectoryByteOrder = 0x01020304;
+
+/**
+ * @brief The header at the start of every trajectory file.
+ */
+struct TrajectoryFileHeader
+{
+	unsigned int m_magic;		//!< Always kTrajectoryMagic
+	unsigned int m_byteOrder;	//!< Always kTrajectoryByteOrder in the robot's byte order
+	unsigned short m_version;	//!< The format version, kTrajectoryVersion
+	unsigned short m_pointSize;	//!< sizeof (TrajectoryPoint)
+	unsigned int m_pointCount;	//!< The number of points that follow the header
+	float m_period;				//!< The time between points in seconds
+	unsigned int m_checksum;	//!< The TrajectoryChecksum of the points
+};
+
+/**
+ * @brief A point on a trajectory.
+ */
+struct TrajectoryPoint
+{
+	float m_x;			//!< Inches forward of the start of the path
+	float m_y;			//!< Inches to the left of the start of the path
+	float m_heading;	//!< The direction of the path, radians anticlockwise
+	float m_velocity;	//!< The speed to drive at, inches per second
+	float m_distance;	//!< The distance along the path, inches
+};
+
+/**
+ * @brief Returns the Adler-32 checksum of length bytes.
+ */
+inline unsigned int TrajectoryChecksum(const void* data, unsigned int length)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*> (data);
+	unsigned int a = 1;
+	unsigned int b = 0;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		a = (a + bytes[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TRIPLE_BUFFER_H_
+#define TRIPLE_BUFFER_H_
+
+#include <intLib.h>
+#include "MemoryBarrier.h"
+
+/** @brief Three preallocated buffers for handing large items, such as
+ * images, from one task to another without copying them and without
+ * either task ever waiting for the other.
+ *
+ * The writer fills in the back buffer in place and then publishes it,
+ * which swaps it with the middle buffer. The reader calls \c Update,
+ * which swaps the front buffer with the middle buffer if a newer one has
+ * been published, and then uses the front buffer for as long as it likes.
+ * The writer always has a buffer to fill and the reader always has the
+ * newest complete buffer; buffers the reader never got to are reused.
+ *
+ * There must only be a single writer task and a single reader task. The
+ * swaps lock interrupts for a few instructions, which is enough to make
+ * them atomic on the single core cRIO.
+ *
+ * @version 1.0
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+	//! Creates the three buffers, default constructed
+	inline TripleBuffer () :
+		m_back (0), m_middle (1), m_front (2)
+	{
+	}
+
+	//! Returns the buffer for the writer to fill in
+	inline T& GetBack ()
+	{
+		return m_buffers[m_back];
+	}
+
+	//! Makes the back buffer the newest buffer for the reader, and gives
+	//! the writer a new back buffer
+	inline void Publish ()
+	{
+		MemoryBarrier();
+		const int lockKey = intLock();
+		const unsigned middle = m_middle;
+		m_middle = m_back | kFresh;
+		intUnlock(lockKey);
+		m_back = middle & kIndexMask;
+	}
+
+	//! Makes the newest published buffer the front buffer, returning false
+	//! if nothing has been published since the last call
+	inline bool Update ()
+	{
+		if ((m_middle & kFresh) == 0)
+		{
+			return false;
+		}
+		const int lockKey = intLock();
+		const unsigned middle = m_middle;
+		m_middle = m_front;
+		intUnlock(lockKey);
+		m_front = middle & kIndexMask;
+		MemoryBarrier();
+		return true;
+	}
+
+	//! Returns the buffer the reader is using
+	inline const T& GetFront () const
+	{
+		return m_buffers[m_front];
+	}
+
+private:
+	//! Set in m_middle when it holds a buffer the reader has not seen
+	static const unsigned kFresh = 4;
+	//! The bits of m_middle that hold the buffer index
+	static const unsigned kIndexMask = 3;
+
+	//! The buffer the writer is filling in, only used by the writer
+	unsigned m_back;
+	//! The newest published buffer, and kFresh if the reader has not seen it
+	volatile unsigned m_middle;
+	//! The buffer the reader is using, only used by the reader
+	unsigned m_front;
+	T m_buffers[3];
+
+	// Not copyable
+	TripleBuffer (const TripleBuffer&);
+	TripleBuffer& operator= (const TripleBuffer&);
+};
+
+#endif
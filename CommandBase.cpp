@@ -1,20 +1,34 @@
 #include "CommandBase.h"
 #include "Commands/Scheduler.h"
+#include "Classes/PeriodicScheduler.h"
 
-CommandBase::CommandBase(const char *name) : Command(name) 
+CommandBase::CommandBase(const char *name) : Command(name),
+	m_executeProfiler(name)
 {
 	
 }
 
-CommandBase::CommandBase() : Command() 
+CommandBase::CommandBase() : Command(),
+	m_executeProfiler("Command")
 {
 
 }
 
+/**
+ * @brief Runs the command's DoExecute, profiling it.
+ */
+void CommandBase::Execute()
+{
+	const LoopProfiler::Scope profile(m_executeProfiler);
+	this->DoExecute();
+}
+
 // Initialize a single static instance of all subsystems to NULL.
 OperatorInterface* CommandBase::oi = NULL;
 DriveSubsystem* CommandBase::s_Drive = NULL;
 LogSystem* CommandBase::s_Log = NULL;
+GyroSubsystem* CommandBase::s_Gyro = NULL;
+AccelerometerSubsystem* CommandBase::s_Accelerometer = NULL;
 
 /**
  * @brief This is where all of the instances of subsystems will be created. 
@@ -23,7 +37,21 @@ LogSystem* CommandBase::s_Log = NULL;
  */
 void CommandBase::init() 
 {
+	// The log is created first as every other subsystem logs while it
+	// is being created.
+	s_Log = new LogSystem(kLogPrioritySystem);
 	oi = new OperatorInterface();
 	s_Drive = new DriveSubsystem(kBSBotDrive);
-	s_Log = new LogSystem(kLogPrioritySystem);
+	// Sensors that are not fitted are left NULL, so that they neither
+	// delay RobotInit nor take time from the sensor rate group
+	if (kUseGyro)
+	{
+		s_Gyro = new GyroSubsystem();
+	}
+	if (kUseAccelerometer)
+	{
+		s_Accelerometer = new AccelerometerSubsystem();
+	}
+	// The subsystems register their periodic jobs as they are created
+	PeriodicScheduler::GetInstance()->Start();
 }
@@ -3,7 +3,10 @@
 #include "Commands/Command.h"
 #include "Subsystems/DriveSubsystem.h"
 #include "Subsystems/LogSystem.h"
+#include "Subsystems/GyroSubsystem.h"
+#include "Subsystems/AccelerometerSubsystem.h"
 #include "OperatorInterface.h"
+#include "Classes/LoopProfiler.h"
 
 
 class OperatorInterface;
@@ -12,6 +15,10 @@ class OperatorInterface;
  * @brief The base for all commands. All atomic commands should subclass CommandBase.
  * CommandBase stores creates and stores each control system. To access a
  * subsystem elsewhere in your code in the code use CommandBase.examplesubsystem.
+ *
+ * Commands implement DoExecute rather than Execute. CommandBase's Execute
+ * calls it under a LoopProfiler::Scope, so that every command is profiled
+ * under its own name without having to do it itself.
  * 
  * @author WPILib, modified by Arthur Lockman
  */
@@ -25,6 +32,17 @@ public:
 	static OperatorInterface *oi;
 	static DriveSubsystem *s_Drive;
 	static LogSystem *s_Log;
+	static GyroSubsystem *s_Gyro;
+	static AccelerometerSubsystem *s_Accelerometer;
+
+protected:
+	virtual void Execute();
+	//! Called repeatedly while the command is scheduled, in place of Execute
+	virtual void DoExecute() = 0;
+
+private:
+	//! Profiles DoExecute, see LoopProfiler::Scope
+	LoopProfiler m_executeProfiler;
 };
 
 #endif
@@ -1,25 +1,73 @@
 #include "WPILib.h"
 #include "Commands/Command.h"
 #include "CommandBase.h"
+#include "Commands/FollowPathCommand.h"
+#include "Commands/TeleopDriveCommand.h"
+
+namespace
+{
+	//! The path driven in autonomous, in inches from where the robot starts,
+	//! used when kAutonomousTrajectoryFile cannot be loaded
+	const Waypoint autonomousPath[] =
+	{
+		{0.0, 0.0},
+		{96.0, 0.0},
+		{144.0, 48.0},
+	};
+}
 
 class CommandBasedRobot : public IterativeRobot 
 {
 private:
 	Command *autonomousCommand;
+	Command *teleopCommand;
+	LoopProfiler m_autonomousProfiler;
+	LoopProfiler m_teleopProfiler;
 	
+public:
+	CommandBasedRobot() :
+		autonomousCommand(NULL),
+		teleopCommand(NULL),
+		m_autonomousProfiler("AutonomousPeriodic"),
+		m_teleopProfiler("TeleopPeriodic")
+	{
+	}
+
+private:
 	virtual void RobotInit() 
 	{
 		CommandBase::init();
+		teleopCommand = new TeleopDriveCommand();
+		// Following a path needs the pose from the drive encoders, without
+		// them the robot would drive blind for all of autonomous
+		if (kUseEncoders)
+		{
+			autonomousCommand = new FollowPathCommand(kAutonomousTrajectoryFile, autonomousPath,
+				sizeof (autonomousPath) / sizeof (autonomousPath[0]));
+		}
+		else
+		{
+			LOG_MESSAGE("No drive encoders, autonomous will not drive.", kLogPriorityError);
+		}
 	}
 	
 	virtual void AutonomousInit() 
 	{
-		autonomousCommand->Start();
+		// Each match gets its own logfile
+		CommandBase::s_Log->StartNewLog();
+		// The driver's stick must never drive the robot in autonomous
+		teleopCommand->Cancel();
+		if (autonomousCommand != NULL)
+		{
+			autonomousCommand->Start();
+		}
 	}
 	
 	virtual void AutonomousPeriodic() 
 	{
+		const LoopProfiler::Scope profile(m_autonomousProfiler);
 		Scheduler::GetInstance()->Run();
+		CommandBase::s_Log->CommitTelemetry();
 	}
 	
 	virtual void TeleopInit() 
@@ -28,12 +76,18 @@ private:
 		// teleop starts running. If you want the autonomous to 
 		// continue until interrupted by another command, remove
 		// this line or comment it out.
-		autonomousCommand->Cancel();
+		if (autonomousCommand != NULL)
+		{
+			autonomousCommand->Cancel();
+		}
+		teleopCommand->Start();
 	}
 	
 	virtual void TeleopPeriodic() 
 	{
+		const LoopProfiler::Scope profile(m_teleopProfiler);
 		Scheduler::GetInstance()->Run();
+		CommandBase::s_Log->CommitTelemetry();
 	}
 };
 
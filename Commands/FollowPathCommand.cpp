@@ -0,0 +1,66 @@
+#include "FollowPathCommand.h"
+
+FollowPathCommand::FollowPathCommand(const char* filename, const Waypoint* waypoints, int count) :
+	CommandBase("FollowPathCommand")
+{
+	Requires(s_Drive);
+	if (m_trajectory.Load(filename))
+	{
+		LOG_MESSAGE("Loaded trajectory file.", kLogPriorityDebug);
+	}
+	else
+	{
+		LOG_MESSAGE("Unable to load trajectory file, using the built in path.", kLogPriorityError);
+		if (!m_trajectory.Build(waypoints, count, kPathMaxVelocity, kPathMaxAcceleration))
+		{
+			LOG_MESSAGE("Path is too long, increase kTrajectoryMaxPoints.", kLogPriorityError);
+		}
+	}
+}
+
+// Called just before this Command runs the first time
+void FollowPathCommand::Initialize() 
+{
+	if (!kUseEncoders)
+	{
+		LOG_MESSAGE("Not following the path, there are no drive encoders to estimate the pose.", kLogPriorityError);
+		return;
+	}
+	LOG_MESSAGE("Starting follow path command.", kLogPrioritySystem);
+	s_Drive->ResetPose();
+	m_follower.Start(&m_trajectory);
+}
+
+// Called repeatedly when this Command is scheduled to run
+void FollowPathCommand::DoExecute() 
+{
+	if (!kUseEncoders)
+	{
+		return;
+	}
+	float forward;
+	float turnRate;
+	m_follower.Update(s_Drive->GetPose(), forward, turnRate);
+	s_Drive->DriveAutonomous(forward, 0.0, turnRate);
+}
+
+// Make this return true when this Command no longer needs to run execute()
+bool FollowPathCommand::IsFinished() 
+{
+	return !kUseEncoders || m_follower.IsFinished();
+}
+
+// Called once after isFinished returns true
+void FollowPathCommand::End() 
+{
+	LOG_MESSAGE("Stopping follow path command.", kLogPrioritySystem);
+	s_Drive->DriveAutonomous(0.0, 0.0, 0.0);
+}
+
+// Called when another command which requires one or more of the same
+// subsystems is scheduled to run
+void FollowPathCommand::Interrupted() 
+{
+	LOG_MESSAGE("Follow path command interrupted.", kLogPrioritySystem);
+	s_Drive->DriveAutonomous(0.0, 0.0, 0.0);
+}
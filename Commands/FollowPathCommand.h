@@ -0,0 +1,34 @@
+#ifndef FOLLOWPATHCOMMAND_H
+#define FOLLOWPATHCOMMAND_H
+
+#include "../CommandBase.h"
+#include "../Classes/Trajectory.h"
+#include "../Classes/PathFollower.h"
+
+/**
+ * Drives the robot along a trajectory in autonomous, using the pose
+ * estimated from the drive encoders.
+ *
+ * The trajectory is loaded from a file made by Tools/TrajectoryGenerator.cpp
+ * when the command is created, at boot, or built from a list of waypoints
+ * if the file cannot be loaded. Starting the command only resets the pose
+ * and the follower.
+ *
+ * Without kUseEncoders the pose never moves from the origin, so the
+ * command refuses to start and finishes straight away.
+ */
+class FollowPathCommand: public CommandBase {
+public:
+	FollowPathCommand(const char* filename, const Waypoint* waypoints, int count);
+	virtual void Initialize();
+	virtual void DoExecute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+private:
+	Trajectory m_trajectory;
+	PathFollower m_follower;
+};
+
+#endif
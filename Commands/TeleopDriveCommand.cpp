@@ -11,11 +11,11 @@ TeleopDriveCommand::TeleopDriveCommand() :
 // Called just before this Command runs the first time
 void TeleopDriveCommand::Initialize() 
 {
-	CommandBase::s_Log->LogMessage("Starting teleop drive command.",kLogPrioritySystem);
+	LOG_MESSAGE("Starting teleop drive command.", kLogPrioritySystem);
 }
 
 // Called repeatedly when this Command is scheduled to run
-void TeleopDriveCommand::Execute() 
+void TeleopDriveCommand::DoExecute() 
 {
 	s_Drive->DriveTeleop(oi->GetDriverStick());
 }
@@ -29,12 +29,12 @@ bool TeleopDriveCommand::IsFinished()
 // Called once after isFinished returns true
 void TeleopDriveCommand::End() 
 {
-	CommandBase::s_Log->LogMessage("Stopping teleop drive command.",kLogPrioritySystem);
+	LOG_MESSAGE("Stopping teleop drive command.", kLogPrioritySystem);
 }
 
 // Called when another command which requires one or more of the same
 // subsystems is scheduled to run
 void TeleopDriveCommand::Interrupted() 
 {
-	CommandBase::s_Log->LogMessage("Teleop drive command interrupted!.",kLogPriorityError);
+	LOG_MESSAGE("Teleop drive command interrupted!.", kLogPriorityError);
 }
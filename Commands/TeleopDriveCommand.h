@@ -12,7 +12,7 @@ class TeleopDriveCommand: public CommandBase {
 public:
 	TeleopDriveCommand();
 	virtual void Initialize();
-	virtual void Execute();
+	virtual void DoExecute();
 	virtual bool IsFinished();
 	virtual void End();
 	virtual void Interrupted();
@@ -11,11 +11,11 @@ OperatorInterface::OperatorInterface() try :
 	//Create joystick buttons for each joystick here, using
 	//stick.button.WhenPressed(new Command()); or stick.button.WhileHeld(new Command());
     
-	CommandBase::s_Log->LogMessage("All OI elements created successfully.",kLogPriorityDebug);
+	LOG_MESSAGE("All OI elements created successfully.", kLogPriorityDebug);
 }
 catch (exception e)
 {
-	CommandBase::s_Log->LogMessage("Operator interface failed to initialize.",kLogPriorityError);
+	LOG_MESSAGE("Operator interface failed to initialize.", kLogPriorityError);
 }
 
 /**
@@ -80,6 +80,27 @@ enum DriveMode
 	kSwivelSteer = 4,
 };
 
+/**
+ * @brief How the drive motor speeds are controlled.
+ */
+enum DriveControlMode
+{
+	kDriveOpenLoop = 1,				//!< The mixer output is the motor output
+	kDriveJaguarSpeedControl = 2,	//!< Each Jaguar runs a speed PID loop
+	kDriveCRIOSpeedControl = 3,		//!< A cRIO task runs the speed PID loops
+};
+
+/**
+ * @brief The rate groups of the PeriodicScheduler, fastest first.
+ */
+enum RateGroup
+{
+	kSensorRateGroup = 0,		//!< Sampling the sensors, every kSensorRatePeriod
+	kControlRateGroup = 1,		//!< Control loops, every kControlRatePeriod
+	kTelemetryRateGroup = 2,	//!< Reporting, every kTelemetryRatePeriod
+	kRateGroups = 3,
+};
+
 /**
  * @brief The different possible levels of debug logging.
  */
@@ -90,15 +111,94 @@ enum LogPriority
 	kLogPriorityError = 3
 };
 
+/**
+ * @brief The formats the logfile can be written in.
+ */
+enum LogFormat
+{
+	kLogFormatText = 1,
+	kLogFormatBinary = 2,
+};
+
 //Variables that concern driving the robot.
 static const float kDriveP = 0.0;
 static const float kDriveI = 0.0;
 static const float kDriveD = 0.0;
+static const float kDriveF = 0.04; //Volts per RPM of feed-forward, for kDriveCRIOSpeedControl.
+static const float kDriveMaxRPM = 300.0; //The speed setpoint for full output in the closed loop modes.
+static const DriveControlMode kDriveControlMode = kDriveOpenLoop; //The closed loop modes need kUseEncoders.
+static const float kDriveControlPeriod = 0.04; //Seconds, for kDriveCRIOSpeedControl. Each drive Jaguar's speed is read every 4 * kCANStatusPollPeriod.
+static const float kDriveSetpointTimeout = 0.1; //Seconds, kDriveCRIOSpeedControl stops the motors if the setpoints get older.
 static const int kDriveOutputVoltageLimit = 12;
 static const int kDriveEncoderLines = 256;
 static const bool kUseEncoders = false;
 static const float kDriveRamp = 0.4;
 static const float kDriveVelocityLimit = 1.0;
+static const float kDrivePeriod = 0.02; //Seconds, the nominal period kDriveRamp is tuned for.
+static const float kDriveMaxPeriod = 0.1; //Seconds, longer gaps between outputs are clamped to this.
+static const int kDriveSyncGroup = 0x10; //The CAN sync group the drive Jaguars update together in.
+static const float kCANWriteTolerance = 0.001; //Setpoint changes smaller than this are not sent.
+static const float kCANRefreshPeriod = 0.1; //Seconds, unchanged setpoints are resent this often.
+static const float kCANStatusPollPeriod = 0.01; //Seconds between status polls, each poll reads one Jaguar.
+static const float kCANElectricalPollPeriod = 1.0; //Seconds between reads of each Jaguar's voltage, current and temperature.
+static const int kCANStatusMaxJaguars = 8;
+static const int kJaguarMotionRequests = 2; //CAN requests made by every status poll, for the position and speed.
+static const int kJaguarElectricalRequests = 3; //CAN requests added to a poll that reads the voltage, current and temperature.
+static const float kPoseEstimatorPeriod = 0.01; //Seconds between pose updates.
+
+//Variables that concern the sensors.
+static const int kGyroChannel = 1; //Analog channel on the first analog module.
+static const float kGyroSensitivity = 0.007; //Volts per degree per second.
+static const int kAccelerometerModule = 1; //Digital module the I2C accelerometer is wired to.
+static const bool kUseGyro = false; //The gyro calibrates for 5 seconds when it is created.
+static const bool kUseAccelerometer = false;
+
+//Variables that concern the periodic scheduler.
+static const float kSensorRatePeriod = 0.005; //Seconds, 200Hz.
+static const float kControlRatePeriod = 0.01; //Seconds, 100Hz.
+static const float kTelemetryRatePeriod = 0.1; //Seconds, 10Hz.
+static const int kSchedulerMaxJobs = 8; //Per rate group.
+static const float kSchedulerReportPeriod = 5.0; //Seconds between rate group statistics in the log.
+
+//Variables that concern following paths in autonomous.
+static const float kDriveMaxSpeed = 120.0; //Inches per second of wheel travel at full output.
+static const int kTrajectoryMaxPoints = 512;
+static const float kTrajectorySpacing = 2.0; //Inches between trajectory points.
+static const float kPathMaxVelocity = 60.0; //Inches per second.
+static const float kPathMaxAcceleration = 60.0; //Inches per second squared.
+static const float kPathLookahead = 18.0; //Inches.
+static const int kPathSearchWindow = 16; //Trajectory points searched for the closest point each cycle.
+static const char* const kAutonomousTrajectoryFile = "/c/autonomous.traj"; //Made by Tools/TrajectoryGenerator.cpp.
 static const bool kProcessImages = true;
+static const int kCameraImageWidth = 320; //Must match the resolution set in Camera::ProcessImages.
+static const int kCameraImageHeight = 240;
+static const int kTargetHueMin = 70; //The target HSL ranges, each 0 to 255.
+static const int kTargetHueMax = 130;
+static const int kTargetSaturationMin = 80;
+static const int kTargetSaturationMax = 255;
+static const int kTargetLuminanceMin = 60;
+static const int kTargetLuminanceMax = 255;
+static const int kTargetMinArea = 50; //Pixels, smaller blobs are ignored.
+static const int kTargetMaxBlobs = 4;
+static const int kTargetMaxRuns = 4096; //Must be less than 65536.
+static const int kMotionProfileMaxPoints = 256;
+static const float kMotionProfileStep = 0.01; //Seconds between motion profile points.
+
+//Variables that concern logging.
+static const int kLogBufferSize = 256; //Must be a power of 2.
+static const int kLogMessageLength = 120;
+static const int kLogWriteBatchSize = 4096;
+static const int kLogMaxMessageIds = 256; //Must be a power of 2.
+static const LogFormat kLogFormat = kLogFormatText;
+static const int kLogFileMaxSize = 1048576; //Bytes, per logfile.
+static const int kLogMaxFiles = 20;
+static const int kTelemetryMaxChannels = 32;
+static const int kTelemetryBlockRows = 50;
+static const int kTelemetryBlocks = 4;
+
+//Variables that concern the loop profiler, which is only compiled in with -DLOOP_PROFILER.
+static const int kProfilerBucketWidth = 50; //Microseconds per histogram bucket.
+static const int kProfilerBuckets = 512;
+static const float kProfilerReportPeriod = 5.0; //Seconds between summaries in the log.
 
 #endif
@@ -1,12 +1,15 @@
 #include "AccelerometerSubsystem.h"
 #include "../Robotmap.h"
+#include "../Classes/RobotClock.h"
 
 /**
- * @brief Initialize the Accelerometer.
+ * @brief Initialize the Accelerometer, and register it to be read in the
+ * sensor rate group.
  */
-AccelerometerSubsystem::AccelerometerSubsystem() : Subsystem("AccelerometerSubsystem") 
+AccelerometerSubsystem::AccelerometerSubsystem() : Subsystem("AccelerometerSubsystem"),
+	m_accelerometer(kAccelerometerModule)
 {
-	
+	PeriodicScheduler::GetInstance()->Register(this, kSensorRateGroup, "AccelerometerSubsystem");
 }
   
 /**
@@ -17,3 +20,25 @@ void AccelerometerSubsystem::InitDefaultCommand()
 {
 	
 }
+
+/**
+ * @brief Returns the latest reading of the accelerometer. This never waits.
+ */
+AccelerometerReading AccelerometerSubsystem::GetReading() const
+{
+	return m_reading.Read();
+}
+
+/**
+ * @brief Reads all three axes, called by the PeriodicScheduler.
+ */
+void AccelerometerSubsystem::RunPeriodic()
+{
+	const ADXL345_I2C::AllAxes axes = m_accelerometer.GetAccelerations();
+	AccelerometerReading reading;
+	reading.m_time = RobotClock::GetTime();
+	reading.m_x = axes.XAxis;
+	reading.m_y = axes.YAxis;
+	reading.m_z = axes.ZAxis;
+	m_reading.Write(reading);
+}
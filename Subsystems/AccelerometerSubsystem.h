@@ -2,20 +2,43 @@
 #define ACCELEROMETERSUBSYSTEM_H
 #include "Commands/Subsystem.h"
 #include "WPILib.h"
+#include "../Robotmap.h"
+#include "../Classes/PeriodicScheduler.h"
+#include "../Classes/SeqLock.h"
+
+/**
+ * @brief A reading of the accelerometer, in g.
+ */
+struct AccelerometerReading
+{
+	UINT32 m_time;		//!< The time the accelerometer was read
+	float m_x;
+	float m_y;
+	float m_z;
+};
 
 /**
  * This subsystem is the controller for the accelerometer on the robot.
  * All methods for accessing and initializing the Accelerometer
  * should go here. Call these methods with commands.
  *
+ * The accelerometer is read every kSensorRatePeriod by the
+ * PeriodicScheduler, and the latest reading is published through a
+ * SeqLock so that reading it from a command never waits on the I2C bus.
+ *
  * @author arthurlockman
  */
-class AccelerometerSubsystem: public Subsystem {
+class AccelerometerSubsystem: public Subsystem, private PeriodicJob {
 private:
+	void RunPeriodic();
+
+	ADXL345_I2C m_accelerometer;
+	SeqLock<AccelerometerReading> m_reading;
 	
 public:
 	AccelerometerSubsystem();
 	void InitDefaultCommand();
+	AccelerometerReading GetReading() const;
 };
 
 #endif
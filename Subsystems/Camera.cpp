@@ -19,12 +19,24 @@ IMAQ_FUNC int Priv_SetWriteFileAllowed(UINT32 enable);
 Camera::Camera() :
 	Subsystem("Camera"),
 	m_cam(AxisCamera::GetInstance("10.1.72.11")),
+	m_newImageSemaphore(m_cam.GetNewImageSem()),
+	m_frameCount(0),
+	m_targets(TargetReport()),
 	m_saveSourceImage(false),
 	m_saveProcessedImages(false),
 	m_frameProcessingTime(0),
+	m_frameDecodeTime(0),
 	m_imageProcessingTask("ImageProcessing", (FUNCPTR)Camera::ImageProcessingTask, Task::kDefaultPriority + 10),
 	m_cameraSemaphore (semBCreate (SEM_Q_PRIORITY, SEM_FULL))
 {
+	// Size the images now so that decoding a frame never reallocates them.
+	// Cycling each one through to the front leaves nothing published.
+	for (int i = 0; i < 3; ++i)
+	{
+		imaqSetImageSize (m_images.GetBack().GetImaqImage(), kCameraImageWidth, kCameraImageHeight);
+		m_images.Publish();
+		m_images.Update();
+	}
 	SetDirectory ("/tmp/Images");
 	m_imageProcessingTask.Start (reinterpret_cast<UINT32> (this));
 }
@@ -88,17 +100,29 @@ void Camera::ProcessImages()
 
 	while (kProcessImages)
 	{
-		// Wait for a new image to be available
-		if (m_cam.IsFreshImage() == false)
-		{
-			taskDelay (2);
-			continue;
-		}
+		// Sleep until the camera receives a new image. The semaphore is
+		// given by the camera's receive task, so this wakes as soon as
+		// the image arrives rather than on the next poll.
+		semTake (m_newImageSemaphore, WAIT_FOREVER);
+		const UINT32 arrival = GetFPGATime();
 
-		m_cam.GetImage (&m_image);
-		if (m_saveSourceImage) SaveImage(m_image, "src.jpg");
+		HSLImage& image = m_images.GetBack();
+		m_cam.GetImage (&image);
+		m_frameDecodeTime = GetFPGATime() - arrival;
+		if (m_saveSourceImage) SaveImage(image, "src.jpg");
 
-		//! @TODO: IMAGE PROCCESSING CODE HERE.
+		// Find the targets
+		ImageInfo info;
+		imaqGetImageInfo (image.GetImaqImage(), &info);
+		TargetReport report;
+		m_detector.Detect (static_cast<const HSLValue*>(info.imageStart),
+			info.xRes, info.yRes, info.pixelsPerLine, report);
+		report.m_frame = m_frameCount + 1;
+		report.m_time = arrival;
+		m_targets.Write (report);
+
+		m_images.Publish();
+		m_frameCount = m_frameCount + 1;
 
 		// Update the processing time.  We add 1 to ensure the time
 		// is never 0
@@ -108,6 +132,30 @@ void Camera::ProcessImages()
 	}
 }
 
+/** 
+ * @brief Returns the newest processed image, or NULL if no image has been
+ * processed yet. The image is not copied, and stays valid until the next
+ * call. Only call this from one task, normally the main robot task.
+ */
+const HSLImage* Camera::GetLatestImage()
+{
+	if (m_frameCount == 0)
+	{
+		return NULL;
+	}
+	m_images.Update();
+	return &m_images.GetFront();
+}
+
+/** 
+ * @brief Returns the targets found in the newest image. The frame number
+ * is 0 until the first image has been processed. This never waits.
+ */
+TargetReport Camera::GetTargetReport() const
+{
+	return m_targets.Read();
+}
+
 /** 
  * @brief Writes the image to the file system
  * @author Stephen Nutt
@@ -1,6 +1,9 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 #include <WPILib.h>
+#include "../Classes/TripleBuffer.h"
+#include "../Classes/SeqLock.h"
+#include "../Classes/TargetDetector.h"
 
 /**
  * @brief This class is the camera subsystem. It is used
@@ -10,6 +13,17 @@
  * 10.1.72.11. If this is different, be sure to change
  * the IP in the constructor for this class.
  *
+ * The images are kept in a TripleBuffer of images that are allocated at
+ * full size when the camera is created. The processing task decodes each
+ * new frame into the back image and processes it there, then publishes
+ * it, so no image memory is allocated once the robot has booted and the
+ * task never waits for the image to be used. GetLatestImage returns the
+ * newest processed image without copying it.
+ *
+ * Each image is searched for targets by a TargetDetector, and the targets
+ * are published through a SeqLock. GetTargetReport never waits, so it can
+ * be called from any command.
+ *
  * @author Arthur Lockman, Steve Nutt
  */
  class Camera: public Subsystem {
@@ -20,9 +34,17 @@
 
 	//! The axis camera instance
  	AxisCamera& m_cam;
+ 	//! Given by the camera each time a new image arrives
+ 	const SEM_ID m_newImageSemaphore;
 
- 	//! The current camera image
- 	mutable HSLImage m_image;
+ 	//! The camera images, decoded and processed in the back image
+ 	TripleBuffer<HSLImage> m_images;
+ 	//! The number of images published
+ 	volatile UINT32 m_frameCount;
+ 	//! Finds the targets in each image
+ 	TargetDetector m_detector;
+ 	//! The targets found in the newest image
+ 	SeqLock<TargetReport> m_targets;
  	//! The directory the images are stored in
  	char m_directory[32];
  	//! The unique image number used to generate the image file name
@@ -35,6 +57,8 @@
  	bool m_saveProcessedImages;
  	//! The time it took to process the last frame in ms
  	UINT32 m_frameProcessingTime;
+ 	//! The time it took to decode the last frame in us
+ 	UINT32 m_frameDecodeTime;
 	
 	//! The task object used to process camera images
  	Task m_imageProcessingTask;
@@ -48,11 +72,23 @@
  	void InitDefaultCommand();
  	void SetDirectory(const char* directory, unsigned nextImage = 1);
  	void CaptureImages(unsigned count);
+ 	const HSLImage* GetLatestImage();
+ 	TargetReport GetTargetReport() const;
 
  	UINT32 GetLastFrameProcessingTime() const
  	{
  		return m_frameProcessingTime;
  	}
+
+ 	/**
+ 	 * @brief Returns the time in microseconds it took AxisCamera::GetImage
+ 	 * to decode the last frame. The time the frame waited before that is
+ 	 * not included, as the camera gives no time for when it arrived.
+ 	 */
+ 	UINT32 GetLastFrameDecodeTime() const
+ 	{
+ 		return m_frameDecodeTime;
+ 	}
  };
  #endif
 
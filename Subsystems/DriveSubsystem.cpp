@@ -10,7 +10,7 @@
 DriveSubsystem::DriveSubsystem(DriveMode mode) : Subsystem("DriveSubsystem") 
 {
 	m_drive = new AdvancedRobotDrive(mode);
-	CommandBase::s_Log->LogMessage("Drive system initiated.",kLogPriorityDebug);
+	LOG_MESSAGE("Drive system initiated.", kLogPriorityDebug);
 }
 
 /**
@@ -20,6 +20,9 @@ DriveSubsystem::DriveSubsystem(DriveMode mode) : Subsystem("DriveSubsystem")
  */
 void DriveSubsystem::InitDefaultCommand() 
 {
+	// There is no default command, the scheduler also runs in autonomous
+	// and a default TeleopDriveCommand would let the driver's stick drive
+	// the robot then. The robot starts TeleopDriveCommand in TeleopInit.
 }
 
 /**
@@ -29,13 +32,45 @@ void DriveSubsystem::InitDefaultCommand()
  */
 void DriveSubsystem::DriveTeleop(FRCXboxJoystick &stick)
 {
-	m_drive->DriveRobot(stick);
+	DriveTeleop(-stick.GetLeftStickY(), stick.GetLeftStickX(), stick.GetRightStickX());
+}
+
+/**
+ * @brief Drive the robot in teleop mode from driver inputs that do not
+ * come from a joystick, for example scripted inputs in a simulation.
+ * @param move The forward speed, -1 to 1.
+ * @param strafe The sideways speed, -1 to 1.
+ * @param rotate The rotation speed, -1 to 1.
+ */
+void DriveSubsystem::DriveTeleop(float move, float strafe, float rotate)
+{
+	m_drive->DriveRobot(move, strafe, rotate);
 }
 
 /**
  * @brief Drive the robot in autonomous.
+ * @param forward The forward speed in inches per second.
+ * @param strafe The speed to the right in inches per second.
+ * @param turnRate The anticlockwise turn rate in radians per second.
+ */
+void DriveSubsystem::DriveAutonomous(float forward, float strafe, float turnRate)
+{
+	m_drive->DriveAutonomous(forward, strafe, turnRate);
+}
+
+/**
+ * @brief Returns the latest pose of the robot, estimated from the drive
+ * encoders. This never waits, so it is safe to call from any command.
+ */
+RobotPose DriveSubsystem::GetPose() const
+{
+	return m_drive->GetPose();
+}
+
+/**
+ * @brief Makes the current position of the robot the origin of the pose.
  */
-void DriveSubsystem::DriveAutonomous()
+void DriveSubsystem::ResetPose()
 {
-	//@TODO: Complete this method.
+	m_drive->ResetPose();
 }
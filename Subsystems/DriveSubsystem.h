@@ -3,6 +3,7 @@
 #include "Commands/Subsystem.h"
 #include "WPILib.h"
 #include "../Classes/AdvancedRobotDrive.h"
+#include "../Classes/FRCXboxJoystick.h"
 #include "../Robotmap.h"
 
 /**
@@ -19,7 +20,10 @@ public:
 	DriveSubsystem(DriveMode mode);
 	void InitDefaultCommand();
 	void DriveTeleop(FRCXboxJoystick &stick);
-	void DriveAutonomous();
+	void DriveTeleop(float move, float strafe, float rotate);
+	void DriveAutonomous(float forward, float strafe, float turnRate);
+	RobotPose GetPose() const;
+	void ResetPose();
 };
 
 #endif
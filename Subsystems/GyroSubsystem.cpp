@@ -1,12 +1,16 @@
 #include "GyroSubsystem.h"
 #include "../Robotmap.h"
+#include "../Classes/RobotClock.h"
 
 /**
- * @brief Initialize the Gyro.
+ * @brief Initialize the Gyro, and register it to be read in the sensor
+ * rate group.
  */
-GyroSubsystem::GyroSubsystem() : Subsystem("GyroSubsystem") 
+GyroSubsystem::GyroSubsystem() : Subsystem("GyroSubsystem"),
+	m_gyro(kGyroChannel)
 {
-	
+	m_gyro.SetSensitivity(kGyroSensitivity);
+	PeriodicScheduler::GetInstance()->Register(this, kSensorRateGroup, "GyroSubsystem");
 }
     
 /**
@@ -18,3 +22,32 @@ void GyroSubsystem::InitDefaultCommand()
 	// Set the default command for a subsystem here.
 	//SetDefaultCommand(new MySpecialCommand());
 }
+
+/**
+ * @brief Returns the latest reading of the gyro. This never waits.
+ */
+GyroReading GyroSubsystem::GetReading() const
+{
+	return m_reading.Read();
+}
+
+/**
+ * @brief Makes the current heading zero. Only do this while the robot is
+ * still, the gyro also recalibrates.
+ */
+void GyroSubsystem::Reset()
+{
+	m_gyro.Reset();
+}
+
+/**
+ * @brief Reads the gyro, called by the PeriodicScheduler.
+ */
+void GyroSubsystem::RunPeriodic()
+{
+	GyroReading reading;
+	reading.m_time = RobotClock::GetTime();
+	reading.m_angle = m_gyro.GetAngle();
+	reading.m_rate = m_gyro.GetRate();
+	m_reading.Write(reading);
+}
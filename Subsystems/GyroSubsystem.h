@@ -2,20 +2,43 @@
 #define GYROSUBSYSTEM_H
 #include "Commands/Subsystem.h"
 #include "WPILib.h"
+#include "../Robotmap.h"
+#include "../Classes/PeriodicScheduler.h"
+#include "../Classes/SeqLock.h"
+
+/**
+ * @brief A reading of the gyro.
+ */
+struct GyroReading
+{
+	UINT32 m_time;		//!< The time the gyro was read
+	float m_angle;		//!< The heading in degrees, clockwise from when the gyro was reset
+	float m_rate;		//!< The turn rate in degrees per second, clockwise
+};
 
 /**
  * This subsystem is the controller for the gyro on the robot.
  * All methods for accessing and initializing the gyro
  * should go here. Call these methods with commands.
  *
+ * The gyro is read every kSensorRatePeriod by the PeriodicScheduler, and
+ * the latest reading is published through a SeqLock so that reading it
+ * from a command never waits.
+ *
  * @author arthurlockman
  */
-class GyroSubsystem: public Subsystem {
+class GyroSubsystem: public Subsystem, private PeriodicJob {
 private:
+	void RunPeriodic();
+
+	Gyro m_gyro;
+	SeqLock<GyroReading> m_reading;
 	
 public:
 	GyroSubsystem();
 	void InitDefaultCommand();
+	GyroReading GetReading() const;
+	void Reset();
 };
 
 #endif
@@ -1,26 +1,85 @@
 #include "LogSystem.h"
 #include "../Robotmap.h"
+#include "../Classes/MemoryBarrier.h"
+#include "../Classes/RobotClock.h"
+#include <intLib.h>
+#include <ioLib.h>
+#include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 /** 
  * @brief Private NI function needed to write to the VxWorks target 
  */
 IMAQ_FUNC int Priv_SetWriteFileAllowed(UINT32 enable); 
 
+namespace
+{
+	//! Room for the longest formatted record, text or binary
+	const int maxRecordSize = sizeof (BinaryLogRecord) + kLogMessageLength + 32;
+}
+
 /**
  * @brief Constructs the Logging subsystem.
  * @param level The level of logs to save to the logfile and print to
  * the console. 
+ * @param format The format to write the logfile in.
  * 
  * @author Arthur Lockman
  */
-LogSystem::LogSystem(LogPriority level) : 
+LogSystem::LogSystem(LogPriority level, LogFormat format) : 
 	Subsystem("LogSystem") , 
-	m_logLevel(level)
+	m_logLevel(level),
+	m_logFormat(format),
+	m_head(0),
+	m_tail(0),
+	m_droppedMessages(0),
+	m_reportedDrops(0),
+	m_logFile(NULL),
+	m_logFileSize(0),
+	m_logSequence(0),
+	m_newLogRequested(false),
+	m_internCount(0),
+	m_writtenInternCount(0),
+	m_internSemaphore(semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE)),
+	m_recordSemaphore(semBCreate(SEM_Q_PRIORITY, SEM_EMPTY)),
+	m_stopRequested(false),
+	m_stoppedSemaphore(semBCreate(SEM_Q_PRIORITY, SEM_EMPTY)),
+	m_telemetry(m_recordSemaphore),
+	m_telemetryFile(NULL),
+	m_writerTask("LogWriter", (FUNCPTR)LogSystem::LogWriterTask, Task::kDefaultPriority + 20)
+{
+	for (int i = 0; i < kLogBufferSize; ++i)
+	{
+		m_buffer[i].m_ready = false;
+	}
+	for (int i = 0; i < kLogMaxMessageIds; ++i)
+	{
+		m_internKeys[i] = NULL;
+	}
+
+	this->SetDirectory(LOG_DIRECTORY);
+	this->ReadLogIndex();
+	this->OpenLogFiles();
+	this->Enqueue("-----System Boot: Starting New Log-----", kLogPriorityError, false, 0.0);
+	m_writerTask.Start(reinterpret_cast<UINT32>(this));
+}
+
+/**
+ * @brief Stops the writer task and closes the logfiles. The writer task
+ * is asked to stop rather than being killed, so it is never stopped part
+ * way through a write, and it writes out the messages and telemetry still
+ * waiting in the buffers before it exits.
+ */
+LogSystem::~LogSystem()
 {
-	this->SetDirectory("/tmp/log");
-	this->PrintToFile("-----System Boot: Starting New Log-----");
-	this->Print("-----System Boot: Starting New Log-----");
+	m_stopRequested = true;
+	semGive(m_recordSemaphore);
+	semTake(m_stoppedSemaphore, WAIT_FOREVER);
+	this->CloseLogFiles();
+	semDelete(m_stoppedSemaphore);
+	semDelete(m_recordSemaphore);
+	semDelete(m_internSemaphore);
 }
     
 /**
@@ -43,6 +102,216 @@ void LogSystem::SetDirectory(const char* directory)
 {
 	strcpy(m_logDirectory, directory);
 	Priv_SetWriteFileAllowed(1);
+	mkdir(m_logDirectory);
+}
+
+/**
+ * @brief Reads the sequence number of the last logfile from the logindex
+ * file in the log directory.
+ */
+void LogSystem::ReadLogIndex()
+{
+	char path[64];
+	sprintf(path, "%s/logindex", m_logDirectory);
+	FILE* index = fopen(path, "r");
+	if (index != NULL)
+	{
+		unsigned sequence;
+		if (fscanf(index, "%u", &sequence) == 1)
+		{
+			m_logSequence = sequence;
+		}
+		fclose(index);
+	}
+}
+
+/**
+ * @brief Saves the sequence number of the current logfile to the logindex
+ * file so that the next boot carries on from it.
+ */
+void LogSystem::WriteLogIndex()
+{
+	char path[64];
+	sprintf(path, "%s/logindex", m_logDirectory);
+	FILE* index = fopen(path, "w");
+	if (index != NULL)
+	{
+		fprintf(index, "%u\n", m_logSequence);
+		fclose(index);
+	}
+}
+
+/**
+ * @brief Creates a new file in the log directory, allocating its space on
+ * the disk up front.
+ * @param prefix The start of the file name.
+ * @param extension The file name extension.
+ * @param size The number of bytes to allocate.
+ * @return The file, or NULL if it could not be created.
+ */
+FILE* LogSystem::CreateLogFile(const char* prefix, const char* extension, UINT32 size)
+{
+	char path[64];
+	sprintf(path, "%s/%s%05u.%s", m_logDirectory, prefix, m_logSequence, extension);
+	FILE* file = fopen(path, "wb");
+	if (file != NULL)
+	{
+		// Ask dosFs for the whole file as one contiguous run of clusters, so
+		// writes never have to extend the file allocation table. If this
+		// fails the file still works, it just grows as it is written.
+		fflush(file);
+		ioctl(fileno(file), FIOCONTIG, size);
+	}
+	return file;
+}
+
+/**
+ * @brief Closes the current logfile and telemetry file, if open.
+ */
+void LogSystem::CloseLogFiles()
+{
+	if (m_logFile != NULL)
+	{
+		fclose(m_logFile);
+		m_logFile = NULL;
+	}
+	m_telemetry.SetFile(NULL);
+	if (m_telemetryFile != NULL)
+	{
+		fclose(m_telemetryFile);
+		m_telemetryFile = NULL;
+	}
+}
+
+/**
+ * @brief Closes the current files and starts the next numbered logfile and
+ * telemetry file, deleting the oldest files if there are too many.
+ */
+void LogSystem::OpenLogFiles()
+{
+	this->CloseLogFiles();
+	++m_logSequence;
+	this->WriteLogIndex();
+
+	// A drain of the ring buffer, or a write of the telemetry blocks, can
+	// take a file past its maximum size before it is rotated, so leave
+	// room for it
+	const UINT32 maxLogSize = kLogFileMaxSize + kLogBufferSize * maxRecordSize;
+	const UINT32 maxTelemetrySize = kLogFileMaxSize + TelemetryRecorder::GetMaxWriteSize();
+	if (m_logFormat == kLogFormatBinary)
+	{
+		m_logFile = this->CreateLogFile("log", "bin", maxLogSize);
+		if (m_logFile != NULL)
+		{
+			BinaryLogHeader header;
+			header.m_magic = kBinaryLogMagic;
+			header.m_byteOrder = kBinaryLogByteOrder;
+			header.m_version = kBinaryLogVersion;
+			header.m_recordSize = sizeof (BinaryLogRecord);
+			fwrite(&header, sizeof (header), 1, m_logFile);
+		}
+		// Every file must define the messages it uses
+		m_writtenInternCount = 0;
+	}
+	else
+	{
+		m_logFile = this->CreateLogFile("log", "txt", maxLogSize);
+	}
+	m_logFileSize = 0;
+
+	m_telemetryFile = this->CreateLogFile("telemetry", "bin", maxTelemetrySize);
+	m_telemetry.SetFile(m_telemetryFile);
+
+	this->PruneLogFiles();
+}
+
+/**
+ * @brief Deletes the files in the log directory that are more than
+ * kLogMaxFiles logfiles old.
+ */
+void LogSystem::PruneLogFiles()
+{
+	if (m_logSequence <= static_cast<UINT32>(kLogMaxFiles))
+	{
+		return;
+	}
+	const UINT32 oldest = m_logSequence - kLogMaxFiles;
+
+	DIR* directory = opendir(m_logDirectory);
+	if (directory == NULL)
+	{
+		return;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != NULL)
+	{
+		const char* number = entry->d_name;
+		if (strncmp(number, "log", 3) == 0 && strcmp(number, "logindex") != 0)
+		{
+			number += 3;
+		}
+		else if (strncmp(number, "telemetry", 9) == 0)
+		{
+			number += 9;
+		}
+		else
+		{
+			continue;
+		}
+
+		char* end;
+		const unsigned long sequence = strtoul(number, &end, 10);
+		if (end != number && *end == '.' && sequence <= oldest)
+		{
+			char path[64];
+			sprintf(path, "%s/%s", m_logDirectory, entry->d_name);
+			remove(path);
+		}
+	}
+	closedir(directory);
+}
+
+/**
+ * @brief Starts a new logfile and telemetry file, for example at the start
+ * of a match. The files are switched by the writer task.
+ */
+void LogSystem::StartNewLog()
+{
+	m_newLogRequested = true;
+	semGive(m_recordSemaphore);
+}
+
+/**
+ * @brief Sets the lowest priority of message that is logged. Messages
+ * below LOG_MINIMUM_PRIORITY are never logged, whatever the level.
+ * @param level The new log level.
+ */
+void LogSystem::SetLogLevel(LogPriority level)
+{
+	m_logLevel = level;
+}
+
+/**
+ * @brief Registers a telemetry channel. Channels must be registered before
+ * the first call to CommitTelemetry.
+ * @param name The name of the channel.
+ * @param type The type of the channel's values.
+ * @param units The units of the channel's values.
+ * @return The channel to pass to SampleTelemetry, or -1 if it could not be
+ * registered.
+ */
+int LogSystem::RegisterTelemetryChannel(const char* name, TelemetryType type, const char* units)
+{
+	return m_telemetry.RegisterChannel(name, type, units);
+}
+
+/**
+ * @brief Completes this cycle's telemetry samples. Call this once per
+ * cycle after all of the channels have been sampled.
+ */
+void LogSystem::CommitTelemetry()
+{
+	m_telemetry.CommitRow(RobotClock::GetTime());
 }
 
 /**
@@ -56,32 +325,400 @@ void LogSystem::LogMessage(const char* message, LogPriority level)
 {
 	if (level >= m_logLevel)
 	{
-		this->Print(message);
-		this->PrintToFile(message);
+		this->Enqueue(message, level, false, 0.0);
 	}
 }
 
 /**
- * @brief Logs a message to the console.
- * @param message The message to log. 
- * 
- * @author Arthur Lockman
+ * @brief Logs a message along with a numeric value to the logfile
+ * and to the console.
+ * @param message The message to be logged.
+ * @param value The value to log with the message.
+ * @param level The level of log that this message has attached to it.
  */
-void LogSystem::Print(const char* message)
+void LogSystem::LogValue(const char* message, float value, LogPriority level)
 {
-	printf("%i:  %s\n",GetFPGATime(),message);
+	if (level >= m_logLevel)
+	{
+		this->Enqueue(message, level, true, value);
+	}
 }
 
 /**
- * @brief Logs a message to the logfile.
+ * @brief Logs text that is built at run time. Unlike LogMessage the text
+ * is never interned, so it can be in a buffer that is reused.
+ * @param text The text to be logged.
+ * @param level The level of log that this text has attached to it.
+ */
+void LogSystem::LogText(const char* text, LogPriority level)
+{
+	if (level >= m_logLevel)
+	{
+		this->Enqueue(text, level, false, 0.0, false);
+	}
+}
+
+/**
+ * @brief Timestamps a message and copies it into the ring buffer for
+ * the writer task. This takes the same time regardless of how busy
+ * the logfile is, and never waits. If the buffer is full the message
+ * is dropped and counted.
  * @param message The message to log.
- * 
- * @author Arthur Lockman
+ * @param level The level of log that this message has attached to it.
+ * @param hasValue True if value should be logged with the message.
+ * @param value The value to log with the message.
+ * @param intern False if the message must be copied even in binary mode.
+ */
+void LogSystem::Enqueue(const char* message, LogPriority level, bool hasValue, float value, bool intern)
+{
+	// In binary mode the message is normally interned, in which case only
+	// its ID needs to be copied
+	const UINT16 messageId = (intern && m_logFormat == kLogFormatBinary) ?
+		this->InternMessage(message) : kBinaryLogNoMessageId;
+
+	// Claim a slot in the ring buffer. The cRIO has a single processor so
+	// locking interrupts for the few instructions needed to bump the head
+	// is the cheapest way to make the claim atomic between tasks, and unlike
+	// a semaphore it can never block the caller.
+	const int lockKey = intLock();
+	const UINT32 head = m_head;
+	const bool full = (head - m_tail) >= static_cast<UINT32>(kLogBufferSize);
+	if (full)
+	{
+		++m_droppedMessages;
+	}
+	else
+	{
+		m_head = head + 1;
+	}
+	intUnlock(lockKey);
+
+	if (full)
+	{
+		return;
+	}
+
+	LogRecord& record = m_buffer[head & (kLogBufferSize - 1)];
+	record.m_time = RobotClock::GetTime();
+	record.m_level = level;
+	record.m_hasValue = hasValue;
+	record.m_value = value;
+	record.m_messageId = messageId;
+
+	if (messageId == kBinaryLogNoMessageId)
+	{
+		char* dest = record.m_message;
+		const char* const end = dest + kLogMessageLength - 1;
+		while (*message != '\0' && dest < end)
+		{
+			*dest++ = *message++;
+		}
+		*dest = '\0';
+	}
+
+	// Publish the record only once its contents are visible to the writer
+	MemoryBarrier();
+	record.m_ready = true;
+	semGive(m_recordSemaphore);
+}
+
+/**
+ * @brief Returns the ID of a message, interning it if this is the first
+ * time it has been logged. Messages are looked up by address, so after
+ * the first call this is a couple of memory reads.
+ * @param message The message to intern.
+ * @return The ID of the message, or kBinaryLogNoMessageId if the intern
+ * table is full.
+ */
+UINT16 LogSystem::InternMessage(const char* message)
+{
+	const UINT32 mask = kLogMaxMessageIds - 1;
+	const UINT32 hash = (reinterpret_cast<UINT32>(message) >> 2) * 2654435761U;
+
+	UINT32 slot = hash & mask;
+	for (int probe = 0; probe < kLogMaxMessageIds; ++probe)
+	{
+		const char* const key = m_internKeys[slot];
+		if (key == message)
+		{
+			return m_internIds[slot];
+		}
+		if (key == NULL)
+		{
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	// The first time a message is logged we add it to the table. Only one
+	// task may add a message at a time, but lookups carry on regardless.
+	const Synchronized sync(m_internSemaphore);
+
+	// Keep a free slot so that lookups always terminate
+	const UINT32 id = m_internCount;
+	if (id >= static_cast<UINT32>(kLogMaxMessageIds - 1))
+	{
+		return kBinaryLogNoMessageId;
+	}
+
+	slot = hash & mask;
+	while (m_internKeys[slot] != NULL)
+	{
+		if (m_internKeys[slot] == message)
+		{
+			// Another task interned it while we were waiting
+			return m_internIds[slot];
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	strncpy(m_internText[id], message, kLogMessageLength - 1);
+	m_internText[id][kLogMessageLength - 1] = '\0';
+	m_internIds[slot] = id;
+
+	// The text must be counted before the key is visible so the writer
+	// defines the message before any record that uses it
+	MemoryBarrier();
+	m_internCount = id + 1;
+	MemoryBarrier();
+	m_internKeys[slot] = message;
+	return id;
+}
+
+/**
+ * @brief Static function called when the writer task is started. Waits
+ * for messages to be logged and writes them out, until the destructor
+ * asks it to stop.
+ */
+void LogSystem::LogWriterTask(LogSystem& log)
+{
+	while (true)
+	{
+		semTake(log.m_recordSemaphore, WAIT_FOREVER);
+		log.WriteRecords();
+		log.m_telemetry.WriteBlocks();
+		if (log.m_stopRequested)
+		{
+			// Also write the telemetry block that is still being filled
+			log.m_telemetry.Flush();
+			semGive(log.m_stoppedSemaphore);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Drains the ring buffer, formatting the messages into a single
+ * batch which is written out in one go.
+ */
+void LogSystem::WriteRecords()
+{
+	char batch[kLogWriteBatchSize];
+	int length = 0;
+
+	// Start new files when either file is full, the telemetry is written
+	// after the records so this is checked before each write of either
+	if (m_newLogRequested || m_logFileSize >= static_cast<UINT32>(kLogFileMaxSize) ||
+		m_telemetry.GetFileSize() >= static_cast<UINT32>(kLogFileMaxSize))
+	{
+		m_newLogRequested = false;
+		this->OpenLogFiles();
+	}
+
+	if (m_logFormat == kLogFormatBinary)
+	{
+		this->FormatInternedMessages(batch, length);
+	}
+
+	while (true)
+	{
+		LogRecord& record = m_buffer[m_tail & (kLogBufferSize - 1)];
+		if (record.m_ready == false)
+		{
+			break;
+		}
+
+		if (m_logFormat == kLogFormatBinary)
+		{
+			// The message may have been interned since we last looked
+			if (record.m_messageId != kBinaryLogNoMessageId &&
+				record.m_messageId >= m_writtenInternCount)
+			{
+				this->FormatInternedMessages(batch, length);
+			}
+
+			if (record.m_level >= kLogPriorityError)
+			{
+				const char* text = (record.m_messageId == kBinaryLogNoMessageId) ?
+					record.m_message : m_internText[record.m_messageId];
+				printf("%u:  %s\n", record.m_time, text);
+			}
+		}
+
+		this->ReserveBatch(batch, length);
+		length += this->FormatRecord(batch + length, record);
+
+		// Hand the slot back to the logging tasks
+		record.m_ready = false;
+		MemoryBarrier();
+		m_tail = m_tail + 1;
+	}
+
+	const UINT32 dropped = m_droppedMessages;
+	if (dropped != m_reportedDrops)
+	{
+		this->ReserveBatch(batch, length);
+		if (m_logFormat == kLogFormatBinary)
+		{
+			BinaryLogRecord binary;
+			binary.m_time = RobotClock::GetTime();
+			binary.m_type = kBinaryLogDropped;
+			binary.m_priority = kLogPriorityError;
+			binary.m_messageId = kBinaryLogNoMessageId;
+			binary.m_length = dropped - m_reportedDrops;
+			length += this->FormatBinaryRecord(batch + length, binary);
+		}
+		else
+		{
+			length += sprintf(batch + length, "%u:  %u log messages dropped.\n",
+				RobotClock::GetTime(), dropped - m_reportedDrops);
+		}
+		m_reportedDrops = dropped;
+	}
+
+	this->WriteBatch(batch, length);
+}
+
+/**
+ * @brief Writes out the batch if there is no room left in it for
+ * another record.
+ * @param batch The batch of formatted records.
+ * @param length The length of the batch, reset to 0 if it was written.
+ */
+void LogSystem::ReserveBatch(char* batch, int& length)
+{
+	if (length + maxRecordSize > kLogWriteBatchSize)
+	{
+		this->WriteBatch(batch, length);
+		length = 0;
+	}
+}
+
+/**
+ * @brief Adds the definitions of any messages interned since the last
+ * call to the batch.
+ * @param batch The batch of formatted records.
+ * @param length The length of the batch.
+ */
+void LogSystem::FormatInternedMessages(char* batch, int& length)
+{
+	const UINT32 count = m_internCount;
+	MemoryBarrier();
+	for (; m_writtenInternCount < count; ++m_writtenInternCount)
+	{
+		const char* text = m_internText[m_writtenInternCount];
+		BinaryLogRecord binary;
+		binary.m_time = RobotClock::GetTime();
+		binary.m_type = kBinaryLogString;
+		binary.m_priority = 0;
+		binary.m_messageId = m_writtenInternCount;
+		binary.m_length = strlen(text);
+
+		this->ReserveBatch(batch, length);
+		length += this->FormatBinaryRecord(batch + length, binary, text);
+	}
+}
+
+/**
+ * @brief Formats a single log record in the current log format.
+ * @param buffer The buffer to format the record into.
+ * @param record The record to format.
+ * @return The number of characters written to the buffer.
+ */
+int LogSystem::FormatRecord(char* buffer, const LogRecord& record)
+{
+	if (m_logFormat == kLogFormatBinary)
+	{
+		BinaryLogRecord binary;
+		binary.m_time = record.m_time;
+		binary.m_priority = record.m_level;
+		binary.m_messageId = record.m_messageId;
+		if (record.m_messageId == kBinaryLogNoMessageId)
+		{
+			// A text record has no room for a value, so the value is
+			// written into the text as the text format writes it
+			char text[kLogMessageLength + 32];
+			const char* message = record.m_message;
+			if (record.m_hasValue)
+			{
+				snprintf(text, sizeof(text), "%s %f", record.m_message,
+					static_cast<double>(record.m_value));
+				message = text;
+			}
+			binary.m_type = kBinaryLogText;
+			binary.m_length = strlen(message);
+			return this->FormatBinaryRecord(buffer, binary, message);
+		}
+		if (record.m_hasValue)
+		{
+			binary.m_type = kBinaryLogValue;
+			binary.m_value = record.m_value;
+		}
+		else
+		{
+			binary.m_type = kBinaryLogMessage;
+			binary.m_length = 0;
+		}
+		return this->FormatBinaryRecord(buffer, binary);
+	}
+
+	if (record.m_hasValue)
+	{
+		return sprintf(buffer, "%u:  %s %f\n", record.m_time, record.m_message,
+			static_cast<double>(record.m_value));
+	}
+	return sprintf(buffer, "%u:  %s\n", record.m_time, record.m_message);
+}
+
+/**
+ * @brief Copies a binary record, followed by its text if it has any,
+ * into the buffer.
+ * @param buffer The buffer to copy the record into.
+ * @param record The record to copy.
+ * @param text The text following the record, m_length characters long.
+ * @return The number of bytes written to the buffer.
  */
-void LogSystem::PrintToFile(const char* message)
+int LogSystem::FormatBinaryRecord(char* buffer, const BinaryLogRecord& record, const char* text)
 {
-	//@TODO Log message to the logfile.
-	FILE* logFile = fopen("logfile.txt","a"); 
-	fprintf(logFile, "%i:  %s\n",GetFPGATime(),message);
-	fclose(logFile);
+	memcpy(buffer, &record, sizeof (record));
+	if (text == NULL)
+	{
+		return sizeof (record);
+	}
+	memcpy(buffer + sizeof (record), text, record.m_length);
+	return sizeof (record) + record.m_length;
+}
+
+/**
+ * @brief Writes a batch of formatted records to the logfile and, in
+ * text mode, to the console.
+ * @param batch The formatted records.
+ * @param length The number of characters in the batch.
+ */
+void LogSystem::WriteBatch(const char* batch, int length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+	if (m_logFormat == kLogFormatText)
+	{
+		fwrite(batch, 1, length, stdout);
+	}
+	if (m_logFile != NULL)
+	{
+		fwrite(batch, 1, length, m_logFile);
+		fflush(m_logFile);
+		m_logFileSize += length;
+	}
 }
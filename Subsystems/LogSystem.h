@@ -3,30 +3,216 @@
 #include "Commands/Subsystem.h"
 #include "WPILib.h"
 #include "../Robotmap.h"
+#include "../Classes/BinaryLogFormat.h"
+#include "../Classes/TelemetryRecorder.h"
+#include <stdio.h>
 
 /**
  * @brief A logging system for the Robot. This log will log anything
  * to the netconsole, as well as save all logs to a logfile. What this
  * log system outputs depends on which log level is set at its initialization.
- * In addition, every log message that is passed in must have a log level 
- * attached to it. This way, the console doesn't get clogged up with 
+ * In addition, every log message that is passed in must have a log level
+ * attached to it. This way, the console doesn't get clogged up with
  * non-critical messages unless testing is going on.
  *
+ * Logging a message never does any IO on the caller's task. The message is
+ * timestamped and copied into a fixed size ring buffer, and a low priority
+ * writer task drains the buffer, writing the messages to the console and
+ * to the logfile in batches. If the buffer is full the message is dropped
+ * and counted rather than making the caller wait.
+ *
+ * In kLogFormatBinary mode the logfile is written in the format described
+ * in Classes/BinaryLogFormat.h, and only errors are printed to the console.
+ * Messages are interned by address the first time they are logged, after
+ * which logging them only copies a message ID, so messages logged in binary
+ * mode should be string literals. Text built at run time, for example
+ * with sprintf, must be logged with LogText, which always copies it. Use
+ * Tools/LogDecoder.cpp to turn the binary logfile back into text or CSV.
+ *
+ * Numeric signals that are logged every cycle should use the telemetry
+ * channels rather than log messages. Register the channels once at
+ * initialization, sample them from the control loop and call
+ * CommitTelemetry once per cycle. The samples are written in blocks to
+ * the telemetry file by the writer task, see TelemetryRecorder.
+ *
+ * The logfile and telemetry file are kept in the log directory, numbered
+ * with a sequence number that is stored in the directory's logindex file.
+ * A new pair of files is started at boot, by StartNewLog at the start of a
+ * match, and whenever the logfile or the telemetry file grows past
+ * kLogFileMaxSize. Each file has its full size allocated when it is
+ * created, so appending to it during a match never has to update the file
+ * allocation table. Only the last kLogMaxFiles pairs of files are kept.
+ *
  * @author arthurlockman
  * @see https://github.com/NorthernForce/Rebound-Rumble/blob/master/Project/Commands/LogAccelerometer.cpp
  */
-class LogSystem: public Subsystem 
+
+/**
+ * @brief The lowest priority of log message that is compiled into the robot
+ * code. Messages logged with LOG_MESSAGE or LOG_VALUE below this priority
+ * compile to nothing, arguments included. Override it from the build, for
+ * example -DLOG_MINIMUM_PRIORITY=2 removes all of the kLogPrioritySystem
+ * messages. The runtime log level set in LogSystem still applies to the
+ * messages that are compiled in.
+ */
+#ifndef LOG_MINIMUM_PRIORITY
+#define LOG_MINIMUM_PRIORITY 1
+#endif
+
+/**
+ * @brief The directory the logfiles are written to. The host build sets it
+ * to Tools/build/log, so the simulation does not write into the host's
+ * /tmp.
+ */
+#ifndef LOG_DIRECTORY
+#define LOG_DIRECTORY "/tmp/log"
+#endif
+
+/**
+ * @brief Logs a message through CommandBase::s_Log if the priority is at or
+ * above LOG_MINIMUM_PRIORITY. The priority should be a constant so that the
+ * test is done by the compiler. This is an expression so that it can be used
+ * with the comma operator in initializer lists.
+ */
+#define LOG_MESSAGE(message, level) \
+	(((level) >= LOG_MINIMUM_PRIORITY) ? \
+		CommandBase::s_Log->LogMessage((message), (level)) : (void)0)
+
+/**
+ * @brief Logs a message and a value through CommandBase::s_Log if the
+ * priority is at or above LOG_MINIMUM_PRIORITY.
+ */
+#define LOG_VALUE(message, value, level) \
+	(((level) >= LOG_MINIMUM_PRIORITY) ? \
+		CommandBase::s_Log->LogValue((message), (value), (level)) : (void)0)
+
+/**
+ * @brief Logs text that is built at run time through CommandBase::s_Log if
+ * the priority is at or above LOG_MINIMUM_PRIORITY.
+ */
+#define LOG_TEXT(text, level) \
+	(((level) >= LOG_MINIMUM_PRIORITY) ? \
+		CommandBase::s_Log->LogText((text), (level)) : (void)0)
+
+class LogSystem: public Subsystem
 {
 private:
-	void Print(const char* message);
-	void PrintToFile(const char* message);
+	/**
+	 * @brief A single log message waiting in the ring buffer.
+	 */
+	struct LogRecord
+	{
+		volatile bool m_ready;				//!< Set once the producer has finished writing the record
+		bool m_hasValue;					//!< Set when m_value should be logged with the message
+		UINT16 m_messageId;					//!< The interned message ID, used in binary mode
+		UINT32 m_time;						//!< The FPGA time the message was logged
+		LogPriority m_level;				//!< The priority of the message
+		float m_value;						//!< The numeric value logged with the message
+		char m_message[kLogMessageLength];	//!< The message text, used when the message is not interned
+	};
+
+	static void LogWriterTask(LogSystem& log);
+	void WriteRecords();
+	void WriteBatch(const char* batch, int length);
+	void ReserveBatch(char* batch, int& length);
+	int FormatRecord(char* buffer, const LogRecord& record);
+	int FormatBinaryRecord(char* buffer, const BinaryLogRecord& record, const char* text = NULL);
+	void FormatInternedMessages(char* batch, int& length);
+	void Enqueue(const char* message, LogPriority level, bool hasValue, float value, bool intern = true);
+	UINT16 InternMessage(const char* message);
+	void SetDirectory(const char* directory);
+	void OpenLogFiles();
+	void CloseLogFiles();
+	void PruneLogFiles();
+	void ReadLogIndex();
+	void WriteLogIndex();
+	FILE* CreateLogFile(const char* prefix, const char* extension, UINT32 size);
+
 	LogPriority m_logLevel;
+	LogFormat m_logFormat;
 	char m_logDirectory[32];
-	void SetDirectory(const char* directory);
+
+	//! The ring buffer of messages waiting to be written
+	LogRecord m_buffer[kLogBufferSize];
+	//! The total number of records claimed by the logging tasks
+	volatile UINT32 m_head;
+	//! The total number of records written by the writer task
+	volatile UINT32 m_tail;
+	//! The number of messages dropped because the buffer was full
+	volatile UINT32 m_droppedMessages;
+	//! The number of dropped messages already reported in the log
+	UINT32 m_reportedDrops;
+	//! The logfile, kept open by the writer task
+	FILE* m_logFile;
+	//! The number of bytes written to the current logfile
+	UINT32 m_logFileSize;
+	//! The sequence number of the current logfile
+	UINT32 m_logSequence;
+	//! Set by StartNewLog to make the writer task start a new logfile
+	volatile bool m_newLogRequested;
+
+	//! The addresses of the interned messages, hashed by address
+	const char* volatile m_internKeys[kLogMaxMessageIds];
+	//! The message IDs of the interned messages, indexed like m_internKeys
+	UINT16 m_internIds[kLogMaxMessageIds];
+	//! The text of each interned message, indexed by message ID
+	char m_internText[kLogMaxMessageIds][kLogMessageLength];
+	//! The number of interned messages
+	volatile UINT32 m_internCount;
+	//! The number of interned messages already written to the logfile
+	UINT32 m_writtenInternCount;
+	//! Serializes adding new messages to the intern table
+	const SEM_ID m_internSemaphore;
+
+	//! Signalled whenever a new record is placed in the ring buffer
+	const SEM_ID m_recordSemaphore;
+	//! Set by the destructor to make the writer task drain the buffer and exit
+	volatile bool m_stopRequested;
+	//! Given by the writer task once it has written everything and exited
+	const SEM_ID m_stoppedSemaphore;
+	//! The per-cycle telemetry, written by the writer task
+	TelemetryRecorder m_telemetry;
+	//! The telemetry file
+	FILE* m_telemetryFile;
+	//! The task object used to write the log messages
+	Task m_writerTask;
+
 public:
-	LogSystem(LogPriority level);
+	LogSystem(LogPriority level, LogFormat format = kLogFormat);
+	~LogSystem();
 	void InitDefaultCommand();
 	void LogMessage(const char* message, LogPriority level = kLogPriorityDebug);
+	void LogValue(const char* message, float value, LogPriority level = kLogPriorityDebug);
+	void LogText(const char* text, LogPriority level = kLogPriorityDebug);
+	void SetLogLevel(LogPriority level);
+	void StartNewLog();
+	int RegisterTelemetryChannel(const char* name, TelemetryType type, const char* units);
+	void CommitTelemetry();
+
+	/**
+	 * @brief Samples a floating point telemetry channel for this cycle.
+	 */
+	inline void SampleTelemetry(int channel, float value)
+	{
+		m_telemetry.Sample(channel, value);
+	}
+
+	/**
+	 * @brief Samples an integer telemetry channel for this cycle.
+	 */
+	inline void SampleTelemetry(int channel, INT32 value)
+	{
+		m_telemetry.Sample(channel, value);
+	}
+
+	/**
+	 * @brief Returns the number of messages dropped because the ring buffer
+	 * was full.
+	 */
+	UINT32 GetDroppedMessageCount() const
+	{
+		return m_droppedMessages;
+	}
 };
 
 #endif
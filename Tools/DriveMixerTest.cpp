@@ -0,0 +1,356 @@
+/*
+ * DriveMixerTest.cpp
+ *
+ * Host side test of DriveMixer. Build and run it with
+ * "make -C Tools check".
+ *
+ * The BSBot outputs are compared with the DriveBSBot and PowerMotors code
+ * that DriveMixer replaced, which is copied below, over a grid of move and
+ * rotate commands, combined and saturated ones included. They must give
+ * the same outputs, so the driver's feel does not change. The BSBot is
+ * also checked against golden values worked out from the old code, and
+ * the other drive modes against golden values worked out by hand.
+ * DriveKinematics::MixTurnFirst must turn the robot at RotationGain times
+ * the rotate command even when the wheels saturate.
+ *
+ * The program then times the old code, with its drive mode switches,
+ * against the DriveMixer facade and DriveKinematics instantiated for the
+ * mode, as AdvancedRobotDrive uses it. The timings are for the host, not
+ * the cRIO, so only compare them with each other. The program exits with a failure if any
+ * check fails. This file is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+using namespace std;
+
+#include "../Robotmap.h"
+#include "../Classes/DriveMixer.h"
+
+namespace
+{
+	const float kTolerance = 1e-5;		//!< Largest difference between matching outputs
+	const unsigned kCalls = 2000000;	//!< Number of calls timed in each run
+	const int kRuns = 5;				//!< Number of timed runs
+
+	int s_failures = 0;
+
+	//! Returns the host time in microseconds
+	double Now()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec * 1e6 + tv.tv_usec;
+	}
+
+	float Limit(float input, float max)
+	{
+		if (input > max)
+		{
+			return max;
+		} else if (input < -max)
+		{
+			return -max;
+		}
+		return input;
+	}
+
+	//! AdvancedRobotDrive::DriveBSBot before DriveMixer. The limit passed
+	//! to Limit was uninitialized, it is taken to be 1 here.
+	void OldBSBot(float moveValue, float rotateValue, float outputs[kDriveWheels])
+	{
+		const float rotateReduce = 1.5;
+		const float wheelRatio = 25.0 / 22.25;
+		float frontLeft;
+		float frontRight;
+		float limit = 1.0;
+
+		moveValue   = Limit (moveValue, limit);
+		rotateValue = Limit (rotateValue, limit) / rotateReduce;
+
+		if (moveValue >= 0.0)
+		{
+			if (rotateValue > 0.0)
+			{
+				frontLeft = moveValue - rotateValue;
+				frontRight = max (moveValue, rotateValue);
+			}
+			else
+			{
+				frontLeft = max (moveValue, -rotateValue);
+				frontRight = moveValue + rotateValue;
+			}
+		}
+		else
+		{
+			if (rotateValue > 0.0)
+			{
+				frontLeft = -max (-moveValue, rotateValue);
+				frontRight = moveValue + rotateValue;
+			}
+			else
+			{
+				frontLeft = moveValue - rotateValue;
+				frontRight = -max (-moveValue, -rotateValue);
+			}
+		}
+
+		float rearLeft  = frontLeft  * (0.5 + wheelRatio) + frontRight * (0.5 - wheelRatio);
+		float rearRight = frontRight * (0.5 + wheelRatio) + frontLeft  * (0.5 - wheelRatio);
+
+		const float maxSpeed = max (fabs (rearLeft), fabs (rearRight));
+		if (maxSpeed > 1.0)
+		{
+			rearLeft /= maxSpeed;
+			rearRight /= maxSpeed;
+		}
+
+		outputs[kFrontLeftWheel] = frontLeft;
+		outputs[kRearLeftWheel] = rearLeft;
+		outputs[kFrontRightWheel] = frontRight;
+		outputs[kRearRightWheel] = rearRight;
+	}
+
+	//! The old DriveRobot, which switched on the drive mode every call, and
+	//! PowerMotors, which switched on it again to apply the inversions
+	void OldDrive(DriveMode mode, float move, float rotate, float outputs[kDriveWheels])
+	{
+		switch (mode)
+		{
+			case kBSBotDrive:
+				OldBSBot(move, rotate, outputs);
+				break;
+			default:
+				outputs[kFrontLeftWheel] = outputs[kRearLeftWheel] = 0.0;
+				outputs[kFrontRightWheel] = outputs[kRearRightWheel] = 0.0;
+				break;
+		}
+		switch (mode)
+		{
+			case kMecanumDrive:
+				break;
+			default:
+				outputs[kRearRightWheel] = -outputs[kRearRightWheel];
+				outputs[kFrontRightWheel] = -outputs[kFrontRightWheel];
+				break;
+		}
+	}
+
+	//! Prints a failure if the outputs are not the expected ones
+	void Check(const char* name, const float outputs[kDriveWheels], const float expected[kDriveWheels])
+	{
+		bool passed = true;
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			passed = passed && fabs(outputs[i] - expected[i]) <= kTolerance;
+		}
+		if (!passed)
+		{
+			printf("FAILED: %s gives %.4f %.4f %.4f %.4f, expected %.4f %.4f %.4f %.4f\n", name,
+				outputs[0], outputs[1], outputs[2], outputs[3],
+				expected[0], expected[1], expected[2], expected[3]);
+			++s_failures;
+		}
+	}
+
+	//! Checks DriveMixer against the old BSBot code
+	void CheckOldBSBot(float move, float rotate)
+	{
+		const DriveMixer mixer(kBSBotDrive);
+		float outputs[kDriveWheels];
+		float expected[kDriveWheels];
+		mixer.Mix(move, 0.0, rotate, outputs);
+		OldDrive(kBSBotDrive, move, rotate, expected);
+		char name[80];
+		sprintf(name, "BSBot move %g rotate %g", move, rotate);
+		Check(name, outputs, expected);
+	}
+
+	//! A golden value, the outputs in DriveWheel order
+	struct Golden
+	{
+		DriveMode m_mode;
+		const char* m_name;
+		float m_move;
+		float m_strafe;
+		float m_rotate;
+		float m_outputs[kDriveWheels];
+	};
+
+	// The BSBot front wheels get rotate / 1.5, and the faster one the larger
+	// of the move and the turn. The rear wheels are (front left + front
+	// right) / 2 plus or minus 25 / 22.25 times their difference, and only
+	// they are scaled down if one exceeds 1. The right side motors are
+	// inverted except on the mecanum drive.
+	const Golden kGoldens[] =
+	{
+		{kBSBotDrive, "BSBot move 0.5 rotate 0.45", 0.5, 0.0, 0.45, {0.2, 0.01292, -0.5, -0.68708}},
+		{kBSBotDrive, "BSBot reverse 0.5 rotate -0.3", -0.5, 0.0, -0.3, {-0.3, -0.17528, 0.5, 0.62472}},
+		{kBSBotDrive, "BSBot move 0.3 rotate -0.6", 0.3, 0.0, -0.6, {0.4, 0.7118, 0.1, 0.4118}},
+		{kBSBotDrive, "BSBot full rotate", 0.0, 0.0, 1.0, {-0.66667, -1.0, -0.66667, -1.0}},
+		{kBSBotDrive, "BSBot full move and rotate", 1.0, 0.0, 1.0, {0.33333, -0.05820, -1.0, -1.0}},
+		{kBSBotDrive, "BSBot ignores strafe", 0.5, 1.0, 0.0, {0.5, 0.5, -0.5, -0.5}},
+		{kMecanumDrive, "Mecanum move and strafe", 0.5, 0.25, 0.0, {0.75, 0.25, 0.25, 0.75}},
+		{kMecanumDrive, "Mecanum rotate", 0.0, 0.0, 0.5, {-0.5, -0.5, 0.5, 0.5}},
+		{kMecanumDrive, "Mecanum full move and strafe", 1.0, 1.0, 0.0, {1.0, 0.0, 0.0, 1.0}},
+		{kSkidSteer, "Skid steer move and rotate", 0.5, 0.0, 0.3, {0.3, 0.3, -0.7, -0.7}},
+		{kSkidSteer, "Skid steer full move and rotate", 1.0, 0.0, 1.0, {0.2, 0.2, -1.0, -1.0}},
+		{kSwivelSteer, "Swivel steer move and rotate", 0.5, 0.0, 0.3, {0.3, 0.3, -0.7, -0.7}},
+	};
+	const int kGoldenCount = sizeof(kGoldens) / sizeof(kGoldens[0]);
+
+	//! Returns the rotation the outputs of a mix give, in radians per inch
+	//! of wheel travel
+	template <DriveMode Mode>
+	float Rotation(const float outputs[kDriveWheels])
+	{
+		typedef DriveModeMix<Mode, RobotGeometry> ModeMix;
+		float wheels[kDriveWheels];
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			wheels[i] = outputs[i] * ModeMix::Inversion(i);
+		}
+		float forward;
+		float strafe;
+		float rotation;
+		ModeMix::Motion(wheels, forward, strafe, rotation);
+		return rotation;
+	}
+
+	//! Checks that MixTurnFirst turns at RotationGain times the rotate
+	//! command without saturating a wheel, and prints how much of that
+	//! turn Mix gives
+	template <DriveMode Mode>
+	void CheckTurnFirst(const char* name, float move, float strafe, float rotate)
+	{
+		const float expected = DriveKinematics<Mode>::RotationGain() * rotate;
+		float outputs[kDriveWheels];
+		DriveKinematics<Mode>::Mix(move, strafe, rotate, outputs);
+		const float mixed = Rotation<Mode>(outputs);
+		DriveKinematics<Mode>::MixTurnFirst(move, strafe, rotate, outputs);
+		const float turnFirst = Rotation<Mode>(outputs);
+		printf("%-32s %10.3f %10.3f\n", name, mixed / expected, turnFirst / expected);
+
+		bool saturated = false;
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			saturated = saturated || fabs(outputs[i]) > 1.0 + kTolerance;
+		}
+		if (saturated || fabs(turnFirst - expected) > kTolerance * fabs(expected))
+		{
+			printf("FAILED: %s does not turn at the rotation gain\n", name);
+			++s_failures;
+		}
+	}
+
+	//! The move and rotate commands of the timed calls
+	const unsigned kInputs = 1024;
+	float s_moves[kInputs];
+	float s_rotates[kInputs];
+
+	//! Spreads the timed commands over -1 to 1
+	void MakeInputs()
+	{
+		for (unsigned i = 0; i < kInputs; ++i)
+		{
+			s_moves[i] = ((i * 7) % 2001) * 0.001 - 1.0;
+			s_rotates[i] = ((i * 13) % 2001) * 0.001 - 1.0;
+		}
+	}
+}
+
+int main()
+{
+	// Every combination of move and rotate from -1.2 to 1.2, past the
+	// limits, in steps of 0.05. The rear wheels saturate when the turn is
+	// large, for example a rotate command of more than 1.5 * 22.25 /
+	// (2 * 25), that is 0.6675, on its own.
+	for (int move = -24; move <= 24; ++move)
+	{
+		for (int rotate = -24; rotate <= 24; ++rotate)
+		{
+			CheckOldBSBot(move * 0.05, rotate * 0.05);
+		}
+	}
+
+	for (int i = 0; i < kGoldenCount; ++i)
+	{
+		const Golden& golden = kGoldens[i];
+		const DriveMixer mixer(golden.m_mode);
+		float outputs[kDriveWheels];
+		mixer.Mix(golden.m_move, golden.m_strafe, golden.m_rotate, outputs);
+		Check(golden.m_name, outputs, golden.m_outputs);
+	}
+
+	// Rotate commands up to MaxRotate, 0.6675 on the BSBot
+	printf("%-32s %10s %10s\n", "Turn as a fraction of the gain", "Mix", "TurnFirst");
+	CheckTurnFirst<kBSBotDrive>("BSBot rotate", 0.0, 0.0, 0.6);
+	CheckTurnFirst<kBSBotDrive>("BSBot full move, rotate 0.5", 1.0, 0.0, 0.5);
+	CheckTurnFirst<kBSBotDrive>("BSBot full reverse, rotate -0.6", -1.0, 0.0, -0.6);
+	CheckTurnFirst<kMecanumDrive>("Mecanum full strafe, rotate 0.5", 0.5, 1.0, 0.5);
+	CheckTurnFirst<kSkidSteer>("Skid steer full move, rotate 1", 1.0, 0.0, 1.0);
+
+	// Past MaxRotate the turn is limited to the fastest the robot can make
+	float turnOutputs[kDriveWheels];
+	DriveKinematics<kBSBotDrive>::MixTurnFirst(1.0, 0.0, 1.0, turnOutputs);
+	const float fastestTurn[kDriveWheels] = {-0.44500, -1.0, -0.44500, -1.0};
+	Check("BSBot turn first full move and rotate", turnOutputs, fastestTurn);
+	printf("\n");
+
+	// The mode is volatile so the switches are not optimized away
+	MakeInputs();
+	volatile DriveMode mode = kBSBotDrive;
+	// The best of several runs, as the host may be busy with other work
+	const DriveMixer mixer(mode);
+	float outputs[kDriveWheels];
+	double checksum = 0;
+	double oldTime = 1e30;
+	double mixerTime = 1e30;
+	double kinematicsTime = 1e30;
+	for (int run = 0; run < kRuns; ++run)
+	{
+		double start = Now();
+		for (unsigned i = 0; i < kCalls; ++i)
+		{
+			OldDrive(mode, s_moves[i % kInputs], s_rotates[i % kInputs], outputs);
+			checksum += outputs[kRearLeftWheel];
+		}
+		oldTime = min(oldTime, Now() - start);
+
+		start = Now();
+		for (unsigned i = 0; i < kCalls; ++i)
+		{
+			mixer.Mix(s_moves[i % kInputs], 0.0, s_rotates[i % kInputs], outputs);
+			checksum += outputs[kRearLeftWheel];
+		}
+		mixerTime = min(mixerTime, Now() - start);
+
+		start = Now();
+		for (unsigned i = 0; i < kCalls; ++i)
+		{
+			DriveKinematics<kBSBotDrive>::Mix(s_moves[i % kInputs], 0.0, s_rotates[i % kInputs], outputs);
+			checksum += outputs[kRearLeftWheel];
+		}
+		kinematicsTime = min(kinematicsTime, Now() - start);
+	}
+
+	printf("%-32s %10s\n", "BSBot drive", "ns/call");
+	printf("%-32s %10.1f\n", "Old DriveBSBot with switches", oldTime * 1000.0 / kCalls);
+	printf("%-32s %10.1f\n", "DriveMixer facade", mixerTime * 1000.0 / kCalls);
+	printf("%-32s %10.1f\n", "DriveKinematics<kBSBotDrive>", kinematicsTime * 1000.0 / kCalls);
+	printf("(%g)\n", checksum);
+
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * FilterBankBenchmark.cpp
+ *
+ * Host side benchmark that filters N signals sharing a measurement time
+ * with N separate AlphaBetaFilter<float> objects and with one
+ * AlphaBetaFilterBank<float, N>, for N of 4, 16 and 64, and prints how
+ * long an update of all N signals takes each way. Build and run it with
+ * "make -C Tools benchmark".
+ *
+ * The signals are sine waves of different phases with Gaussian noise,
+ * sampled every kDrivePeriod with up to 2 ms of jitter. Each timing is the
+ * best of kRuns runs over the same readings. The outputs of the bank are
+ * also checked against the separate filters, and the program exits with a
+ * failure if they differ by more than kTolerance. The timings are for the
+ * host, not the cRIO, so only compare them with each other. This file is
+ * not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+typedef unsigned int UINT32;
+using namespace std;
+
+#include "../Robotmap.h"
+#include "../Classes/AlphaBetaFilter.h"
+#include "../Classes/AlphaBetaFilterBank.h"
+
+namespace
+{
+	const unsigned kUpdates = 100000;		//!< Number of readings of every signal per run
+	const unsigned kRuns = 5;				//!< Runs of each filter, the fastest is reported
+	const double kAmplitude = 24.0;			//!< Amplitude of the true signals
+	const double kFrequency = 0.5;			//!< Frequency of the true signals in Hz
+	const double kNoise = 0.5;				//!< Standard deviation of the measurement noise
+	const double kJitter = 2000.0;			//!< Largest sample time jitter in microseconds
+	const double kTolerance = 1e-3;			//!< Largest difference between the bank and the filters
+	const float kAlpha = 0.5f;
+	const float kBeta = 0.1f;
+
+	//! Returns a normally distributed random number
+	double Gaussian()
+	{
+		const double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		const double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+	}
+
+	//! Returns the host time in microseconds
+	double Now()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec * 1e6 + tv.tv_usec;
+	}
+
+	//! Creates the reading times, and the readings of every signal stored
+	//! a reading time at a time
+	void MakeReadings(unsigned signals, vector<UINT32>& times, vector<float>& readings)
+	{
+		times.resize(kUpdates);
+		readings.resize(kUpdates * signals);
+		double time = 0;
+		for (unsigned i = 0; i < kUpdates; ++i)
+		{
+			time += kDrivePeriod * 1e6 + kJitter * (rand() / (RAND_MAX + 1.0) - 0.5);
+			times[i] = static_cast<UINT32>(time);
+			for (unsigned j = 0; j < signals; ++j)
+			{
+				const double phase = 2.0 * M_PI * j / signals;
+				readings[i * signals + j] = static_cast<float>(
+					kAmplitude * sin(2.0 * M_PI * kFrequency * times[i] * 1e-6 + phase) + kNoise * Gaussian());
+			}
+		}
+	}
+
+	//! Filters the readings with separate filters, returning the time in
+	//! microseconds and adding the outputs to checksum
+	template <unsigned N>
+	double RunFilters(const vector<UINT32>& times, const vector<float>& readings, float* outputs, double& checksum)
+	{
+		AlphaBetaFilter<float> filters[N];
+		for (unsigned j = 0; j < N; ++j)
+		{
+			filters[j].SetCorrectionGains(kAlpha, kBeta);
+		}
+		const double start = Now();
+		for (unsigned i = 0; i < kUpdates; ++i)
+		{
+			const float* const reading = &readings[i * N];
+			for (unsigned j = 0; j < N; ++j)
+			{
+				checksum += filters[j].Update(reading[j], times[i]);
+			}
+		}
+		const double elapsed = Now() - start;
+		for (unsigned j = 0; j < N; ++j)
+		{
+			outputs[j] = filters[j].GetValue();
+		}
+		return elapsed;
+	}
+
+	//! Filters the readings with a filter bank, returning the time in
+	//! microseconds and adding the outputs to checksum
+	template <unsigned N>
+	double RunBank(const vector<UINT32>& times, const vector<float>& readings, float* outputs, double& checksum)
+	{
+		AlphaBetaFilterBank<float, N> bank(kAlpha, kBeta);
+		const double start = Now();
+		for (unsigned i = 0; i < kUpdates; ++i)
+		{
+			const float* const values = bank.Update(&readings[i * N], times[i]);
+			for (unsigned j = 0; j < N; ++j)
+			{
+				checksum += values[j];
+			}
+		}
+		const double elapsed = Now() - start;
+		const float* const values = bank.GetValues();
+		for (unsigned j = 0; j < N; ++j)
+		{
+			outputs[j] = values[j];
+		}
+		return elapsed;
+	}
+
+	//! Times both ways of filtering N signals and prints the results.
+	//! Returns false if the bank does not agree with the separate filters.
+	template <unsigned N>
+	bool Compare()
+	{
+		vector<UINT32> times;
+		vector<float> readings;
+		MakeReadings(N, times, readings);
+
+		float filterOutputs[N];
+		float bankOutputs[N];
+		double filterChecksum = 0;
+		double bankChecksum = 0;
+		double filterTime = 0;
+		double bankTime = 0;
+		for (unsigned run = 0; run < kRuns; ++run)
+		{
+			const double filters = RunFilters<N>(times, readings, filterOutputs, filterChecksum);
+			const double bank = RunBank<N>(times, readings, bankOutputs, bankChecksum);
+			filterTime = (run == 0 || filters < filterTime) ? filters : filterTime;
+			bankTime = (run == 0 || bank < bankTime) ? bank : bankTime;
+		}
+
+		double maxDifference = 0;
+		for (unsigned j = 0; j < N; ++j)
+		{
+			maxDifference = max(maxDifference, fabs(static_cast<double>(filterOutputs[j] - bankOutputs[j])));
+		}
+		// The checksums add up every output of every run, so also check
+		// the mean difference over all of the outputs
+		maxDifference = max(maxDifference, fabs(filterChecksum - bankChecksum) / (kRuns * kUpdates * N));
+		printf("%4u %14.1f %14.1f %8.2f %12.2g   (%g)\n", N,
+			filterTime * 1000.0 / kUpdates, bankTime * 1000.0 / kUpdates,
+			filterTime / bankTime, maxDifference, filterChecksum);
+		return maxDifference <= kTolerance;
+	}
+}
+
+int main()
+{
+	srand(1);
+	printf("%4s %14s %14s %8s %12s\n", "N", "Filters (ns)", "Bank (ns)", "Speedup", "Difference");
+	bool agree = Compare<4>();
+	agree = Compare<16>() && agree;
+	agree = Compare<64>() && agree;
+	if (agree == false)
+	{
+		printf("FAILED: the filter bank does not agree with the separate filters\n");
+		return 1;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * FilterBenchmark.cpp
+ *
+ * Host side benchmark that runs KalmanFilter and AlphaBetaFilter over the
+ * same synthetic sensor data and prints how well each tracks the true
+ * value and rate of change, and how long an update takes. Build and run
+ * it on the host with:
+ *
+ *     g++ -O2 -o FilterBenchmark Tools/FilterBenchmark.cpp
+ *     ./FilterBenchmark
+ *
+ * The signal is a sine wave sampled every kDrivePeriod with up to 2 ms of
+ * jitter and Gaussian noise added, like a noisy encoder read by the drive
+ * loop. The timings are for the host, not the cRIO, so only compare them
+ * with each other. This file is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+typedef unsigned int UINT32;
+using namespace std;
+
+#include "../Robotmap.h"
+#include "../Classes/AlphaBetaFilter.h"
+#include "../Classes/KalmanFilter.h"
+
+namespace
+{
+	const unsigned kSamples = 200000;		//!< Number of readings per run
+	const double kAmplitude = 24.0;			//!< Amplitude of the true signal
+	const double kFrequency = 0.5;			//!< Frequency of the true signal in Hz
+	const double kNoise = 0.5;				//!< Standard deviation of the measurement noise
+	const double kJitter = 2000.0;			//!< Largest sample time jitter in microseconds
+
+	//! One synthetic reading along with the true state
+	struct Sample
+	{
+		UINT32 m_time;
+		double m_measured;
+		double m_value;
+		double m_rate;
+	};
+
+	//! Returns a normally distributed random number
+	double Gaussian()
+	{
+		const double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		const double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+	}
+
+	//! Returns the host time in microseconds
+	double Now()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec * 1e6 + tv.tv_usec;
+	}
+
+	//! Creates the synthetic readings
+	void MakeSamples(vector<Sample>& samples)
+	{
+		samples.resize(kSamples);
+		double time = 0;
+		for (unsigned i = 0; i < kSamples; ++i)
+		{
+			time += kDrivePeriod * 1e6 + kJitter * (rand() / (RAND_MAX + 1.0) - 0.5);
+			const double w = 2.0 * M_PI * kFrequency;
+			Sample& sample = samples[i];
+			sample.m_time = static_cast<UINT32>(time);
+			sample.m_value = kAmplitude * sin(w * sample.m_time * 1e-6);
+			sample.m_rate = kAmplitude * w * cos(w * sample.m_time * 1e-6);
+			sample.m_measured = sample.m_value + kNoise * Gaussian();
+		}
+	}
+
+	//! Runs a filter over the samples and prints the results
+	template <typename Filter>
+	void Run(const char* name, Filter& filter, const vector<Sample>& samples)
+	{
+		// The first second lets the filter settle
+		const unsigned settle = static_cast<unsigned>(1.0 / kDrivePeriod);
+		double valueError = 0;
+		double rateError = 0;
+		double checksum = 0;
+		const double start = Now();
+		for (unsigned i = 0; i < samples.size(); ++i)
+		{
+			const Sample& sample = samples[i];
+			checksum += filter.Update(static_cast<float>(sample.m_measured), sample.m_time);
+			if (i >= settle)
+			{
+				const double dv = filter.GetValue() - sample.m_value;
+				const double dr = filter.GetRateOfChange() - sample.m_rate;
+				valueError += dv * dv;
+				rateError += dr * dr;
+			}
+		}
+		const double elapsed = Now() - start;
+		const unsigned count = samples.size() - settle;
+		printf("%-28s %10.4f %10.4f %10.1f   (%g)\n", name,
+			sqrt(valueError / count), sqrt(rateError / count),
+			elapsed * 1000.0 / samples.size(), checksum);
+	}
+
+	//! Checks that draining the history twice writes one header line
+	bool CheckSingleHeader()
+	{
+		ConstantVelocityKalmanFilter<float> filter(100.0f, kNoise * kNoise);
+		filter.EnableLogging();
+		ostringstream os;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			filter.Update(static_cast<float>(i), i * 20000);
+			if (i % 2 == 1)
+			{
+				filter.WriteLog(os);
+			}
+		}
+		const string log = os.str();
+		unsigned headers = 0;
+		for (string::size_type pos = log.find("Raw,"); pos != string::npos; pos = log.find("Raw,", pos + 1))
+		{
+			++headers;
+		}
+		return headers == 1;
+	}
+}
+
+int main()
+{
+	srand(1);
+	vector<Sample> samples;
+	MakeSamples(samples);
+
+	printf("Measurement noise %.2f, sample period %.0f ms +/- %.0f ms\n\n",
+		kNoise, kDrivePeriod * 1000, kJitter / 2000);
+	printf("%-28s %10s %10s %10s\n", "Filter", "RMS value", "RMS rate", "ns/update");
+
+	AlphaBetaFilter<float> alphaBeta(0.5f, 0.1f);
+	Run("AlphaBetaFilter 0.5/0.1", alphaBeta, samples);
+
+	AlphaBetaFilter<float> alphaBetaSlow(0.2f, 0.02f);
+	Run("AlphaBetaFilter 0.2/0.02", alphaBetaSlow, samples);
+
+	// The process noise is tuned for the signal, which accelerates at up
+	// to 240 per second squared
+	ConstantVelocityKalmanFilter<float> velocity(1e5f, kNoise * kNoise);
+	Run("Kalman constant velocity", velocity, samples);
+
+	ConstantAccelerationKalmanFilter<float> acceleration(1e6f, kNoise * kNoise);
+	Run("Kalman constant accel", acceleration, samples);
+
+	printf("\nFilter sizes without logging: AlphaBetaFilter %u, Kalman velocity %u, Kalman accel %u bytes\n",
+		static_cast<unsigned>(sizeof(alphaBeta)), static_cast<unsigned>(sizeof(velocity)),
+		static_cast<unsigned>(sizeof(acceleration)));
+
+	if (CheckSingleHeader() == false)
+	{
+		printf("FAILED: the log header was written more than once\n");
+		return 1;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * FixedPointFilterTest.cpp
+ *
+ * Host side test that runs the fixed point AlphaBetaFilter and
+ * AlphaBetaFilter<double> over the same 12 bit readings and checks that
+ * they agree within the tolerances documented in
+ * FixedPointAlphaBetaFilter.h. Build and run it with
+ * "make -C Tools check".
+ *
+ * The readings are a sine wave with noise, sampled at exactly the nominal
+ * period and then with the period jittering by up to 25%. A last check
+ * leaves a gap of several seconds in the readings, which must not make
+ * the fixed point prediction overflow. The program exits with a failure
+ * if any check fails. This file is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int INT32;
+typedef unsigned int UINT32;
+typedef long long INT64;
+using namespace std;
+
+#include "../Classes/FixedPointAlphaBetaFilter.h"
+
+namespace
+{
+	typedef AlphaBetaFilter<FixedPointQ16> FixedPointFilter;
+
+	const unsigned kSamples = 20000;		//!< Number of readings per run
+	const UINT32 kPeriod = 20000;			//!< Nominal sample period in microseconds
+	const double kCentre = 2048.0;			//!< Middle of the 12 bit range
+	const double kAmplitude = 1500.0;		//!< Amplitude of the true signal in counts
+	const double kFrequency = 0.5;			//!< Frequency of the true signal in Hz
+	const double kNoise = 4.0;				//!< Standard deviation of the noise in counts
+	const double kAlpha = 0.5;
+	const double kBeta = 0.1;
+
+	int s_failures = 0;
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", description);
+			++s_failures;
+		}
+	}
+
+	//! Returns a normally distributed random number
+	double Gaussian()
+	{
+		const double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		const double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+		return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+	}
+
+	//! Returns a 12 bit reading of the signal at a time in microseconds
+	INT32 Reading(UINT32 time)
+	{
+		const double value = kCentre + kAmplitude * sin(2.0 * M_PI * kFrequency * time * 1e-6) + kNoise * Gaussian();
+		return static_cast<INT32>(floor(value + 0.5));
+	}
+
+	//! Runs both filters over the readings with a period jitter, as a
+	//! fraction of the period, and checks the largest differences
+	void Compare(const char* name, double jitter, double valueTolerance, double rateTolerance)
+	{
+		// Both filters use exactly the same gains
+		const INT32 alpha = FixedPointQ16::FromFloat(kAlpha);
+		const INT32 beta = FixedPointQ16::FromFloat(kBeta);
+		FixedPointFilter fixedPoint(alpha, beta, kPeriod);
+		AlphaBetaFilter<double> reference(alpha / 65536.0, beta / 65536.0);
+
+		const double peakRate = kAmplitude * 2.0 * M_PI * kFrequency;
+		double valueError = 0;
+		double rateError = 0;
+		UINT32 time = 0;
+		for (unsigned i = 0; i < kSamples; ++i)
+		{
+			time += static_cast<UINT32>(kPeriod * (1.0 + jitter * (2.0 * rand() / RAND_MAX - 1.0)));
+			const INT32 reading = Reading(time);
+			fixedPoint.Update(reading, time);
+			reference.Update(reading, time);
+			valueError = max(valueError, fabs(fixedPoint.GetValue() / 65536.0 - reference.GetValue()));
+			rateError = max(rateError, fabs(fixedPoint.GetRateOfChange() / 65536.0 - reference.GetRateOfChange()));
+		}
+		printf("%-24s %12.4f %12.4f%%\n", name, valueError, rateError * 100.0 / peakRate);
+
+		char description[80];
+		sprintf(description, "%s: the value is more than %g counts out", name, valueTolerance);
+		Check(valueError <= valueTolerance, description);
+		sprintf(description, "%s: the rate is more than %g%% of its peak out", name, rateTolerance * 100.0);
+		Check(rateError <= rateTolerance * peakRate, description);
+	}
+
+	//! Checks that a gap in the readings does not overflow the prediction
+	void CheckGap()
+	{
+		FixedPointFilter filter(FixedPointQ16::FromFloat(kAlpha), FixedPointQ16::FromFloat(kBeta), kPeriod);
+		// A steep ramp up to the top of the range, then a 10 s gap
+		UINT32 time = 0;
+		for (unsigned i = 0; i < 50; ++i)
+		{
+			time += kPeriod;
+			filter.Update(i * 80, time);
+		}
+		time += 10000000;
+		const INT32 value = FixedPointQ16::ToInteger(filter.Update(4000, time));
+		printf("After a 10 s gap the value is %d\n", value);
+		// With the gap treated as kMaxPeriods periods the prediction is
+		// about 4000 + 16 * 80, and never negative
+		Check(value > 4000 && value < 4000 + 80 * static_cast<INT32>(FixedPointFilter::kMaxPeriods),
+			"a gap in the readings overflows the prediction");
+	}
+}
+
+int main()
+{
+	srand(1);
+	printf("%-24s %12s %13s\n", "Sample period", "Value error", "Rate error");
+	// The tolerances documented in FixedPointAlphaBetaFilter.h
+	Compare("Exact", 0.0, 0.001, 0.0001);
+	Compare("Jitter 25%", 0.25, 0.15, 0.006);
+	CheckGap();
+
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
+
+#endif
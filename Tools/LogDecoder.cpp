@@ -0,0 +1,208 @@
+/*
+ * LogDecoder.cpp
+ *
+ * Host side tool that converts a binary logfile written by LogSystem in
+ * kLogFormatBinary mode, log#####.bin in the log directory, back into the
+ * text format of the log#####.txt files, or into CSV. Build it on the host
+ * with:
+ *
+ *     g++ -o LogDecoder Tools/LogDecoder.cpp
+ *
+ * Usage:
+ *
+ *     LogDecoder [--csv] log00042.bin [output]
+ *
+ * The output is written to stdout when no output file is given. This file
+ * is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include "../Classes/BinaryLogFormat.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const priorityNames[] = { "", "System", "Debug", "Error" };
+
+	//! Reverses the byte order of a 32 bit value
+	unsigned int Swap(unsigned int value)
+	{
+		return ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) |
+			((value & 0x00FF0000) >> 8) | ((value & 0xFF000000) >> 24);
+	}
+
+	//! Reverses the byte order of a 16 bit value
+	unsigned short Swap(unsigned short value)
+	{
+		return static_cast<unsigned short> ((value << 8) | (value >> 8));
+	}
+
+	//! Returns the name of a log priority
+	const char* PriorityName(unsigned priority)
+	{
+		return priority < sizeof (priorityNames) / sizeof (priorityNames[0]) ?
+			priorityNames[priority] : "";
+	}
+
+	//! Writes a CSV field, quoting it as required
+	void WriteCsvText(FILE* out, const std::string& text)
+	{
+		fputc('"', out);
+		for (std::string::const_iterator i = text.begin(); i != text.end(); ++i)
+		{
+			if (*i == '"') fputc('"', out);
+			fputc(*i, out);
+		}
+		fputc('"', out);
+	}
+
+	//! Writes a single decoded message in the requested format
+	void WriteMessage(FILE* out, bool csv, unsigned time, unsigned priority,
+		const std::string& text, bool hasValue, float value)
+	{
+		if (csv)
+		{
+			fprintf(out, "%u,%s,", time, PriorityName(priority));
+			WriteCsvText(out, text);
+			if (hasValue) fprintf(out, ",%f", static_cast<double> (value));
+			fputc('\n', out);
+		}
+		else if (hasValue)
+		{
+			fprintf(out, "%u:  %s %f\n", time, text.c_str(), static_cast<double> (value));
+		}
+		else
+		{
+			fprintf(out, "%u:  %s\n", time, text.c_str());
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool csv = false;
+	int arg = 1;
+	if (arg < argc && strcmp(argv[arg], "--csv") == 0)
+	{
+		csv = true;
+		++arg;
+	}
+	if (arg >= argc)
+	{
+		fprintf(stderr, "Usage: %s [--csv] log#####.bin [output]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* in = fopen(argv[arg], "rb");
+	if (in == NULL)
+	{
+		fprintf(stderr, "Unable to open %s\n", argv[arg]);
+		return 1;
+	}
+	FILE* out = (arg + 1 < argc) ? fopen(argv[arg + 1], "w") : stdout;
+	if (out == NULL)
+	{
+		fprintf(stderr, "Unable to create %s\n", argv[arg + 1]);
+		return 1;
+	}
+
+	BinaryLogHeader header;
+	if (fread(&header, sizeof (header), 1, in) != 1)
+	{
+		fprintf(stderr, "%s is too short to be a binary log\n", argv[arg]);
+		return 1;
+	}
+	const bool swap = header.m_byteOrder != kBinaryLogByteOrder;
+	if (swap)
+	{
+		header.m_magic = Swap(header.m_magic);
+		header.m_version = Swap(header.m_version);
+		header.m_recordSize = Swap(header.m_recordSize);
+	}
+	if (header.m_magic != kBinaryLogMagic || header.m_version != kBinaryLogVersion ||
+		header.m_recordSize != sizeof (BinaryLogRecord))
+	{
+		fprintf(stderr, "%s is not a version %u binary log\n", argv[arg], kBinaryLogVersion);
+		return 1;
+	}
+
+	if (csv)
+	{
+		fprintf(out, "Time,Priority,Message,Value\n");
+	}
+
+	// Message IDs restart on every boot, but each boot defines its IDs
+	// before it uses them so redefinitions simply replace the old text
+	std::vector<std::string> messages;
+	BinaryLogRecord record;
+	std::vector<char> text;
+	while (fread(&record, sizeof (record), 1, in) == 1)
+	{
+		if (swap)
+		{
+			record.m_time = Swap(record.m_time);
+			record.m_messageId = Swap(record.m_messageId);
+			record.m_length = Swap(record.m_length);
+		}
+
+		const std::string* message = NULL;
+		if (record.m_messageId < messages.size())
+		{
+			message = &messages[record.m_messageId];
+		}
+
+		switch (record.m_type)
+		{
+		case kBinaryLogString:
+		case kBinaryLogText:
+			text.resize(record.m_length);
+			if (record.m_length > 0 && fread(&text[0], 1, record.m_length, in) != record.m_length)
+			{
+				fprintf(stderr, "Truncated record at time %u\n", record.m_time);
+				return 1;
+			}
+			if (record.m_type == kBinaryLogString)
+			{
+				if (record.m_messageId >= messages.size())
+				{
+					messages.resize(record.m_messageId + 1);
+				}
+				messages[record.m_messageId].assign(text.begin(), text.end());
+			}
+			else
+			{
+				WriteMessage(out, csv, record.m_time, record.m_priority,
+					std::string(text.begin(), text.end()), false, 0);
+			}
+			break;
+		case kBinaryLogMessage:
+		case kBinaryLogValue:
+			WriteMessage(out, csv, record.m_time, record.m_priority,
+				message != NULL ? *message : std::string("<undefined message>"),
+				record.m_type == kBinaryLogValue, record.m_value);
+			break;
+		case kBinaryLogDropped:
+		{
+			char buffer[64];
+			sprintf(buffer, "%u log messages dropped.", record.m_length);
+			WriteMessage(out, csv, record.m_time, record.m_priority, buffer, false, 0);
+			break;
+		}
+		default:
+			fprintf(stderr, "Unknown record type %u at time %u\n", record.m_type, record.m_time);
+			return 1;
+		}
+	}
+
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	fclose(in);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,231 @@
+/*
+ * CANWriteTest.cpp
+ *
+ * Tests the CAN traffic of RampedCANJaguar on the simulated bus in this
+ * directory. Build and run it with "make -C Tools check".
+ *
+ * A RampedCANJaguar is driven for a few packets at a time, and the
+ * messages the simulated Jaguars receive are compared with what it is
+ * meant to send: an unchanged setpoint is only resent every
+ * kCANRefreshPeriod, a change within kCANWriteTolerance is not sent, a
+ * setpoint is always sent after the Jaguar is disabled, setpoints in a
+ * sync group are applied by one broadcast, and the status polls only read
+ * the voltage, current and temperature of the Jaguar once every
+ * kCANElectricalPollPeriod. RampedCANJaguar::GetMessageCount must always
+ * agree with the messages the bus actually carried. The program exits with a
+ * failure if any check fails. This file is not part of the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include "../../Classes/RampedCANJaguar.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+	const UINT8 kTestJaguar = 2;
+	const UINT8 kTestSyncGroup = 1;
+	//! Packets needed for an unchanged setpoint to be resent
+	const int kRefreshPackets = static_cast<int>(kCANRefreshPeriod * 1e6 / Simulation::kPacketPeriod + 0.5);
+
+	//! The steps of the test, each run for one or more packets
+	enum Step
+	{
+		kFirstWrite,
+		kUnchanged,
+		kSmallChange,
+		kLargeChange,
+		kDisable,
+		kSyncGroup,
+		kTotals,
+		kSteps
+	};
+
+	int s_failures = 0;
+	bool s_done = false;
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", description);
+			++s_failures;
+		}
+	}
+
+	//! Counts of the messages sent so far, by the bus and by RampedCANJaguar
+	struct Counts
+	{
+		UINT32 m_bus;
+		UINT32 m_jaguar;
+		UINT32 m_counted;
+		UINT32 m_writes;
+		UINT32 m_suppressed;
+
+		static Counts Now()
+		{
+			Counts counts;
+			counts.m_bus = Simulation::GetCANMessageCount();
+			counts.m_jaguar = Simulation::GetCANMessageCount(kTestJaguar);
+			counts.m_counted = RampedCANJaguar::GetMessageCount();
+			counts.m_writes = RampedCANJaguar::GetWriteCount();
+			counts.m_suppressed = RampedCANJaguar::GetSuppressedCount();
+			return counts;
+		}
+	};
+
+	//! Keeps the robot enabled in teleop until the test is done
+	bool Script(UINT32 time)
+	{
+		Simulation::SetEnabled(true);
+		Simulation::SetAutonomous(false);
+		return !s_done;
+	}
+}
+
+/**
+ * @brief Runs the steps of the test in TeleopPeriodic, one or more
+ * packets each.
+ */
+class CANWriteTestRobot : public IterativeRobot
+{
+public:
+	CANWriteTestRobot() :
+		m_jaguar(NULL),
+		m_step(kFirstWrite),
+		m_stepPacket(0),
+		m_packets(0),
+		m_disables(0)
+	{
+	}
+
+	virtual void TeleopInit()
+	{
+		// A ramp of 1 sends each output as it is
+		m_jaguar = new RampedCANJaguar(kTestJaguar, 1.0, 1.0, 0.0, 0.0);
+		m_start = Counts::Now();
+	}
+
+	virtual void TeleopPeriodic()
+	{
+		const Counts before = Counts::Now();
+		switch (m_step)
+		{
+			case kFirstWrite:
+				m_jaguar->SetOutput(0.5);
+				Check(Counts::Now().m_writes == before.m_writes + 1, "the first setpoint is not sent");
+				Check(fabs(Simulation::GetJaguarOutput(kTestJaguar) - 0.5) < 1e-6, "the first setpoint is not applied");
+				NextStep();
+				break;
+			case kUnchanged:
+			{
+				// Resent only when kCANRefreshPeriod has passed since the last write
+				m_jaguar->SetOutput(0.5);
+				const Counts after = Counts::Now();
+				if (m_stepPacket < kRefreshPackets - 1)
+				{
+					Check(after.m_writes == before.m_writes, "an unchanged setpoint is sent before the refresh period");
+					Check(after.m_suppressed == before.m_suppressed + 1, "a suppressed setpoint is not counted");
+				}
+				else
+				{
+					Check(after.m_writes == before.m_writes + 1, "an unchanged setpoint is not resent after the refresh period");
+					NextStep();
+				}
+				break;
+			}
+			case kSmallChange:
+				m_jaguar->SetOutput(0.5 + kCANWriteTolerance * 0.5);
+				Check(Counts::Now().m_writes == before.m_writes, "a change within kCANWriteTolerance is sent");
+				NextStep();
+				break;
+			case kLargeChange:
+				m_jaguar->SetOutput(0.6);
+				Check(Counts::Now().m_writes == before.m_writes + 1, "a changed setpoint is not sent");
+				Check(fabs(Simulation::GetJaguarOutput(kTestJaguar) - 0.6) < 1e-6, "a changed setpoint is not applied");
+				NextStep();
+				break;
+			case kDisable:
+				// RobotDrive::StopMotor disables the Jaguar, which forgets its
+				// setpoint, so the same setpoint must be sent again at once
+				m_jaguar->Disable();
+				++m_disables;
+				Check(Simulation::GetJaguarOutput(kTestJaguar) == 0.0, "disabling does not stop the motor");
+				m_jaguar->SetOutput(0.6);
+				Check(Counts::Now().m_writes == before.m_writes + 1, "the setpoint before a disable is not resent after it");
+				Check(fabs(Simulation::GetJaguarOutput(kTestJaguar) - 0.6) < 1e-6, "the setpoint is not applied after a disable");
+				NextStep();
+				break;
+			case kSyncGroup:
+				// The setpoint waits in the Jaguar until the group is updated
+				m_jaguar->SetSyncGroup(kTestSyncGroup);
+				m_jaguar->SetOutput(0.7);
+				Check(Counts::Now().m_writes == before.m_writes + 1, "a setpoint in a sync group is not sent");
+				Check(fabs(Simulation::GetJaguarOutput(kTestJaguar) - 0.6) < 1e-6, "a setpoint in a sync group is applied before the update");
+				RampedCANJaguar::UpdateSyncGroup(kTestSyncGroup);
+				{
+					const Counts after = Counts::Now();
+					Check(after.m_bus == before.m_bus + 2 && after.m_counted == before.m_counted + 2,
+						"a sync group update is not one message");
+				}
+				Check(fabs(Simulation::GetJaguarOutput(kTestJaguar) - 0.7) < 1e-6, "the sync group update does not apply the setpoint");
+				NextStep();
+				break;
+			case kTotals:
+			{
+				// Only the status poller has used the bus since the start
+				const Counts end = Counts::Now();
+				const UINT32 writes = end.m_writes - m_start.m_writes;
+				const UINT32 statusRequests = (end.m_jaguar - m_start.m_jaguar) - writes - m_disables;
+				Check(end.m_counted - m_start.m_counted == end.m_bus - m_start.m_bus,
+					"RampedCANJaguar::GetMessageCount does not match the messages on the bus");
+				// The test is shorter than kCANElectricalPollPeriod, so only
+				// the first poll reads the voltage, current and temperature
+				Check(statusRequests > kJaguarElectricalRequests
+					&& (statusRequests - kJaguarElectricalRequests) % kJaguarMotionRequests == 0,
+					"the status polls do not read the voltage, current and temperature once and the motion every time");
+				Check(m_jaguar->GetStatus().m_time != 0, "the status poller never read the Jaguar");
+				printf("%u setpoints sent, %u suppressed, %u status requests, %u messages in %.2f s\n",
+					writes, end.m_suppressed - m_start.m_suppressed, statusRequests,
+					end.m_bus - m_start.m_bus, m_packets * Simulation::kPacketPeriod * 1e-6);
+				NextStep();
+				break;
+			}
+			default:
+				s_done = true;
+				break;
+		}
+		++m_stepPacket;
+		++m_packets;
+	}
+
+private:
+	//! Moves on to the next step of the test
+	void NextStep()
+	{
+		m_step = static_cast<Step>(m_step + 1);
+		m_stepPacket = -1;
+	}
+
+	RampedCANJaguar* m_jaguar;
+	Step m_step;
+	int m_stepPacket;		//!< Packets since the step started
+	int m_packets;			//!< Packets since the test started
+	UINT32 m_disables;		//!< Disable messages sent by the test
+	Counts m_start;
+};
+
+START_ROBOT_CLASS(CANWriteTestRobot);
+
+int main()
+{
+	Simulation::Run(Script);
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,6 @@
+/*
+ * Command.h
+ *
+ * See WPILib.h. This file is not part of the robot build.
+ */
+#include "../WPILib.h"
@@ -0,0 +1,197 @@
+/*
+ * LogBenchmark.cpp
+ *
+ * Measures what a call to LogSystem costs the task that logs, against the
+ * blocking logger LogSystem used to be, which printed each message and
+ * opened, appended to and closed the logfile on the caller's task. Build
+ * and run it with "make -C Tools benchmark".
+ *
+ * Both loggers are driven on the simulated clock by a 50 Hz teleop loop,
+ * logging the messages the drive loop logs every cycle, and by a task
+ * logging a line built with sprintf for every frame of a 30 frame per
+ * second camera. Every message is logged through both loggers and each
+ * call is timed on the host. The LogSystem writer task runs when the
+ * logging tasks are waiting, as on the cRIO, so its writes are not in
+ * the times. The console of both loggers goes to the file given as the
+ * first argument, or to /dev/null. The timings are for the host, not the
+ * cRIO, so only compare them with each other. This file is not part of
+ * the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include "../../Subsystems/LogSystem.h"
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	//! Simulated time the loggers are run for, in seconds
+	const double kRunTime = 60.0;
+	//! Clock ticks between camera frames, 30 frames per second
+	const int kFramePeriod = 33;
+	//! The logfile of the blocking logger
+	const char* const kBlockingLogFile = LOG_DIRECTORY "/LogBenchmark.txt";
+
+	/**
+	 * @brief The logger as it was before LogSystem had a writer task,
+	 * which did the IO for every message on the caller's task.
+	 */
+	class BlockingLog
+	{
+	public:
+		void LogMessage(const char* message)
+		{
+			printf("%i:  %s\n", GetFPGATime(), message);
+			FILE* logFile = fopen(kBlockingLogFile, "a");
+			fprintf(logFile, "%i:  %s\n", GetFPGATime(), message);
+			fclose(logFile);
+		}
+	};
+
+	//! The cost of the calls from one task to one logger
+	struct CallTimes
+	{
+		UINT32 m_count;
+		double m_total;			//!< Host time in the calls, in seconds
+		double m_max;			//!< Longest call, in seconds
+	};
+
+	enum Logger
+	{
+		kBlocking,
+		kLogSystem,
+		kLoggers
+	};
+
+	enum Source
+	{
+		kDriveLoop,
+		kCameraTask,
+		kSources
+	};
+
+	LogSystem* s_log = NULL;
+	BlockingLog s_blockingLog;
+	CallTimes s_times[kLoggers][kSources];
+	FILE* s_results = NULL;
+
+	//! Returns the host time in seconds
+	double Now()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+
+	//! Adds the time of a call since start
+	void Record(Logger logger, Source source, double start)
+	{
+		const double elapsed = Now() - start;
+		CallTimes& times = s_times[logger][source];
+		++times.m_count;
+		times.m_total += elapsed;
+		if (elapsed > times.m_max)
+		{
+			times.m_max = elapsed;
+		}
+	}
+
+	//! Logs a string literal through both loggers
+	void LogMessage(Source source, const char* message, LogPriority level)
+	{
+		double start = Now();
+		s_blockingLog.LogMessage(message);
+		Record(kBlocking, source, start);
+		start = Now();
+		s_log->LogMessage(message, level);
+		Record(kLogSystem, source, start);
+	}
+
+	//! Logs text built at run time through both loggers
+	void LogText(Source source, const char* text, LogPriority level)
+	{
+		double start = Now();
+		s_blockingLog.LogMessage(text);
+		Record(kBlocking, source, start);
+		start = Now();
+		s_log->LogText(text, level);
+		Record(kLogSystem, source, start);
+	}
+
+	//! Logs a line for every frame, like a camera processing task
+	void CameraTask()
+	{
+		for (UINT32 frame = 1; ; ++frame)
+		{
+			taskDelay(kFramePeriod);
+			char text[kLogMessageLength];
+			sprintf(text, "Frame %u processed, %d targets.", frame, static_cast<int>(frame % 3));
+			LogText(kCameraTask, text, kLogPriorityDebug);
+		}
+	}
+
+	//! Runs teleop until the end of the run
+	bool Script(UINT32 time)
+	{
+		Simulation::SetEnabled(true);
+		Simulation::SetAutonomous(false);
+		return time * 1e-6 < kRunTime;
+	}
+}
+
+/**
+ * @brief Logs the drive loop's messages every teleop cycle.
+ */
+class LogBenchmarkRobot : public IterativeRobot
+{
+public:
+	LogBenchmarkRobot() :
+		m_cameraTask("Camera", (FUNCPTR)CameraTask, Task::kDefaultPriority + 10)
+	{
+	}
+
+	virtual void TeleopInit()
+	{
+		s_log = new LogSystem(kLogPrioritySystem);
+		m_cameraTask.Start();
+	}
+
+	virtual void TeleopPeriodic()
+	{
+		LogMessage(kDriveLoop, "Entering AdvancedRobotDrive::DriveRobot.", kLogPrioritySystem);
+		LogMessage(kDriveLoop, "Entering TeleopDriveCommand::Execute.", kLogPrioritySystem);
+	}
+
+private:
+	Task m_cameraTask;
+};
+
+START_ROBOT_CLASS(LogBenchmarkRobot);
+
+int main(int argc, char** argv)
+{
+	s_results = fdopen(dup(fileno(stdout)), "w");
+	if (s_results == 0 || freopen((argc > 1) ? argv[1] : "/dev/null", "w", stdout) == 0)
+	{
+		perror("LogBenchmark");
+		return 1;
+	}
+	Simulation::Run(Script);
+	remove(kBlockingLogFile);
+
+	fprintf(s_results, "%-12s %-12s %8s %10s %10s\n", "Logger", "Task", "Calls", "Mean (ns)", "Max (ns)");
+	const char* const loggerNames[] = {"Blocking", "LogSystem"};
+	const char* const sourceNames[] = {"Drive loop", "Camera"};
+	for (int logger = 0; logger < kLoggers; ++logger)
+	{
+		for (int source = 0; source < kSources; ++source)
+		{
+			const CallTimes& times = s_times[logger][source];
+			fprintf(s_results, "%-12s %-12s %8u %10.0f %10.0f\n", loggerNames[logger], sourceNames[source],
+				times.m_count, times.m_count ? times.m_total * 1e9 / times.m_count : 0.0, times.m_max * 1e9);
+		}
+	}
+	fprintf(s_results, "\nLogSystem dropped %u messages\n", s_log->GetDroppedMessageCount());
+	return 0;
+}
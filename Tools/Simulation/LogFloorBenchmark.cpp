@@ -0,0 +1,66 @@
+/*
+ * LogFloorBenchmark.cpp
+ *
+ * Times the teleop loop of the robot code built with the log floor,
+ * LOG_MINIMUM_PRIORITY, at kLogPrioritySystem and at kLogPriorityDebug.
+ * The Makefile links this with the robot code built each way, as
+ * LogFloorBenchmarkSystem and LogFloorBenchmarkDebug. Build and run both
+ * with "make -C Tools benchmark".
+ *
+ * The robot is driven in teleop on the simulated clock with the sticks
+ * swept slowly through forward and turning, and the host time of each
+ * TeleopPeriodic call is measured. With the floor at kLogPrioritySystem
+ * the drive loop logs its kLogPrioritySystem messages every cycle, at
+ * kLogPriorityDebug they are compiled out. The robot's console goes to the
+ * file given as the first argument, or to /dev/null. The timings are for
+ * the host, not the cRIO, so only compare them with each other. This file
+ * is not part of the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace
+{
+	//! Simulated time the robot is driven for, in seconds
+	const double kRunTime = 300.0;
+	//! Period of the stick sweep, in seconds
+	const double kSweepPeriod = 4.0;
+
+	//! The driver stick axes read by FRCXboxJoystick
+	const UINT32 kDriverStick = 1;
+	const UINT32 kLeftYAxis = 2;
+	const UINT32 kRightXAxis = 4;
+
+	//! Drives the robot in teleop with the sticks sweeping
+	bool Script(UINT32 time)
+	{
+		const double seconds = time * 1e-6;
+		const double phase = 2.0 * M_PI * seconds / kSweepPeriod;
+		Simulation::SetEnabled(true);
+		Simulation::SetAutonomous(false);
+		Simulation::SetJoystickAxis(kDriverStick, kLeftYAxis, -sin(phase));
+		Simulation::SetJoystickAxis(kDriverStick, kRightXAxis, cos(phase));
+		return seconds < kRunTime;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FILE* results = fdopen(dup(fileno(stdout)), "w");
+	if (results == 0 || freopen((argc > 1) ? argv[1] : "/dev/null", "w", stdout) == 0)
+	{
+		perror("LogFloorBenchmark");
+		return 1;
+	}
+	Simulation::Run(Script);
+
+	const Simulation::LoopStatistics& statistics = Simulation::GetLoopStatistics(Simulation::kTeleop);
+	fprintf(results, "%8s %12s %12s %12s\n", "Loops", "Min (us)", "Mean (us)", "Max (us)");
+	fprintf(results, "%8u %12.3f %12.3f %12.2f\n", statistics.m_count, statistics.m_minTime * 1e6,
+		statistics.m_count ? statistics.m_totalTime * 1e6 / statistics.m_count : 0.0,
+		statistics.m_maxTime * 1e6);
+	return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * PathFollowerTest.cpp
+ *
+ * Tests PathFollower driving a unicycle model along paths made by
+ * Trajectory::Build. Build and run it with "make -C Tools check".
+ *
+ * Each cycle the follower is given the model's pose and its forward speed
+ * and turn rate are applied for kDrivePeriod, as if the drive followed
+ * them exactly. The paths are a straight line, a right angle and an S
+ * bend, and the straight line is also started off the path, sideways and
+ * at an angle. The follower must finish within twice the time the path is
+ * profiled to take, stop within kEndTolerance of the last waypoint, never
+ * drive faster than kPathMaxVelocity and stay within each path's
+ * tolerance of the lines between the waypoints. A robot started off the
+ * path must be back on it by half way. The program exits with a failure
+ * if any check fails. This file is not part of the robot build.
+ */
+#include "../../Robotmap.h"
+#include "../../Classes/PathFollower.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+	const float kEndTolerance = 3.0;	//!< Inches from the last waypoint
+	const float kOnPathTolerance = 0.5;	//!< Inches from the path, for a robot started off it
+	const int kMaxWaypoints = 4;
+
+	//! A path to follow and where the robot starts relative to it
+	struct Path
+	{
+		const char* m_name;
+		int m_waypointCount;
+		Waypoint m_waypoints[kMaxWaypoints];
+		float m_startY;			//!< Inches to the left of the first waypoint
+		float m_startHeading;	//!< Radians anticlockwise of the first segment
+		float m_pathTolerance;	//!< Largest distance from the path, in inches
+	};
+
+	// A pure pursuit follower cuts corners by up to about half the
+	// lookahead distance, so the paths with corners are given more room
+	const Path kPaths[] =
+	{
+		{"straight", 2, {{0, 0}, {120, 0}}, 0, 0, 0.1},
+		{"offset start", 2, {{0, 0}, {120, 0}}, 6, 0.2, 7},
+		{"right angle", 3, {{0, 0}, {80, 0}, {80, 80}}, 0, 0, kPathLookahead / 2},
+		{"S bend", 4, {{0, 0}, {60, 0}, {60, 60}, {120, 60}}, 0, 0, kPathLookahead / 2},
+	};
+	const int kPathCount = sizeof(kPaths) / sizeof(kPaths[0]);
+
+	int s_failures = 0;
+	Trajectory s_trajectory;
+
+	//! Reports a failed check
+	void Check(bool passed, const char* path, const char* description)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s: %s\n", path, description);
+			++s_failures;
+		}
+	}
+
+	//! Returns the distance from a point to the lines between the waypoints
+	float DistanceFromPath(const Path& path, float x, float y)
+	{
+		float nearest = 1e30;
+		for (int i = 0; i + 1 < path.m_waypointCount; ++i)
+		{
+			const Waypoint& a = path.m_waypoints[i];
+			const Waypoint& b = path.m_waypoints[i + 1];
+			const float dx = b.m_x - a.m_x;
+			const float dy = b.m_y - a.m_y;
+			float t = ((x - a.m_x) * dx + (y - a.m_y) * dy) / (dx * dx + dy * dy);
+			t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+			const float distance = hypot(a.m_x + dx * t - x, a.m_y + dy * t - y);
+			if (distance < nearest)
+			{
+				nearest = distance;
+			}
+		}
+		return nearest;
+	}
+
+	//! Follows a path with the unicycle model, checking it as it goes
+	void Follow(const Path& path)
+	{
+		Check(s_trajectory.Build(path.m_waypoints, path.m_waypointCount, kPathMaxVelocity, kPathMaxAcceleration),
+			path.m_name, "the trajectory does not fit");
+
+		// The time the trajectory is profiled to take, v = ds/dt
+		float profiledTime = 0;
+		for (int i = 1; i < s_trajectory.GetCount(); ++i)
+		{
+			const TrajectoryPoint& a = s_trajectory.GetPoint(i - 1);
+			const TrajectoryPoint& b = s_trajectory.GetPoint(i);
+			profiledTime += 2 * (b.m_distance - a.m_distance) / (a.m_velocity + b.m_velocity);
+		}
+		const int maxCycles = static_cast<int>(2 * profiledTime / kDrivePeriod);
+		const float halfway = s_trajectory.GetPoint(s_trajectory.GetCount() - 1).m_distance / 2;
+
+		PathFollower follower;
+		follower.Start(&s_trajectory);
+		RobotPose pose = {0, 0, path.m_startY, path.m_startHeading};
+		float maxSpeed = 0;
+		float maxDistance = 0;
+		float maxDistanceAfterHalfway = 0;
+		float travelled = 0;
+		int cycles = 0;
+		while (cycles < maxCycles)
+		{
+			float forward;
+			float turnRate;
+			if (follower.Update(pose, forward, turnRate))
+			{
+				break;
+			}
+			pose.m_x += forward * cos(pose.m_heading) * kDrivePeriod;
+			pose.m_y += forward * sin(pose.m_heading) * kDrivePeriod;
+			pose.m_heading += turnRate * kDrivePeriod;
+			travelled += forward * kDrivePeriod;
+			++cycles;
+
+			const float distance = DistanceFromPath(path, pose.m_x, pose.m_y);
+			maxSpeed = (forward > maxSpeed) ? forward : maxSpeed;
+			maxDistance = (distance > maxDistance) ? distance : maxDistance;
+			if (travelled > halfway && distance > maxDistanceAfterHalfway)
+			{
+				maxDistanceAfterHalfway = distance;
+			}
+		}
+
+		const Waypoint& end = path.m_waypoints[path.m_waypointCount - 1];
+		const float endError = hypot(pose.m_x - end.m_x, pose.m_y - end.m_y);
+		printf("%-14s %6.2f s %8.2f in %8.2f in %8.2f in\n", path.m_name, cycles * kDrivePeriod,
+			maxDistance, maxDistanceAfterHalfway, endError);
+		Check(follower.IsFinished(), path.m_name, "the path is not finished in twice the profiled time");
+		Check(endError < kEndTolerance, path.m_name, "the robot does not stop at the last waypoint");
+		Check(maxSpeed <= kPathMaxVelocity + 1e-3, path.m_name, "the robot drives faster than kPathMaxVelocity");
+		Check(maxDistance < path.m_pathTolerance, path.m_name, "the robot strays too far from the path");
+		if (path.m_startY != 0 || path.m_startHeading != 0)
+		{
+			Check(maxDistanceAfterHalfway < kOnPathTolerance, path.m_name, "the robot is off the path after half way");
+		}
+	}
+}
+
+int main()
+{
+	printf("Path           Time      Off path  After half way  End error\n");
+	for (int i = 0; i < kPathCount; ++i)
+	{
+		Follow(kPaths[i]);
+	}
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
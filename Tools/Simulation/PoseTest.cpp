@@ -0,0 +1,193 @@
+/*
+ * PoseTest.cpp
+ *
+ * Tests PoseEstimator on the simulated clock with scripted encoders. Build
+ * and run it with "make -C Tools check".
+ *
+ * The drive motors of a BSBot are given speeds directly, rather than
+ * through their outputs, so the encoders report exactly known movements:
+ * forward, a turn on the spot and forward again. The pose is checked
+ * after each move, once every Jaguar has been polled since the wheels
+ * stopped. The pose is reset before the turn and must read as the origin
+ * straight after the reset. The program exits with a failure if any check
+ * fails. This file is not part of the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include "../../Classes/RampedCANJaguar.h"
+#include "../../Classes/PoseEstimator.h"
+#include "../../Classes/RobotClock.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+	//! Wheel speed while moving, in revolutions per minute
+	const double kWheelSpeed = 60.0;
+	//! Distance a BSBot big wheel travels each revolution, in inches
+	const double kWheelTravel = M_PI * RobotGeometry::BigWheelDiameter();
+	//! Largest position error in inches, and heading error in radians
+	const double kPositionTolerance = 0.1;
+	const double kHeadingTolerance = 0.005;
+
+	const UINT8 kDriveJaguars[kDriveWheels] = {kFrontLeftJaguar, kRearLeftJaguar, kFrontRightJaguar, kRearRightJaguar};
+
+	//! A step of the test, the wheels turn at the step's speeds, as
+	//! multiples of kWheelSpeed forward, for its duration and then stop
+	//! until the pose is checked
+	struct Step
+	{
+		const char* m_name;
+		double m_duration;			//!< Seconds the wheels turn for
+		double m_left;
+		double m_right;
+		bool m_resetBefore;			//!< Reset the pose before the step
+		double m_x;					//!< Expected pose after the step
+		double m_y;
+		double m_heading;
+	};
+
+	//! The heading after turning on the spot for 0.5 s, each big wheel
+	//! travels half a revolution
+	const double kTurn = kWheelTravel / RobotGeometry::WheelTrack();
+	const Step kSteps[] =
+	{
+		{"Forward 2 s", 2.0, 1.0, 1.0, false, 2.0 * kWheelTravel, 0.0, 0.0},
+		{"Turn left 0.5 s", 0.5, -1.0, 1.0, true, 0.0, 0.0, kTurn},
+		{"Forward 1 s", 1.0, 1.0, 1.0, false, kWheelTravel * cos(kTurn), kWheelTravel * sin(kTurn), kTurn},
+	};
+	const int kStepCount = sizeof(kSteps) / sizeof(kSteps[0]);
+	//! Time for every Jaguar to be polled after the wheels stop
+	const double kSettleTime = 0.2;
+
+	int s_failures = 0;
+	bool s_done = false;
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", description);
+			++s_failures;
+		}
+	}
+
+	//! Checks a pose against the expected one
+	void CheckPose(const char* name, const RobotPose& pose, double x, double y, double heading)
+	{
+		printf("%-18s %8.3f %8.3f %8.4f   (%8.3f %8.3f %8.4f)\n", name,
+			pose.m_x, pose.m_y, pose.m_heading, x, y, heading);
+		char description[80];
+		sprintf(description, "the pose after %s is wrong", name);
+		Check(fabs(pose.m_x - x) <= kPositionTolerance && fabs(pose.m_y - y) <= kPositionTolerance &&
+			fabs(pose.m_heading - heading) <= kHeadingTolerance, description);
+	}
+
+	//! Sets the speed of the left and right drive motors, as multiples of
+	//! kWheelSpeed forward. The right motors are inverted.
+	void SetWheelSpeeds(double left, double right)
+	{
+		const double speeds[kDriveWheels] = {left, left, -right, -right};
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			const UINT8 device = kDriveJaguars[i];
+			Simulation::SetJaguarMotion(device, Simulation::GetJaguarPosition(device), speeds[i] * kWheelSpeed);
+		}
+	}
+
+	//! Keeps the robot enabled until the test is done
+	bool Script(UINT32 time)
+	{
+		Simulation::SetEnabled(true);
+		Simulation::SetAutonomous(false);
+		return !s_done;
+	}
+}
+
+/**
+ * @brief Runs the steps of the test in TeleopPeriodic.
+ */
+class PoseTestRobot : public IterativeRobot
+{
+public:
+	PoseTestRobot() :
+		m_estimator(NULL),
+		m_step(0),
+		m_moving(false),
+		m_checkPending(false),
+		m_stepTime(0)
+	{
+	}
+
+	virtual void TeleopInit()
+	{
+		for (int i = 0; i < kDriveWheels; ++i)
+		{
+			m_jaguars[i] = new RampedCANJaguar(kDriveJaguars[i], 1.0, 1.0, 0.0, 0.0);
+		}
+		m_estimator = new PoseEstimator(kBSBotDrive, m_jaguars[kFrontLeftWheel], m_jaguars[kRearLeftWheel],
+			m_jaguars[kFrontRightWheel], m_jaguars[kRearRightWheel]);
+		m_estimator->Start();
+		m_stepTime = RobotClock::GetTime();
+	}
+
+	virtual void TeleopPeriodic()
+	{
+		const double elapsed = (RobotClock::GetTime() - m_stepTime) * 1e-6;
+		if (m_step == kStepCount)
+		{
+			s_done = true;
+			return;
+		}
+		const Step& step = kSteps[m_step];
+		if (!m_moving && elapsed >= kSettleTime)
+		{
+			// The estimator has seen the Jaguars stop, start the step
+			if (step.m_resetBefore)
+			{
+				m_estimator->Reset();
+				CheckPose("Reset", m_estimator->GetPose(), 0.0, 0.0, 0.0);
+			}
+			SetWheelSpeeds(step.m_left, step.m_right);
+			m_moving = true;
+			m_stepTime = RobotClock::GetTime();
+		}
+		else if (m_moving && elapsed >= step.m_duration)
+		{
+			SetWheelSpeeds(0.0, 0.0);
+			m_moving = false;
+			m_stepTime = RobotClock::GetTime();
+			m_checkPending = true;
+		}
+		else if (!m_moving && m_checkPending && elapsed >= kSettleTime * 0.5)
+		{
+			CheckPose(step.m_name, m_estimator->GetPose(), step.m_x, step.m_y, step.m_heading);
+			m_checkPending = false;
+			++m_step;
+		}
+	}
+
+private:
+	RampedCANJaguar* m_jaguars[kDriveWheels];
+	PoseEstimator* m_estimator;
+	int m_step;
+	bool m_moving;
+	bool m_checkPending;
+	UINT32 m_stepTime;
+};
+
+START_ROBOT_CLASS(PoseTestRobot);
+
+int main()
+{
+	printf("%-18s %8s %8s %8s   %s\n", "Step", "X", "Y", "Heading", "(expected)");
+	Simulation::Run(Script);
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * RampTest.cpp
+ *
+ * Tests that the RampedCANJaguar output ramp follows the same curve in
+ * time whatever the period of the loop calling SetOutput. Build and run
+ * it with "make -C Tools check".
+ *
+ * Each run is a task on the simulated clock that steps a Jaguar's output
+ * from 0 to 1 with kDriveRamp, calling SetOutput at a fixed or jittered
+ * period. At every call the output the simulated Jaguar applies is
+ * compared with the curve at kDrivePeriod, 1 - (1 - kDriveRamp)^(n + 1)
+ * after n nominal periods. The change in output between calls, per second,
+ * must also never be steeper than the start of the curve, so jitter in
+ * the period cannot make the motor accelerate harder. The program exits
+ * with a failure if any run is further from the curve than kTolerance or
+ * steeper than kMaxRate. This file is not part of the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include "../../Classes/RampedCANJaguar.h"
+#include "../../Classes/RobotClock.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+	//! Largest difference from the curve, the writes are only sent when
+	//! they change by more than kCANWriteTolerance
+	const double kTolerance = 2.0 * kCANWriteTolerance;
+	//! The slope of the curve at its start, in output per second, which
+	//! is the steepest it gets
+	const double kMaxRate = -log(1.0 - kDriveRamp) / kDrivePeriod;
+	//! How long each run lasts in microseconds
+	const UINT32 kRunTime = 500000;
+	//! Time at which the outputs of the runs are printed, in microseconds
+	const UINT32 kReportTime = 100000;
+
+	//! The delays between the SetOutput calls of a run, in clock ticks,
+	//! repeated until the run ends
+	struct Run
+	{
+		const char* m_name;
+		UINT8 m_deviceNumber;
+		int m_delays[8];
+		int m_delayCount;
+		// Results
+		int m_calls;
+		double m_maxError;
+		double m_maxRate;		//!< The steepest change between calls, per second
+		bool m_tooSteep;		//!< Set if a change was steeper than kMaxRate allows
+		double m_reportOutput;
+		double m_reportExpected;
+		bool m_done;
+	};
+
+	Run s_runs[] =
+	{
+		{"5 ms", 10, {5}, 1},
+		{"10 ms", 11, {10}, 1},
+		{"20 ms", 12, {20}, 1},
+		{"50 ms", 13, {50}, 1},
+		{"20 ms +/- 10 ms", 14, {15, 25, 18, 30, 22, 10, 20, 20}, 8},
+	};
+	const int kRunCount = sizeof(s_runs) / sizeof(s_runs[0]);
+
+	//! Returns the output expected at a time after the first SetOutput
+	double Expected(UINT32 elapsed)
+	{
+		return 1.0 - pow(1.0 - kDriveRamp, elapsed * 1e-6 / kDrivePeriod + 1.0);
+	}
+
+	//! Steps a Jaguar's output from 0 to 1 at the periods of a run
+	void RunTask(int index)
+	{
+		Run& run = s_runs[index];
+		// The simulated clock starts at 0, which RampedCANJaguar takes to
+		// mean that SetOutput has not been called before
+		taskDelay(1);
+		RampedCANJaguar jaguar(run.m_deviceNumber, kDriveRamp, 1.0, 0.0, 0.0);
+		const UINT32 start = RobotClock::GetTime();
+		bool reported = false;
+		double previousOutput = 0.0;
+		UINT32 previousElapsed = 0;
+		for (int i = 0; ; ++i)
+		{
+			const UINT32 elapsed = RobotClock::GetTime() - start;
+			if (elapsed > kRunTime)
+			{
+				break;
+			}
+			jaguar.SetOutput(1.0);
+			const double output = Simulation::GetJaguarOutput(run.m_deviceNumber);
+			const double expected = Expected(elapsed);
+			if (fabs(output - expected) > run.m_maxError)
+			{
+				run.m_maxError = fabs(output - expected);
+			}
+			// The first call has no period to measure the change over. A
+			// change that was too small to send is sent with the next one.
+			if (i > 0)
+			{
+				const double period = (elapsed - previousElapsed) * 1e-6;
+				const double change = output - previousOutput;
+				if (change / period > run.m_maxRate)
+				{
+					run.m_maxRate = change / period;
+				}
+				if (change > kMaxRate * period + kCANWriteTolerance)
+				{
+					run.m_tooSteep = true;
+				}
+			}
+			previousOutput = output;
+			previousElapsed = elapsed;
+			if (!reported && elapsed >= kReportTime)
+			{
+				run.m_reportOutput = output;
+				run.m_reportExpected = expected;
+				reported = true;
+			}
+			++run.m_calls;
+			taskDelay(run.m_delays[i % run.m_delayCount]);
+		}
+		run.m_done = true;
+	}
+
+	//! Keeps the robot enabled until every run is done
+	bool Script(UINT32 time)
+	{
+		Simulation::SetEnabled(true);
+		Simulation::SetAutonomous(false);
+		for (int i = 0; i < kRunCount; ++i)
+		{
+			if (!s_runs[i].m_done)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+/**
+ * @brief Starts a task for each run.
+ */
+class RampTestRobot : public IterativeRobot
+{
+public:
+	virtual void TeleopInit()
+	{
+		for (int i = 0; i < kRunCount; ++i)
+		{
+			Task* const task = new Task("RampTest", (FUNCPTR)RunTask);
+			task->Start(i);
+		}
+	}
+};
+
+START_ROBOT_CLASS(RampTestRobot);
+
+int main()
+{
+	Simulation::Run(Script);
+
+	int failures = 0;
+	printf("%-18s %6s %10s %10s %18s\n", "Period", "Calls", "Max error", "Max rate", "Output at 100 ms");
+	for (int i = 0; i < kRunCount; ++i)
+	{
+		const Run& run = s_runs[i];
+		printf("%-18s %6d %10.5f %8.2f/s %9.4f (%.4f)\n", run.m_name, run.m_calls, run.m_maxError,
+			run.m_maxRate, run.m_reportOutput, run.m_reportExpected);
+		if (run.m_maxError > kTolerance)
+		{
+			printf("FAILED: the %s ramp is more than %g from the curve\n", run.m_name, kTolerance);
+			++failures;
+		}
+		if (run.m_tooSteep)
+		{
+			printf("FAILED: the %s ramp changes faster than %.2f per second\n", run.m_name, kMaxRate);
+			++failures;
+		}
+	}
+	if (failures != 0)
+	{
+		printf("%d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
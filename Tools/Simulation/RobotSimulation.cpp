@@ -0,0 +1,219 @@
+/*
+ * RobotSimulation.cpp
+ *
+ * Runs the robot code through a scripted match on the host, on the
+ * simulated WPILib in this directory. Build and run it with:
+ *
+ *     make -C Tools simulation
+ *
+ * The robot is disabled, runs autonomous with the driver's sticks pushed,
+ * which must not drive it, and is then driven in teleop with scripted
+ * sticks: forward, a turn on the spot, and then the sticks are let go.
+ * The drive Jaguars are checked at the end of each step, and throughout
+ * autonomous, and
+ * the program exits with a failure if any check fails, so it can be run
+ * after every change. It also prints how long the periodic functions took
+ * on the host and how many CAN messages were sent.
+ *
+ * The robot's console output goes to the file named by the first argument,
+ * or is thrown away if there is none, so that the results can be read.
+ *
+ * This file is not part of the robot build.
+ */
+#include "Simulation.h"
+#include "../../Robotmap.h"
+#include <math.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace
+{
+	//! A step of the script, which holds the inputs from its start time
+	struct Step
+	{
+		double m_time;			//!< Start of the step in seconds
+		const char* m_name;
+		bool m_enabled;
+		bool m_autonomous;
+		float m_leftY;			//!< Driver left stick, forward is negative
+		float m_leftX;
+		float m_rightX;
+	};
+
+	const Step kSteps[] =
+	{
+		{0.0, "Disabled", false, false, 0.0f, 0.0f, 0.0f},
+		{0.5, "Autonomous", true, true, -1.0f, 0.0f, 1.0f},
+		{2.5, "Teleop forward", true, false, -1.0f, 0.0f, 0.0f},
+		{4.5, "Teleop turn", true, false, 0.0f, 0.0f, 1.0f},
+		{6.5, "Teleop released", true, false, 0.0f, 0.0f, 0.0f},
+		{8.0, "Disabled", false, false, 0.0f, 0.0f, 0.0f},
+	};
+	const int kStepCount = sizeof(kSteps) / sizeof(kSteps[0]);
+	const double kEndTime = 8.5;
+
+	//! The driver stick axes read by FRCXboxJoystick
+	const UINT32 kDriverStick = 1;
+	const UINT32 kLeftYAxis = 2;
+	const UINT32 kLeftXAxis = 1;
+	const UINT32 kRightXAxis = 4;
+
+	const UINT8 kDriveJaguars[] = {kFrontLeftJaguar, kRearLeftJaguar, kFrontRightJaguar, kRearRightJaguar};
+	const char* const kDriveJaguarNames[] = {"front left", "rear left", "front right", "rear right"};
+
+	//! The drive outputs at the end of each step
+	double s_outputs[kStepCount][4];
+	//! The largest drive output seen during autonomous
+	double s_maxAutonomousOutput = 0.0;
+	int s_step = -1;
+	UINT32 s_lastTime = 0;
+	int s_failures = 0;
+	FILE* s_results = stdout;	//!< The real stdout, stdout itself is the robot console
+
+	//! Records the drive outputs at the end of the current step
+	void RecordOutputs()
+	{
+		if (s_step >= 0)
+		{
+			fprintf(s_results, "%6.2f s  %-18s", s_lastTime * 1e-6, kSteps[s_step].m_name);
+			for (int i = 0; i < 4; ++i)
+			{
+				s_outputs[s_step][i] = Simulation::GetJaguarOutput(kDriveJaguars[i]);
+				fprintf(s_results, " %7.3f", s_outputs[s_step][i]);
+			}
+			fprintf(s_results, "\n");
+		}
+	}
+
+	//! Applies the script step for the time, and records the outputs at
+	//! the end of each step
+	bool Script(UINT32 time)
+	{
+		const double seconds = time * 1e-6;
+		int step = s_step;
+		while (step + 1 < kStepCount && seconds >= kSteps[step + 1].m_time)
+		{
+			++step;
+		}
+		if (step != s_step || seconds >= kEndTime)
+		{
+			RecordOutputs();
+		}
+		s_lastTime = time;
+		if (s_step >= 0 && kSteps[s_step].m_enabled && kSteps[s_step].m_autonomous)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				const double output = fabs(Simulation::GetJaguarOutput(kDriveJaguars[i]));
+				if (output > s_maxAutonomousOutput)
+				{
+					s_maxAutonomousOutput = output;
+				}
+			}
+		}
+		if (seconds >= kEndTime)
+		{
+			return false;
+		}
+		if (step != s_step)
+		{
+			s_step = step;
+			const Step& current = kSteps[step];
+			Simulation::SetEnabled(current.m_enabled);
+			Simulation::SetAutonomous(current.m_autonomous);
+			Simulation::SetJoystickAxis(kDriverStick, kLeftYAxis, current.m_leftY);
+			Simulation::SetJoystickAxis(kDriverStick, kLeftXAxis, current.m_leftX);
+			Simulation::SetJoystickAxis(kDriverStick, kRightXAxis, current.m_rightX);
+		}
+		return true;
+	}
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description)
+	{
+		if (!passed)
+		{
+			fprintf(s_results, "FAILED: %s\n", description);
+			++s_failures;
+		}
+	}
+
+	//! Returns the sign of a value, 0 for small values
+	int Sign(double value)
+	{
+		return (value > 0.05) ? 1 : ((value < -0.05) ? -1 : 0);
+	}
+
+	//! Returns the host time in seconds
+	double Now()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec + tv.tv_usec * 1e-6;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	s_results = fdopen(dup(fileno(stdout)), "w");
+	if (s_results == 0 || freopen((argc > 1) ? argv[1] : "/dev/null", "w", stdout) == 0)
+	{
+		perror("RobotSimulation");
+		return 1;
+	}
+	fprintf(s_results, "%6s    %-18s %7s %7s %7s %7s\n", "Time", "Step", "FL", "RL", "FR", "RR");
+	const double start = Now();
+	Simulation::Run(Script);
+	const double elapsed = Now() - start;
+
+	// Forward drives every wheel, the wheels on each side the same way
+	const double* const forward = s_outputs[2];
+	const double* const turn = s_outputs[3];
+	for (int i = 0; i < 4; ++i)
+	{
+		char description[80];
+		sprintf(description, "the %s Jaguar does not drive forward", kDriveJaguarNames[i]);
+		Check(fabs(forward[i]) > 0.5, description);
+		sprintf(description, "the %s Jaguar does not drive the turn", kDriveJaguarNames[i]);
+		// The BSBot rear wheels turn faster than the front, see DriveKinematics.h
+		Check(fabs(turn[i]) > 0.2, description);
+		sprintf(description, "the %s Jaguar does not stop when the sticks are released", kDriveJaguarNames[i]);
+		Check(fabs(s_outputs[4][i]) < 0.01, description);
+		sprintf(description, "the %s Jaguar drives while disabled", kDriveJaguarNames[i]);
+		Check(s_outputs[0][i] == 0.0 && s_outputs[5][i] == 0.0, description);
+	}
+	// Without encoders autonomous has no command to drive the robot, and
+	// the driver's sticks must not drive it either
+	if (!kUseEncoders)
+	{
+		Check(s_maxAutonomousOutput < 0.01, "the driver's sticks drive the robot in autonomous");
+	}
+	Check(Sign(forward[0]) == Sign(forward[1]) && Sign(forward[2]) == Sign(forward[3]),
+		"the wheels on one side drive in different directions going forward");
+	// Turning reverses one side relative to going forward
+	Check(Sign(forward[0]) * Sign(forward[2]) == -Sign(turn[0]) * Sign(turn[2]),
+		"turning does not drive the sides against each other");
+
+	fprintf(s_results, "\n%-12s %8s %12s %12s\n", "Mode", "Loops", "Mean (us)", "Max (us)");
+	const char* const modeNames[] = {"Disabled", "Autonomous", "Teleop"};
+	for (int mode = 0; mode < Simulation::kModes; ++mode)
+	{
+		const Simulation::LoopStatistics& statistics = Simulation::GetLoopStatistics(static_cast<Simulation::Mode>(mode));
+		fprintf(s_results, "%-12s %8u %12.2f %12.2f\n", modeNames[mode], statistics.m_count,
+			statistics.m_count ? statistics.m_totalTime * 1e6 / statistics.m_count : 0.0,
+			statistics.m_maxTime * 1e6);
+	}
+	fprintf(s_results, "\nCAN messages %u, %.0f per second\n", Simulation::GetCANMessageCount(),
+		Simulation::GetCANMessageCount() / kEndTime);
+	fprintf(s_results, "Task switches %u\n", Simulation::GetTaskSwitchCount());
+	fprintf(s_results, "Simulated %.1f s in %.3f s\n", kEndTime, elapsed);
+
+	if (s_failures != 0)
+	{
+		fprintf(s_results, "%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	fprintf(s_results, "All checks passed\n");
+	return 0;
+}
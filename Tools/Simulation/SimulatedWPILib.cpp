@@ -0,0 +1,1751 @@
+/*
+ * SimulatedWPILib.cpp
+ *
+ * Implements the simulated WPILib and VxWorks declared in WPILib.h, and
+ * the Simulation calls that script it.
+ *
+ * Every VxWorks task runs on its own thread, but only the task holding
+ * the simulated processor runs. It only gives the processor up when it
+ * waits, in taskDelay or semTake, or when it wakes a higher priority
+ * task, and the processor then goes to the highest priority task that is
+ * ready, the one that became ready first if several are. When every task
+ * is waiting the clock jumps to the next time a task wakes. The tasks
+ * therefore interleave exactly as they would on the single core cRIO if
+ * the code took no time to run, and a run gives the same results every
+ * time however loaded the host is.
+ *
+ * The robot code passes object pointers to its tasks as UINT32, which is
+ * fine on the 32 bit cRIO. The simulation is linked without -pie and keeps
+ * every allocation on the main heap so all of its objects have addresses
+ * below 4 GB, and pass through a UINT32 intact. Objects handed to a task
+ * must not be on the stack.
+ *
+ * This file is not part of the robot build.
+ */
+#include "Simulation.h"
+#include <deque>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief The simulated state of a VxWorks task.
+ */
+struct SimulatedTask
+{
+	enum State
+	{
+		kReady,
+		kWaiting,
+		kStopped
+	};
+
+	std::string m_name;
+	INT32 m_priority;
+	FUNCPTR m_function;
+	UINT32 m_args[10];
+	pthread_t m_thread;
+	pthread_cond_t m_wake;
+	State m_state;
+	INT64 m_readyOrder;			//!< Orders the ready tasks of the same priority
+	bool m_timed;				//!< Set when waiting with a timeout
+	UINT64 m_wakeTime;			//!< When a timed wait ends
+	struct semaphore* m_semaphore;	//!< The semaphore waited on, if any
+	bool m_timedOut;
+};
+
+/**
+ * @brief A VxWorks binary, mutual exclusion or counting semaphore.
+ */
+struct semaphore
+{
+	enum Type
+	{
+		kBinary,
+		kMutex,
+		kCounting
+	};
+
+	Type m_type;
+	int m_count;
+	SimulatedTask* m_owner;
+	int m_ownerDepth;
+	std::deque<SimulatedTask*> m_waiting;
+};
+
+/**
+ * @brief The simulated state of a CANJaguar and its motor.
+ */
+struct SimulatedJaguar
+{
+	UINT8 m_deviceNumber;
+	CANJaguar::ControlMode m_controlMode;
+	bool m_controlEnabled;
+	double m_setpoint;
+	double m_pendingSetpoint;
+	UINT8 m_pendingSyncGroup;
+	double m_maxOutputVoltage;
+	double m_position;
+	double m_speed;
+	UINT64 m_time;				//!< The time the motor was last moved on to
+	bool m_scripted;			//!< Set by Simulation::SetJaguarMotion
+	UINT32 m_messageCount;
+};
+
+namespace
+{
+	const UINT64 kTickPeriod = 1000000 / Simulation::kClockRate;
+	const double kBusVoltage = 12.0;
+	const int kMaxJaguars = 64;
+	const int kJoystickPorts = 4;
+	const int kJoystickAxes = 6;
+	const int kJoystickButtons = 12;
+
+	//! Guards the scheduler, only held briefly by the running task
+	pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+	std::vector<SimulatedTask*> s_tasks;
+	SimulatedTask* s_running = NULL;
+	UINT64 s_time = 0;
+	INT64 s_readyOrder = 0;
+	INT64 s_preemptedOrder = 0;
+	int s_taskLockDepth = 0;
+	UINT32 s_taskSwitches = 0;
+
+	SimulatedJaguar* s_jaguars[kMaxJaguars];
+	UINT32 s_canMessageCount = 0;
+
+	bool s_enabled = false;
+	bool s_autonomous = false;
+	float s_axes[kJoystickPorts][kJoystickAxes];
+	bool s_buttons[kJoystickPorts][kJoystickButtons];
+	float s_gyroAngle = 0;
+	Simulation::Script s_script = NULL;
+	Simulation::LoopStatistics s_loopStatistics[Simulation::kModes];
+
+	/**
+	 * @brief Keeps every allocation on the main heap, below 4 GB, see the
+	 * top of the file. This runs before any other static initializer.
+	 */
+	void __attribute__((constructor(101))) KeepHeapLow()
+	{
+		mallopt(M_MMAP_MAX, 0);
+		mallopt(M_ARENA_MAX, 1);
+		static int probe;
+		if (reinterpret_cast<uintptr_t>(&probe) > 0xFFFFFFFFu ||
+			reinterpret_cast<uintptr_t>(sbrk(0)) > 0xFFFFFFFFu)
+		{
+			fprintf(stderr, "The simulation must be linked with -no-pie\n");
+			abort();
+		}
+	}
+
+	/**
+	 * @brief Returns the host time in seconds.
+	 */
+	double HostTime()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+
+	/**
+	 * @brief Returns the running task, making the calling thread the main
+	 * robot task the first time.
+	 */
+	SimulatedTask* Current()
+	{
+		if (s_running == NULL)
+		{
+			SimulatedTask* const task = new SimulatedTask();
+			task->m_name = "FRC_RobotTask";
+			task->m_priority = Task::kDefaultPriority;
+			task->m_function = NULL;
+			task->m_thread = pthread_self();
+			pthread_cond_init(&task->m_wake, NULL);
+			task->m_state = SimulatedTask::kReady;
+			task->m_readyOrder = 0;
+			task->m_timed = false;
+			task->m_wakeTime = 0;
+			task->m_semaphore = NULL;
+			task->m_timedOut = false;
+			s_tasks.push_back(task);
+			s_running = task;
+		}
+		return s_running;
+	}
+
+	/**
+	 * @brief Makes a task ready to run, behind the ready tasks of the same
+	 * priority.
+	 */
+	void MakeReady(SimulatedTask* task)
+	{
+		task->m_state = SimulatedTask::kReady;
+		task->m_readyOrder = ++s_readyOrder;
+		task->m_timed = false;
+		task->m_semaphore = NULL;
+	}
+
+	/**
+	 * @brief Wakes a task waiting on a semaphore.
+	 */
+	void WakeWaiting(SimulatedTask* task)
+	{
+		MakeReady(task);
+		task->m_timedOut = false;
+	}
+
+	/**
+	 * @brief Removes a task from the semaphore it is waiting on.
+	 */
+	void StopWaiting(SimulatedTask* task)
+	{
+		semaphore* const sem = task->m_semaphore;
+		if (sem != NULL)
+		{
+			for (std::deque<SimulatedTask*>::iterator it = sem->m_waiting.begin(); it != sem->m_waiting.end(); ++it)
+			{
+				if (*it == task)
+				{
+					sem->m_waiting.erase(it);
+					break;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the highest priority ready task, moving the clock on
+	 * to the next wake time when no task is ready.
+	 */
+	SimulatedTask* PickNext()
+	{
+		while (true)
+		{
+			SimulatedTask* next = NULL;
+			for (size_t i = 0; i < s_tasks.size(); ++i)
+			{
+				SimulatedTask* const task = s_tasks[i];
+				if (task->m_state == SimulatedTask::kReady &&
+					(next == NULL || task->m_priority < next->m_priority ||
+					(task->m_priority == next->m_priority && task->m_readyOrder < next->m_readyOrder)))
+				{
+					next = task;
+				}
+			}
+			if (next != NULL)
+			{
+				return next;
+			}
+
+			bool waiting = false;
+			UINT64 wakeTime = 0;
+			for (size_t i = 0; i < s_tasks.size(); ++i)
+			{
+				SimulatedTask* const task = s_tasks[i];
+				if (task->m_state == SimulatedTask::kWaiting && task->m_timed &&
+					(!waiting || task->m_wakeTime < wakeTime))
+				{
+					waiting = true;
+					wakeTime = task->m_wakeTime;
+				}
+			}
+			if (!waiting)
+			{
+				fprintf(stderr, "Simulation deadlocked, every task is waiting on a semaphore:\n");
+				for (size_t i = 0; i < s_tasks.size(); ++i)
+				{
+					if (s_tasks[i]->m_state == SimulatedTask::kWaiting)
+					{
+						fprintf(stderr, "    %s\n", s_tasks[i]->m_name.c_str());
+					}
+				}
+				abort();
+			}
+
+			if (wakeTime > s_time)
+			{
+				s_time = wakeTime;
+			}
+			for (size_t i = 0; i < s_tasks.size(); ++i)
+			{
+				SimulatedTask* const task = s_tasks[i];
+				if (task->m_state == SimulatedTask::kWaiting && task->m_timed && task->m_wakeTime <= s_time)
+				{
+					StopWaiting(task);
+					task->m_timedOut = (task->m_semaphore != NULL);
+					MakeReady(task);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Gives the processor to the next task after the running task
+	 * has changed its state, and waits for it to come back unless the
+	 * running task has stopped. Called with s_lock held.
+	 */
+	void Reschedule(SimulatedTask* self)
+	{
+		SimulatedTask* const next = PickNext();
+		if (next != self)
+		{
+			++s_taskSwitches;
+			s_running = next;
+			pthread_cond_signal(&next->m_wake);
+		}
+		if (self->m_state != SimulatedTask::kStopped)
+		{
+			while (s_running != self)
+			{
+				pthread_cond_wait(&self->m_wake, &s_lock);
+			}
+		}
+	}
+
+	/**
+	 * @brief Switches to a higher priority task that has just been made
+	 * ready, as VxWorks would. The running task stays at the head of the
+	 * tasks of its priority. Called with s_lock held.
+	 */
+	void Preempt()
+	{
+		SimulatedTask* const self = Current();
+		if (s_taskLockDepth > 0)
+		{
+			return;
+		}
+		for (size_t i = 0; i < s_tasks.size(); ++i)
+		{
+			SimulatedTask* const task = s_tasks[i];
+			if (task->m_state == SimulatedTask::kReady && task != self && task->m_priority < self->m_priority)
+			{
+				self->m_state = SimulatedTask::kReady;
+				self->m_readyOrder = --s_preemptedOrder;
+				Reschedule(self);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Makes the running task wait until the time. Called with
+	 * s_lock held.
+	 */
+	void WaitUntil(UINT64 wakeTime)
+	{
+		SimulatedTask* const self = Current();
+		if (wakeTime <= s_time)
+		{
+			// A zero delay lets the other ready tasks of the same priority run
+			MakeReady(self);
+		}
+		else
+		{
+			self->m_state = SimulatedTask::kWaiting;
+			self->m_timed = true;
+			self->m_wakeTime = wakeTime;
+			self->m_semaphore = NULL;
+		}
+		Reschedule(self);
+	}
+
+	/**
+	 * @brief The thread of a task, waits for the processor and then calls
+	 * the task function.
+	 */
+	void* TaskThread(void* argument)
+	{
+		SimulatedTask* const self = static_cast<SimulatedTask*>(argument);
+		pthread_mutex_lock(&s_lock);
+		while (s_running != self)
+		{
+			pthread_cond_wait(&self->m_wake, &s_lock);
+		}
+		pthread_mutex_unlock(&s_lock);
+
+		// Each argument is widened so the whole register is set
+		const UINT32* const args = self->m_args;
+		self->m_function(static_cast<unsigned long>(args[0]), static_cast<unsigned long>(args[1]),
+			static_cast<unsigned long>(args[2]), static_cast<unsigned long>(args[3]),
+			static_cast<unsigned long>(args[4]), static_cast<unsigned long>(args[5]),
+			static_cast<unsigned long>(args[6]), static_cast<unsigned long>(args[7]),
+			static_cast<unsigned long>(args[8]), static_cast<unsigned long>(args[9]));
+
+		pthread_mutex_lock(&s_lock);
+		self->m_state = SimulatedTask::kStopped;
+		Reschedule(self);
+		pthread_mutex_unlock(&s_lock);
+		return NULL;
+	}
+
+	/**
+	 * @brief Returns the simulated Jaguar with the device number, or NULL.
+	 */
+	SimulatedJaguar* FindJaguar(UINT8 deviceNumber)
+	{
+		return (deviceNumber < kMaxJaguars) ? s_jaguars[deviceNumber] : NULL;
+	}
+
+	/**
+	 * @brief Counts a CAN message sent to a Jaguar.
+	 */
+	void CountMessage(SimulatedJaguar* jaguar)
+	{
+		++s_canMessageCount;
+		++jaguar->m_messageCount;
+	}
+
+	/**
+	 * @brief Returns the output the Jaguar applies to its motor as a
+	 * fraction of the bus voltage.
+	 */
+	double GetOutput(const SimulatedJaguar& jaguar)
+	{
+		if (!s_enabled)
+		{
+			return 0.0;
+		}
+		const double limit = jaguar.m_maxOutputVoltage / kBusVoltage;
+		double output = 0.0;
+		switch (jaguar.m_controlMode)
+		{
+			case CANJaguar::kPercentVbus:
+				output = jaguar.m_setpoint;
+				break;
+			case CANJaguar::kVoltage:
+				output = jaguar.m_setpoint / kBusVoltage;
+				break;
+			case CANJaguar::kSpeed:
+				// The Jaguar's own speed loop is assumed to be ideal
+				output = jaguar.m_controlEnabled ? jaguar.m_setpoint / Simulation::kMotorFreeSpeed : 0.0;
+				break;
+			case CANJaguar::kPosition:
+				output = jaguar.m_controlEnabled ? 2.0 * (jaguar.m_setpoint - jaguar.m_position) : 0.0;
+				break;
+			default:
+				break;
+		}
+		return (output > limit) ? limit : ((output < -limit) ? -limit : output);
+	}
+
+	/**
+	 * @brief Moves the motor on to the current time, in steps of at most
+	 * a clock tick.
+	 */
+	void MoveMotor(SimulatedJaguar& jaguar)
+	{
+		while (jaguar.m_time < s_time)
+		{
+			const UINT64 step = (s_time - jaguar.m_time > kTickPeriod) ? kTickPeriod : s_time - jaguar.m_time;
+			const double dTime = step * 1e-6;
+			const double oldSpeed = jaguar.m_speed;
+			if (!jaguar.m_scripted)
+			{
+				const double target = GetOutput(jaguar) * Simulation::kMotorFreeSpeed;
+				jaguar.m_speed += (target - jaguar.m_speed) * (1.0 - exp(-dTime / Simulation::kMotorTimeConstant));
+			}
+			// The speed is in revolutions per minute and the position in
+			// revolutions, as the Jaguar reports them
+			jaguar.m_position += (oldSpeed + jaguar.m_speed) * 0.5 * dTime / 60.0;
+			jaguar.m_time += step;
+		}
+	}
+}
+
+// VxWorks
+
+SEM_ID semBCreate(int options, int initialState)
+{
+	semaphore* const sem = new semaphore();
+	sem->m_type = semaphore::kBinary;
+	sem->m_count = (initialState == SEM_FULL) ? 1 : 0;
+	sem->m_owner = NULL;
+	sem->m_ownerDepth = 0;
+	return sem;
+}
+
+SEM_ID semMCreate(int options)
+{
+	semaphore* const sem = new semaphore();
+	sem->m_type = semaphore::kMutex;
+	sem->m_count = 0;
+	sem->m_owner = NULL;
+	sem->m_ownerDepth = 0;
+	return sem;
+}
+
+SEM_ID semCCreate(int options, int initialCount)
+{
+	semaphore* const sem = new semaphore();
+	sem->m_type = semaphore::kCounting;
+	sem->m_count = initialCount;
+	sem->m_owner = NULL;
+	sem->m_ownerDepth = 0;
+	return sem;
+}
+
+/**
+ * @brief Takes a semaphore. The waiting tasks are queued by priority, as
+ * with SEM_Q_PRIORITY, whatever the options.
+ */
+STATUS semTake(SEM_ID sem, int timeout)
+{
+	pthread_mutex_lock(&s_lock);
+	SimulatedTask* const self = Current();
+	STATUS status = OK;
+	if (sem->m_type == semaphore::kMutex && (sem->m_owner == NULL || sem->m_owner == self))
+	{
+		sem->m_owner = self;
+		++sem->m_ownerDepth;
+	}
+	else if (sem->m_type != semaphore::kMutex && sem->m_count > 0)
+	{
+		--sem->m_count;
+	}
+	else if (timeout == NO_WAIT)
+	{
+		status = ERROR;
+	}
+	else
+	{
+		std::deque<SimulatedTask*>::iterator it = sem->m_waiting.begin();
+		while (it != sem->m_waiting.end() && (*it)->m_priority <= self->m_priority)
+		{
+			++it;
+		}
+		sem->m_waiting.insert(it, self);
+		self->m_state = SimulatedTask::kWaiting;
+		self->m_timed = (timeout != WAIT_FOREVER);
+		self->m_wakeTime = s_time + static_cast<UINT64>(timeout) * kTickPeriod;
+		self->m_semaphore = sem;
+		self->m_timedOut = false;
+		Reschedule(self);
+		// A mutex or binary semaphore is handed straight to the woken task
+		status = self->m_timedOut ? ERROR : OK;
+	}
+	pthread_mutex_unlock(&s_lock);
+	return status;
+}
+
+STATUS semGive(SEM_ID sem)
+{
+	pthread_mutex_lock(&s_lock);
+	if (sem->m_type == semaphore::kMutex)
+	{
+		if (--sem->m_ownerDepth == 0)
+		{
+			sem->m_owner = NULL;
+			if (!sem->m_waiting.empty())
+			{
+				SimulatedTask* const task = sem->m_waiting.front();
+				sem->m_waiting.pop_front();
+				sem->m_owner = task;
+				sem->m_ownerDepth = 1;
+				WakeWaiting(task);
+			}
+		}
+	}
+	else if (!sem->m_waiting.empty())
+	{
+		SimulatedTask* const task = sem->m_waiting.front();
+		sem->m_waiting.pop_front();
+		WakeWaiting(task);
+	}
+	else if (sem->m_type == semaphore::kBinary)
+	{
+		sem->m_count = 1;
+	}
+	else
+	{
+		++sem->m_count;
+	}
+	Preempt();
+	pthread_mutex_unlock(&s_lock);
+	return OK;
+}
+
+STATUS semFlush(SEM_ID sem)
+{
+	pthread_mutex_lock(&s_lock);
+	while (!sem->m_waiting.empty())
+	{
+		SimulatedTask* const task = sem->m_waiting.front();
+		sem->m_waiting.pop_front();
+		WakeWaiting(task);
+	}
+	Preempt();
+	pthread_mutex_unlock(&s_lock);
+	return OK;
+}
+
+STATUS semDelete(SEM_ID sem)
+{
+	delete sem;
+	return OK;
+}
+
+/**
+ * @brief Waits until the tick after next plus ticks - 1, as VxWorks does,
+ * so a delay of n ticks lasts between n - 1 and n tick periods.
+ */
+STATUS taskDelay(int ticks)
+{
+	pthread_mutex_lock(&s_lock);
+	const UINT64 wakeTime = (ticks <= 0) ? s_time : (s_time / kTickPeriod + ticks) * kTickPeriod;
+	WaitUntil(wakeTime);
+	pthread_mutex_unlock(&s_lock);
+	return OK;
+}
+
+STATUS taskLock()
+{
+	++s_taskLockDepth;
+	return OK;
+}
+
+STATUS taskUnlock()
+{
+	--s_taskLockDepth;
+	return OK;
+}
+
+int sysClkRateGet()
+{
+	return Simulation::kClockRate;
+}
+
+/**
+ * @brief Interrupts cannot happen in the simulation and a task only loses
+ * the processor when it waits, so there is nothing to lock.
+ */
+int intLock()
+{
+	return 0;
+}
+
+void intUnlock(int lockKey)
+{
+}
+
+int Priv_SetWriteFileAllowed(UINT32 enable)
+{
+	return 0;
+}
+
+int ioctl(int fd, int function, int arg)
+{
+	return OK;
+}
+
+STATUS mkdir(const char* path)
+{
+	return ::mkdir(path, 0777);
+}
+
+// WPILib timing
+
+UINT32 GetFPGATime()
+{
+	return static_cast<UINT32>(s_time);
+}
+
+double GetTime()
+{
+	return s_time * 1e-6;
+}
+
+void Wait(double seconds)
+{
+	if (seconds < 0.0)
+	{
+		return;
+	}
+	taskDelay(static_cast<int>(static_cast<double>(sysClkRateGet()) * seconds));
+}
+
+Synchronized::Synchronized(SEM_ID semaphore) :
+	m_semaphore(semaphore)
+{
+	semTake(m_semaphore, WAIT_FOREVER);
+}
+
+Synchronized::~Synchronized()
+{
+	semGive(m_semaphore);
+}
+
+// Tasks
+
+Task::Task(const char* name, FUNCPTR function, INT32 priority, UINT32 stackSize) :
+	m_name(name),
+	m_function(function),
+	m_priority(priority),
+	m_task(NULL)
+{
+}
+
+Task::~Task()
+{
+	Stop();
+}
+
+/**
+ * @brief Starts the task, which runs straight away if it has a higher
+ * priority than the caller.
+ */
+bool Task::Start(UINT32 arg0, UINT32 arg1, UINT32 arg2, UINT32 arg3, UINT32 arg4,
+	UINT32 arg5, UINT32 arg6, UINT32 arg7, UINT32 arg8, UINT32 arg9)
+{
+	pthread_mutex_lock(&s_lock);
+	Current();
+	SimulatedTask* const task = new SimulatedTask();
+	task->m_name = m_name;
+	task->m_priority = m_priority;
+	task->m_function = m_function;
+	const UINT32 args[10] = {arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9};
+	memcpy(task->m_args, args, sizeof(args));
+	pthread_cond_init(&task->m_wake, NULL);
+	task->m_semaphore = NULL;
+	task->m_timedOut = false;
+	task->m_wakeTime = 0;
+	MakeReady(task);
+	s_tasks.push_back(task);
+	m_task = task;
+	pthread_create(&task->m_thread, NULL, TaskThread, task);
+	pthread_detach(task->m_thread);
+	Preempt();
+	pthread_mutex_unlock(&s_lock);
+	return true;
+}
+
+/**
+ * @brief Stops the task. Its thread is left waiting for the processor,
+ * which it never gets again.
+ */
+bool Task::Stop()
+{
+	pthread_mutex_lock(&s_lock);
+	if (m_task != NULL && m_task->m_state != SimulatedTask::kStopped)
+	{
+		StopWaiting(m_task);
+		m_task->m_state = SimulatedTask::kStopped;
+		if (m_task == s_running)
+		{
+			Reschedule(m_task);
+		}
+	}
+	m_task = NULL;
+	pthread_mutex_unlock(&s_lock);
+	return true;
+}
+
+bool Task::Verify()
+{
+	return m_task != NULL && m_task->m_state != SimulatedTask::kStopped;
+}
+
+INT32 Task::GetPriority()
+{
+	return m_priority;
+}
+
+const char* Task::GetName()
+{
+	return m_name.c_str();
+}
+
+// Commands
+
+Subsystem::Subsystem(const char* name) :
+	m_name(name),
+	m_defaultCommand(NULL),
+	m_initializedDefaultCommand(false),
+	m_currentCommand(NULL)
+{
+	Scheduler::GetInstance()->RegisterSubsystem(this);
+}
+
+Subsystem::~Subsystem()
+{
+}
+
+void Subsystem::InitDefaultCommand()
+{
+}
+
+void Subsystem::SetDefaultCommand(Command* command)
+{
+	m_defaultCommand = command;
+}
+
+/**
+ * @brief Returns the default command, creating it with InitDefaultCommand
+ * the first time.
+ */
+Command* Subsystem::GetDefaultCommand()
+{
+	if (!m_initializedDefaultCommand)
+	{
+		m_initializedDefaultCommand = true;
+		InitDefaultCommand();
+	}
+	return m_defaultCommand;
+}
+
+Command* Subsystem::GetCurrentCommand()
+{
+	return m_currentCommand;
+}
+
+const char* Subsystem::GetName()
+{
+	return m_name.c_str();
+}
+
+Command::Command() :
+	m_name("Command"),
+	m_requirementCount(0),
+	m_running(false),
+	m_initialized(false)
+{
+}
+
+Command::Command(const char* name) :
+	m_name(name),
+	m_requirementCount(0),
+	m_running(false),
+	m_initialized(false)
+{
+}
+
+Command::~Command()
+{
+}
+
+void Command::Requires(Subsystem* subsystem)
+{
+	if (subsystem != NULL && m_requirementCount < kMaxRequirements)
+	{
+		m_requirements[m_requirementCount++] = subsystem;
+	}
+}
+
+void Command::Start()
+{
+	Scheduler::GetInstance()->AddCommand(this);
+}
+
+void Command::Cancel()
+{
+	Scheduler::GetInstance()->Remove(this);
+}
+
+bool Command::IsRunning()
+{
+	return m_running;
+}
+
+const char* Command::GetName()
+{
+	return m_name.c_str();
+}
+
+Scheduler::Scheduler() :
+	m_additionCount(0),
+	m_commandCount(0),
+	m_subsystemCount(0)
+{
+}
+
+Scheduler* Scheduler::GetInstance()
+{
+	static Scheduler* instance = new Scheduler();
+	return instance;
+}
+
+/**
+ * @brief Queues a command to start on the next Run.
+ */
+void Scheduler::AddCommand(Command* command)
+{
+	if (m_additionCount < kMaxCommands)
+	{
+		m_additions[m_additionCount++] = command;
+	}
+}
+
+void Scheduler::RegisterSubsystem(Subsystem* subsystem)
+{
+	if (m_subsystemCount < kMaxSubsystems)
+	{
+		m_subsystems[m_subsystemCount++] = subsystem;
+	}
+}
+
+/**
+ * @brief Starts the queued commands, runs every command once, removing
+ * the finished ones, and then starts the default commands of the idle
+ * subsystems.
+ */
+void Scheduler::Run()
+{
+	for (int i = 0; i < m_additionCount; ++i)
+	{
+		ProcessAddition(m_additions[i]);
+	}
+	m_additionCount = 0;
+
+	for (int i = 0; i < m_commandCount; )
+	{
+		Command* const command = m_commands[i];
+		if (!command->m_initialized)
+		{
+			command->m_initialized = true;
+			command->Initialize();
+		}
+		command->Execute();
+		if (command->IsFinished())
+		{
+			command->m_initialized = false;
+			Remove(command);
+			command->End();
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	for (int i = 0; i < m_subsystemCount; ++i)
+	{
+		Subsystem* const subsystem = m_subsystems[i];
+		if (subsystem->m_currentCommand == NULL && subsystem->GetDefaultCommand() != NULL)
+		{
+			ProcessAddition(subsystem->GetDefaultCommand());
+		}
+	}
+}
+
+/**
+ * @brief Starts a command, interrupting the commands using any of the
+ * same subsystems.
+ */
+void Scheduler::ProcessAddition(Command* command)
+{
+	if (command->m_running || m_commandCount >= kMaxCommands)
+	{
+		return;
+	}
+	for (int i = 0; i < command->m_requirementCount; ++i)
+	{
+		Command* const current = command->m_requirements[i]->m_currentCommand;
+		if (current != NULL)
+		{
+			Remove(current);
+		}
+	}
+	for (int i = 0; i < command->m_requirementCount; ++i)
+	{
+		command->m_requirements[i]->m_currentCommand = command;
+	}
+	command->m_running = true;
+	command->m_initialized = false;
+	m_commands[m_commandCount++] = command;
+}
+
+/**
+ * @brief Stops a command, calling Interrupted if it had been initialized.
+ */
+void Scheduler::Remove(Command* command)
+{
+	for (int i = 0; i < m_additionCount; ++i)
+	{
+		if (m_additions[i] == command)
+		{
+			m_additions[i] = m_additions[--m_additionCount];
+			--i;
+		}
+	}
+	if (!command->m_running)
+	{
+		return;
+	}
+	for (int i = 0; i < m_commandCount; ++i)
+	{
+		if (m_commands[i] == command)
+		{
+			for (int j = i + 1; j < m_commandCount; ++j)
+			{
+				m_commands[j - 1] = m_commands[j];
+			}
+			--m_commandCount;
+			break;
+		}
+	}
+	for (int i = 0; i < command->m_requirementCount; ++i)
+	{
+		if (command->m_requirements[i]->m_currentCommand == command)
+		{
+			command->m_requirements[i]->m_currentCommand = NULL;
+		}
+	}
+	command->m_running = false;
+	if (command->m_initialized)
+	{
+		command->m_initialized = false;
+		command->Interrupted();
+	}
+}
+
+// Driver station and joysticks
+
+DriverStation* DriverStation::GetInstance()
+{
+	static DriverStation instance;
+	return &instance;
+}
+
+bool DriverStation::IsEnabled()
+{
+	return s_enabled;
+}
+
+bool DriverStation::IsDisabled()
+{
+	return !s_enabled;
+}
+
+bool DriverStation::IsAutonomous()
+{
+	return s_autonomous;
+}
+
+bool DriverStation::IsOperatorControl()
+{
+	return !s_autonomous;
+}
+
+float DriverStation::GetBatteryVoltage()
+{
+	return kBusVoltage;
+}
+
+Joystick::Joystick(UINT32 port) :
+	m_port(port)
+{
+}
+
+Joystick::~Joystick()
+{
+}
+
+float Joystick::GetX(JoystickHand hand)
+{
+	return GetRawAxis(1);
+}
+
+float Joystick::GetY(JoystickHand hand)
+{
+	return GetRawAxis(2);
+}
+
+float Joystick::GetZ()
+{
+	return GetRawAxis(3);
+}
+
+float Joystick::GetTwist()
+{
+	return GetRawAxis(3);
+}
+
+float Joystick::GetThrottle()
+{
+	return GetRawAxis(4);
+}
+
+float Joystick::GetRawAxis(UINT32 axis)
+{
+	if (m_port < 1 || m_port > kJoystickPorts || axis < 1 || axis > kJoystickAxes)
+	{
+		return 0.0;
+	}
+	return s_axes[m_port - 1][axis - 1];
+}
+
+bool Joystick::GetTrigger(JoystickHand hand)
+{
+	return GetRawButton(1);
+}
+
+bool Joystick::GetTop(JoystickHand hand)
+{
+	return GetRawButton(2);
+}
+
+bool Joystick::GetRawButton(UINT32 button)
+{
+	if (m_port < 1 || m_port > kJoystickPorts || button < 1 || button > kJoystickButtons)
+	{
+		return false;
+	}
+	return s_buttons[m_port - 1][button - 1];
+}
+
+JoystickButton::JoystickButton(GenericHID* joystick, int buttonNumber) :
+	m_joystick(joystick),
+	m_buttonNumber(buttonNumber)
+{
+}
+
+JoystickButton::~JoystickButton()
+{
+}
+
+bool JoystickButton::Get()
+{
+	return m_joystick->GetRawButton(m_buttonNumber);
+}
+
+void JoystickButton::WhenPressed(Command* command)
+{
+}
+
+void JoystickButton::WhileHeld(Command* command)
+{
+}
+
+void JoystickButton::WhenReleased(Command* command)
+{
+}
+
+// Motors
+
+MotorSafetyHelper::MotorSafetyHelper(MotorSafety* safeObject) :
+	m_safeObject(safeObject),
+	m_expiration(0.1f),
+	m_enabled(false),
+	m_stopTime(0)
+{
+}
+
+MotorSafetyHelper::~MotorSafetyHelper()
+{
+}
+
+void MotorSafetyHelper::Feed()
+{
+	m_stopTime = GetFPGATime() + static_cast<UINT32>(m_expiration * 1e6);
+}
+
+void MotorSafetyHelper::SetExpiration(float expirationTime)
+{
+	m_expiration = expirationTime;
+}
+
+float MotorSafetyHelper::GetExpiration()
+{
+	return m_expiration;
+}
+
+bool MotorSafetyHelper::IsAlive()
+{
+	return !m_enabled || static_cast<INT32>(m_stopTime - GetFPGATime()) > 0;
+}
+
+void MotorSafetyHelper::Check()
+{
+}
+
+void MotorSafetyHelper::SetSafetyEnabled(bool enabled)
+{
+	m_enabled = enabled;
+}
+
+bool MotorSafetyHelper::IsSafetyEnabled()
+{
+	return m_enabled;
+}
+
+RobotDrive::RobotDrive(SpeedController& frontLeftMotor, SpeedController& rearLeftMotor,
+	SpeedController& frontRightMotor, SpeedController& rearRightMotor) :
+	m_frontLeftMotor(&frontLeftMotor),
+	m_frontRightMotor(&frontRightMotor),
+	m_rearLeftMotor(&rearLeftMotor),
+	m_rearRightMotor(&rearRightMotor),
+	m_safetyHelper(new MotorSafetyHelper(this))
+{
+	m_safetyHelper->SetSafetyEnabled(true);
+}
+
+RobotDrive::~RobotDrive()
+{
+	delete m_safetyHelper;
+}
+
+void RobotDrive::SetExpiration(float timeout)
+{
+	m_safetyHelper->SetExpiration(timeout);
+}
+
+float RobotDrive::GetExpiration()
+{
+	return m_safetyHelper->GetExpiration();
+}
+
+bool RobotDrive::IsAlive()
+{
+	return m_safetyHelper->IsAlive();
+}
+
+void RobotDrive::StopMotor()
+{
+	m_frontLeftMotor->Disable();
+	m_frontRightMotor->Disable();
+	m_rearLeftMotor->Disable();
+	m_rearRightMotor->Disable();
+}
+
+void RobotDrive::SetSafetyEnabled(bool enabled)
+{
+	m_safetyHelper->SetSafetyEnabled(enabled);
+}
+
+bool RobotDrive::IsSafetyEnabled()
+{
+	return m_safetyHelper->IsSafetyEnabled();
+}
+
+void RobotDrive::GetDescription(char* desc)
+{
+	strcpy(desc, "RobotDrive");
+}
+
+CANJaguar::CANJaguar(UINT8 deviceNumber, ControlMode controlMode) :
+	m_jaguar(new SimulatedJaguar()),
+	m_safetyHelper(new MotorSafetyHelper(this))
+{
+	m_jaguar->m_deviceNumber = deviceNumber;
+	m_jaguar->m_controlMode = controlMode;
+	m_jaguar->m_controlEnabled = false;
+	m_jaguar->m_setpoint = 0.0;
+	m_jaguar->m_pendingSetpoint = 0.0;
+	m_jaguar->m_pendingSyncGroup = 0;
+	m_jaguar->m_maxOutputVoltage = kBusVoltage;
+	m_jaguar->m_position = 0.0;
+	m_jaguar->m_speed = 0.0;
+	m_jaguar->m_time = s_time;
+	m_jaguar->m_scripted = false;
+	m_jaguar->m_messageCount = 0;
+	if (deviceNumber < kMaxJaguars)
+	{
+		s_jaguars[deviceNumber] = m_jaguar;
+	}
+	// The constructor reads the firmware version and sets the mode
+	CountMessage(m_jaguar);
+	CountMessage(m_jaguar);
+}
+
+CANJaguar::~CANJaguar()
+{
+	if (m_jaguar->m_deviceNumber < kMaxJaguars && s_jaguars[m_jaguar->m_deviceNumber] == m_jaguar)
+	{
+		s_jaguars[m_jaguar->m_deviceNumber] = NULL;
+	}
+	delete m_safetyHelper;
+	delete m_jaguar;
+}
+
+float CANJaguar::Get()
+{
+	CountMessage(m_jaguar);
+	return static_cast<float>(m_jaguar->m_setpoint);
+}
+
+/**
+ * @brief Sends a setpoint. One in a sync group is only applied by
+ * UpdateSyncGroup.
+ */
+void CANJaguar::Set(float value, UINT8 syncGroup)
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	if (syncGroup == 0)
+	{
+		m_jaguar->m_setpoint = value;
+	}
+	else
+	{
+		m_jaguar->m_pendingSetpoint = value;
+		m_jaguar->m_pendingSyncGroup = syncGroup;
+	}
+	m_safetyHelper->Feed();
+}
+
+void CANJaguar::Disable()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	m_jaguar->m_controlEnabled = false;
+	m_jaguar->m_setpoint = 0.0;
+}
+
+void CANJaguar::SetSpeedReference(SpeedReference reference)
+{
+	CountMessage(m_jaguar);
+}
+
+void CANJaguar::SetPositionReference(PositionReference reference)
+{
+	CountMessage(m_jaguar);
+}
+
+void CANJaguar::SetPID(double p, double i, double d)
+{
+	CountMessage(m_jaguar);
+	CountMessage(m_jaguar);
+	CountMessage(m_jaguar);
+}
+
+void CANJaguar::EnableControl(double encoderInitialPosition)
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	m_jaguar->m_controlEnabled = true;
+	if (m_jaguar->m_controlMode == kPosition || m_jaguar->m_controlMode == kSpeed)
+	{
+		CountMessage(m_jaguar);
+		m_jaguar->m_position = encoderInitialPosition;
+	}
+}
+
+void CANJaguar::DisableControl()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	m_jaguar->m_controlEnabled = false;
+}
+
+void CANJaguar::ChangeControlMode(ControlMode controlMode)
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	m_jaguar->m_controlMode = controlMode;
+	m_jaguar->m_controlEnabled = false;
+	m_jaguar->m_setpoint = 0.0;
+}
+
+CANJaguar::ControlMode CANJaguar::GetControlMode()
+{
+	return m_jaguar->m_controlMode;
+}
+
+float CANJaguar::GetBusVoltage()
+{
+	CountMessage(m_jaguar);
+	return kBusVoltage;
+}
+
+float CANJaguar::GetOutputVoltage()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	return static_cast<float>(GetOutput(*m_jaguar) * kBusVoltage);
+}
+
+/**
+ * @brief Returns a current proportional to the difference between the
+ * applied voltage and the back EMF of the motor.
+ */
+float CANJaguar::GetOutputCurrent()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	const double current = (GetOutput(*m_jaguar) - m_jaguar->m_speed / Simulation::kMotorFreeSpeed) * 130.0;
+	return static_cast<float>(fabs(current));
+}
+
+float CANJaguar::GetTemperature()
+{
+	CountMessage(m_jaguar);
+	return 25.0f;
+}
+
+double CANJaguar::GetPosition()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	return m_jaguar->m_position;
+}
+
+double CANJaguar::GetSpeed()
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	return m_jaguar->m_speed;
+}
+
+void CANJaguar::ConfigNeutralMode(NeutralMode mode)
+{
+	CountMessage(m_jaguar);
+}
+
+void CANJaguar::ConfigEncoderCodesPerRev(UINT16 codesPerRev)
+{
+	CountMessage(m_jaguar);
+}
+
+void CANJaguar::ConfigMaxOutputVoltage(double voltage)
+{
+	MoveMotor(*m_jaguar);
+	CountMessage(m_jaguar);
+	m_jaguar->m_maxOutputVoltage = voltage;
+}
+
+/**
+ * @brief Applies the setpoints waiting in the sync group, with a single
+ * broadcast message.
+ */
+void CANJaguar::UpdateSyncGroup(UINT8 syncGroup)
+{
+	++s_canMessageCount;
+	for (int i = 0; i < kMaxJaguars; ++i)
+	{
+		SimulatedJaguar* const jaguar = s_jaguars[i];
+		if (jaguar != NULL && jaguar->m_pendingSyncGroup == syncGroup)
+		{
+			MoveMotor(*jaguar);
+			jaguar->m_setpoint = jaguar->m_pendingSetpoint;
+			jaguar->m_pendingSyncGroup = 0;
+		}
+	}
+}
+
+void CANJaguar::SetExpiration(float timeout)
+{
+	m_safetyHelper->SetExpiration(timeout);
+}
+
+float CANJaguar::GetExpiration()
+{
+	return m_safetyHelper->GetExpiration();
+}
+
+bool CANJaguar::IsAlive()
+{
+	return m_safetyHelper->IsAlive();
+}
+
+void CANJaguar::StopMotor()
+{
+	Disable();
+}
+
+void CANJaguar::SetSafetyEnabled(bool enabled)
+{
+	m_safetyHelper->SetSafetyEnabled(enabled);
+}
+
+bool CANJaguar::IsSafetyEnabled()
+{
+	return m_safetyHelper->IsSafetyEnabled();
+}
+
+void CANJaguar::GetDescription(char* desc)
+{
+	sprintf(desc, "CANJaguar ID %d", m_jaguar->m_deviceNumber);
+}
+
+// Sensors
+
+Gyro::Gyro(UINT32 channel)
+{
+}
+
+Gyro::~Gyro()
+{
+}
+
+float Gyro::GetAngle()
+{
+	return s_gyroAngle;
+}
+
+double Gyro::GetRate()
+{
+	return 0.0;
+}
+
+void Gyro::Reset()
+{
+	s_gyroAngle = 0;
+}
+
+void Gyro::SetSensitivity(float voltsPerDegreePerSecond)
+{
+}
+
+ADXL345_I2C::ADXL345_I2C(UINT8 moduleNumber, DataFormat_Range range)
+{
+}
+
+ADXL345_I2C::~ADXL345_I2C()
+{
+}
+
+/**
+ * @brief Returns the acceleration of a robot sitting level, in g.
+ */
+double ADXL345_I2C::GetAcceleration(Axes axis)
+{
+	return (axis == kAxis_Z) ? 1.0 : 0.0;
+}
+
+ADXL345_I2C::AllAxes ADXL345_I2C::GetAccelerations()
+{
+	AllAxes axes;
+	axes.XAxis = GetAcceleration(kAxis_X);
+	axes.YAxis = GetAcceleration(kAxis_Y);
+	axes.ZAxis = GetAcceleration(kAxis_Z);
+	return axes;
+}
+
+// Robot
+
+RobotBase::RobotBase()
+{
+}
+
+RobotBase::~RobotBase()
+{
+}
+
+bool RobotBase::IsEnabled()
+{
+	return s_enabled;
+}
+
+bool RobotBase::IsDisabled()
+{
+	return !s_enabled;
+}
+
+bool RobotBase::IsAutonomous()
+{
+	return s_autonomous;
+}
+
+bool RobotBase::IsOperatorControl()
+{
+	return !s_autonomous;
+}
+
+IterativeRobot::IterativeRobot()
+{
+}
+
+IterativeRobot::~IterativeRobot()
+{
+}
+
+/**
+ * @brief Calls RobotInit and then, for every driver station packet until
+ * the script ends the run, the Init function of the mode when it changes
+ * and its Periodic function. The host time of each Periodic call is
+ * recorded in the LoopStatistics.
+ */
+void IterativeRobot::StartCompetition()
+{
+	RobotInit();
+	Simulation::Mode lastMode = Simulation::kModes;
+	UINT64 packetTime = s_time;
+	while (s_script == NULL || s_script(GetFPGATime()))
+	{
+		const Simulation::Mode mode = !s_enabled ? Simulation::kDisabled :
+			(s_autonomous ? Simulation::kAutonomous : Simulation::kTeleop);
+		if (mode != lastMode)
+		{
+			switch (mode)
+			{
+				case Simulation::kDisabled:
+					DisabledInit();
+					break;
+				case Simulation::kAutonomous:
+					AutonomousInit();
+					break;
+				default:
+					TeleopInit();
+					break;
+			}
+			lastMode = mode;
+		}
+
+		const double start = HostTime();
+		switch (mode)
+		{
+			case Simulation::kDisabled:
+				DisabledPeriodic();
+				break;
+			case Simulation::kAutonomous:
+				AutonomousPeriodic();
+				break;
+			default:
+				TeleopPeriodic();
+				break;
+		}
+		const double elapsed = HostTime() - start;
+		Simulation::LoopStatistics& statistics = s_loopStatistics[mode];
+		if (statistics.m_count == 0 || elapsed < statistics.m_minTime)
+		{
+			statistics.m_minTime = elapsed;
+		}
+		++statistics.m_count;
+		statistics.m_totalTime += elapsed;
+		if (elapsed > statistics.m_maxTime)
+		{
+			statistics.m_maxTime = elapsed;
+		}
+
+		packetTime += Simulation::kPacketPeriod;
+		pthread_mutex_lock(&s_lock);
+		WaitUntil(packetTime);
+		pthread_mutex_unlock(&s_lock);
+	}
+}
+
+void IterativeRobot::RobotInit()
+{
+}
+
+void IterativeRobot::DisabledInit()
+{
+}
+
+void IterativeRobot::AutonomousInit()
+{
+}
+
+void IterativeRobot::TeleopInit()
+{
+}
+
+void IterativeRobot::DisabledPeriodic()
+{
+}
+
+void IterativeRobot::AutonomousPeriodic()
+{
+}
+
+void IterativeRobot::TeleopPeriodic()
+{
+}
+
+// Simulation
+
+void Simulation::Run(Script script)
+{
+	s_script = script;
+	RobotBase* const robot = FRC_userClassFactory();
+	robot->StartCompetition();
+}
+
+void Simulation::SetEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+void Simulation::SetAutonomous(bool autonomous)
+{
+	s_autonomous = autonomous;
+}
+
+void Simulation::SetJoystickAxis(UINT32 port, UINT32 axis, float value)
+{
+	if (port >= 1 && port <= kJoystickPorts && axis >= 1 && axis <= kJoystickAxes)
+	{
+		s_axes[port - 1][axis - 1] = value;
+	}
+}
+
+void Simulation::SetJoystickButton(UINT32 port, UINT32 button, bool pressed)
+{
+	if (port >= 1 && port <= kJoystickPorts && button >= 1 && button <= kJoystickButtons)
+	{
+		s_buttons[port - 1][button - 1] = pressed;
+	}
+}
+
+void Simulation::SetGyroAngle(float angle)
+{
+	s_gyroAngle = angle;
+}
+
+const Simulation::LoopStatistics& Simulation::GetLoopStatistics(Mode mode)
+{
+	return s_loopStatistics[mode];
+}
+
+UINT32 Simulation::GetCANMessageCount()
+{
+	return s_canMessageCount;
+}
+
+UINT32 Simulation::GetCANMessageCount(UINT8 deviceNumber)
+{
+	const SimulatedJaguar* const jaguar = FindJaguar(deviceNumber);
+	return (jaguar != NULL) ? jaguar->m_messageCount : 0;
+}
+
+double Simulation::GetJaguarOutput(UINT8 deviceNumber)
+{
+	SimulatedJaguar* const jaguar = FindJaguar(deviceNumber);
+	return (jaguar != NULL) ? GetOutput(*jaguar) : 0.0;
+}
+
+double Simulation::GetJaguarSpeed(UINT8 deviceNumber)
+{
+	SimulatedJaguar* const jaguar = FindJaguar(deviceNumber);
+	if (jaguar == NULL)
+	{
+		return 0.0;
+	}
+	MoveMotor(*jaguar);
+	return jaguar->m_speed;
+}
+
+double Simulation::GetJaguarPosition(UINT8 deviceNumber)
+{
+	SimulatedJaguar* const jaguar = FindJaguar(deviceNumber);
+	if (jaguar == NULL)
+	{
+		return 0.0;
+	}
+	MoveMotor(*jaguar);
+	return jaguar->m_position;
+}
+
+void Simulation::SetJaguarMotion(UINT8 deviceNumber, double position, double speed)
+{
+	SimulatedJaguar* const jaguar = FindJaguar(deviceNumber);
+	if (jaguar != NULL)
+	{
+		MoveMotor(*jaguar);
+		jaguar->m_position = position;
+		jaguar->m_speed = speed;
+		jaguar->m_scripted = true;
+	}
+}
+
+UINT32 Simulation::GetTaskSwitchCount()
+{
+	return s_taskSwitches;
+}
@@ -0,0 +1,97 @@
+/*
+ * Simulation.h
+ *
+ * Scripts the simulated driver station and reads back the simulated
+ * hardware, see WPILib.h. A simulation sets a script, creates the robot
+ * and calls Run, which runs the robot's periodic loop once for every
+ * driver station packet until the script returns false. The time only
+ * moves when every task is waiting, so a run takes as long as the code
+ * needs to execute rather than the simulated time, and gives the same
+ * results on every run. This file is not part of the robot build.
+ */
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "WPILib.h"
+
+namespace Simulation
+{
+	//! The driver station sends a packet, and IterativeRobot runs, this often
+	static const UINT32 kPacketPeriod = 20000;
+	//! Simulated VxWorks clock ticks per second
+	static const int kClockRate = 1000;
+	//! Free speed of a simulated drive motor, in the units of CANJaguar::GetSpeed
+	static const double kMotorFreeSpeed = 5310.0;
+	//! Time constant of the simulated motor speed, in seconds
+	static const double kMotorTimeConstant = 0.05;
+
+	//! Called at the start of every driver station packet with the time
+	//! in microseconds. Returns false to end the run.
+	typedef bool (*Script)(UINT32 time);
+
+	//! Loop timing for one robot mode, measured on the host
+	struct LoopStatistics
+	{
+		UINT32 m_count;			//!< Number of Periodic calls
+		double m_totalTime;		//!< Host time spent in Periodic, in seconds
+		double m_minTime;		//!< Shortest Periodic call, in seconds
+		double m_maxTime;		//!< Longest Periodic call, in seconds
+	};
+
+	//! The robot modes, as reported by LoopStatistics
+	enum Mode
+	{
+		kDisabled,
+		kAutonomous,
+		kTeleop,
+		kModes
+	};
+
+	//! Creates the robot with START_ROBOT_CLASS's factory and runs it
+	//! with the script
+	void Run(Script script);
+
+	//! Sets whether the robot is enabled
+	void SetEnabled(bool enabled);
+
+	//! Sets whether the robot is in autonomous rather than teleop
+	void SetAutonomous(bool autonomous);
+
+	//! Sets a joystick axis, ports and axes start at 1 as on the driver station
+	void SetJoystickAxis(UINT32 port, UINT32 axis, float value);
+
+	//! Sets a joystick button, ports and buttons start at 1
+	void SetJoystickButton(UINT32 port, UINT32 button, bool pressed);
+
+	//! Sets the angle returned by every Gyro, in degrees
+	void SetGyroAngle(float angle);
+
+	//! Returns the host loop timing for a robot mode
+	const LoopStatistics& GetLoopStatistics(Mode mode);
+
+	//! Returns the number of CAN messages sent to all of the Jaguars
+	UINT32 GetCANMessageCount();
+
+	//! Returns the number of CAN messages sent to one Jaguar
+	UINT32 GetCANMessageCount(UINT8 deviceNumber);
+
+	//! Returns the output a Jaguar is applying, as a fraction of the bus
+	//! voltage. Zero when disabled or if there is no such Jaguar.
+	double GetJaguarOutput(UINT8 deviceNumber);
+
+	//! Returns the speed of a Jaguar's motor without a CAN message
+	double GetJaguarSpeed(UINT8 deviceNumber);
+
+	//! Returns the position of a Jaguar's motor without a CAN message
+	double GetJaguarPosition(UINT8 deviceNumber);
+
+	//! Sets the position and speed of a Jaguar's motor, for tests that
+	//! feed synthetic encoder data. The motor then holds that speed until
+	//! it is set again, whatever the Jaguar is told to output.
+	void SetJaguarMotion(UINT8 deviceNumber, double position, double speed);
+
+	//! Returns the number of task switches so far
+	UINT32 GetTaskSwitchCount();
+}
+
+#endif
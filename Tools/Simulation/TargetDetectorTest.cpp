@@ -0,0 +1,296 @@
+/*
+ * TargetDetectorTest.cpp
+ *
+ * Tests TargetDetector against a plain 8-connected flood fill of the
+ * thresholded image. Build and run it with "make -C Tools check".
+ *
+ * Random frames of rectangles, discs and single pixel noise in the target
+ * colour are labelled by both, at widths that are and are not a multiple
+ * of 32 and with rows longer than the image. The blobs reported must have
+ * the same areas, centroids, bounding boxes and order. A frame with more
+ * than kTargetMaxRuns runs must be marked as overflowed.
+ *
+ * The program then times both on 320x240 frames. The timings are for the
+ * host, not the cRIO, so only compare them with each other. The program
+ * exits with a failure if any check fails. This file is not part of the
+ * robot build.
+ */
+#include "../../Robotmap.h"
+#include "../../Classes/TargetDetector.h"
+#include <math.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+namespace
+{
+	const int kFrames = 200;		//!< Number of random frames checked
+	const int kTimedFrames = 200;	//!< Number of frames in each timed run
+	const float kTolerance = 1e-3;	//!< Largest difference between centroids
+
+	int s_failures = 0;
+
+	//! The frame being labelled, with room for rows longer than the image
+	HSLValue s_pixels[kCameraImageHeight][kCameraImageWidth + 16];
+	//! The flood fill's blob number of each pixel, -1 until it is labelled
+	int s_labels[kCameraImageHeight][kCameraImageWidth];
+	//! The flood fill's stack of pixels still to visit
+	int s_stack[kCameraImageHeight * kCameraImageWidth];
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description, int frame)
+	{
+		if (!passed)
+		{
+			printf("FAILED: frame %d: %s\n", frame, description);
+			++s_failures;
+		}
+	}
+
+	//! Returns the host time in microseconds
+	double Now()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return tv.tv_sec * 1e6 + tv.tv_usec;
+	}
+
+	//! A small repeatable random number generator
+	unsigned s_seed = 12345;
+	int Random(int limit)
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return (s_seed >> 8) % limit;
+	}
+
+	//! Returns a pixel inside the target ranges, or one outside them
+	HSLValue Pixel(bool target)
+	{
+		HSLValue pixel;
+		pixel.H = target ? kTargetHueMin + Random(kTargetHueMax - kTargetHueMin + 1) : Random(kTargetHueMin);
+		pixel.S = target ? kTargetSaturationMin + Random(256 - kTargetSaturationMin) : Random(256);
+		pixel.L = target ? kTargetLuminanceMin + Random(256 - kTargetLuminanceMin) : Random(256);
+		pixel.alpha = 0;
+		return pixel;
+	}
+
+	//! The flood fill's threshold, written out the obvious way
+	bool IsTarget(const HSLValue& pixel)
+	{
+		return pixel.H >= kTargetHueMin && pixel.H <= kTargetHueMax &&
+			pixel.S >= kTargetSaturationMin && pixel.S <= kTargetSaturationMax &&
+			pixel.L >= kTargetLuminanceMin && pixel.L <= kTargetLuminanceMax;
+	}
+
+	//! Fills a frame with rectangles, discs and noise
+	void MakeFrame(int width, int height, int shapes, int noise)
+	{
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < kCameraImageWidth + 16; ++x)
+			{
+				s_pixels[y][x] = Pixel(false);
+			}
+		}
+		for (int i = 0; i < shapes; ++i)
+		{
+			const int centerX = Random(width);
+			const int centerY = Random(height);
+			const int sizeX = 1 + Random(40);
+			const int sizeY = 1 + Random(30);
+			const bool disc = Random(2) == 0;
+			for (int y = centerY - sizeY; y <= centerY + sizeY; ++y)
+			{
+				for (int x = centerX - sizeX; x <= centerX + sizeX; ++x)
+				{
+					if (x < 0 || x >= width || y < 0 || y >= height)
+					{
+						continue;
+					}
+					const double dx = static_cast<double>(x - centerX) / sizeX;
+					const double dy = static_cast<double>(y - centerY) / sizeY;
+					if (!disc || dx * dx + dy * dy <= 1.0)
+					{
+						s_pixels[y][x] = Pixel(true);
+					}
+				}
+			}
+		}
+		for (int i = 0; i < noise; ++i)
+		{
+			s_pixels[Random(height)][Random(width)] = Pixel(true);
+		}
+	}
+
+	/**
+	 * @brief Labels a frame with a flood fill and reports the blobs the way
+	 * TargetDetector does: the largest first, blobs of equal area in the
+	 * order their first pixels are scanned.
+	 */
+	void FloodFill(int width, int height, TargetReport& report)
+	{
+		static TargetBlob blobs[kCameraImageHeight * kCameraImageWidth];
+		int blobCount = 0;
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				s_labels[y][x] = -1;
+			}
+		}
+		for (int startY = 0; startY < height; ++startY)
+		{
+			for (int startX = 0; startX < width; ++startX)
+			{
+				if (s_labels[startY][startX] >= 0 || !IsTarget(s_pixels[startY][startX]))
+				{
+					continue;
+				}
+				int stackSize = 0;
+				double sumX = 0;
+				double sumY = 0;
+				TargetBlob& blob = blobs[blobCount];
+				blob.m_area = 0;
+				blob.m_left = blob.m_right = startX;
+				blob.m_top = blob.m_bottom = startY;
+				s_labels[startY][startX] = blobCount;
+				s_stack[stackSize++] = startY * width + startX;
+				while (stackSize > 0)
+				{
+					const int y = s_stack[--stackSize] / width;
+					const int x = s_stack[stackSize] % width;
+					++blob.m_area;
+					sumX += x;
+					sumY += y;
+					if (x < blob.m_left) blob.m_left = x;
+					if (x > blob.m_right) blob.m_right = x;
+					if (y < blob.m_top) blob.m_top = y;
+					if (y > blob.m_bottom) blob.m_bottom = y;
+					for (int ny = y - 1; ny <= y + 1; ++ny)
+					{
+						for (int nx = x - 1; nx <= x + 1; ++nx)
+						{
+							if (nx >= 0 && nx < width && ny >= 0 && ny < height &&
+								s_labels[ny][nx] < 0 && IsTarget(s_pixels[ny][nx]))
+							{
+								s_labels[ny][nx] = blobCount;
+								s_stack[stackSize++] = ny * width + nx;
+							}
+						}
+					}
+				}
+				blob.m_centerX = sumX / blob.m_area;
+				blob.m_centerY = sumY / blob.m_area;
+				blob.m_aspectRatio = static_cast<float>(blob.m_right - blob.m_left + 1) / (blob.m_bottom - blob.m_top + 1);
+				++blobCount;
+			}
+		}
+
+		report.m_blobCount = 0;
+		report.m_overflow = false;
+		for (int i = 0; i < blobCount; ++i)
+		{
+			if (blobs[i].m_area < kTargetMinArea)
+			{
+				continue;
+			}
+			int slot = report.m_blobCount;
+			while (slot > 0 && report.m_blobs[slot - 1].m_area < blobs[i].m_area)
+			{
+				if (slot < kTargetMaxBlobs)
+				{
+					report.m_blobs[slot] = report.m_blobs[slot - 1];
+				}
+				--slot;
+			}
+			if (slot < kTargetMaxBlobs)
+			{
+				report.m_blobs[slot] = blobs[i];
+				if (report.m_blobCount < kTargetMaxBlobs)
+				{
+					++report.m_blobCount;
+				}
+			}
+		}
+	}
+
+	//! Checks that the detector found the same blobs as the flood fill
+	void Compare(const TargetReport& detected, const TargetReport& expected, int frame)
+	{
+		Check(!detected.m_overflow, "the frame overflowed", frame);
+		Check(detected.m_blobCount == expected.m_blobCount, "the number of blobs differs", frame);
+		for (int i = 0; i < detected.m_blobCount && i < expected.m_blobCount; ++i)
+		{
+			const TargetBlob& a = detected.m_blobs[i];
+			const TargetBlob& b = expected.m_blobs[i];
+			Check(a.m_area == b.m_area, "a blob's area differs", frame);
+			Check(fabs(a.m_centerX - b.m_centerX) < kTolerance && fabs(a.m_centerY - b.m_centerY) < kTolerance,
+				"a blob's centroid differs", frame);
+			Check(a.m_left == b.m_left && a.m_top == b.m_top && a.m_right == b.m_right && a.m_bottom == b.m_bottom,
+				"a blob's bounding box differs", frame);
+			Check(fabs(a.m_aspectRatio - b.m_aspectRatio) < kTolerance, "a blob's aspect ratio differs", frame);
+		}
+	}
+}
+
+int main()
+{
+	// The detector's working memory is too large for the stack
+	TargetDetector* detector = new TargetDetector();
+	const int widths[] = {kCameraImageWidth, 300, 257, 64, 33, 31};
+	const int kWidths = sizeof(widths) / sizeof(widths[0]);
+	const int pixelsPerLine = kCameraImageWidth + 16;
+	TargetReport detected;
+	TargetReport expected;
+	int blobs = 0;
+
+	for (int frame = 0; frame < kFrames; ++frame)
+	{
+		const int width = widths[frame % kWidths];
+		const int height = kCameraImageHeight - Random(kCameraImageHeight / 2);
+		MakeFrame(width, height, 1 + Random(12), Random(400));
+		detector->Detect(&s_pixels[0][0], width, height, pixelsPerLine, detected);
+		FloodFill(width, height, expected);
+		Compare(detected, expected, frame);
+		blobs += expected.m_blobCount;
+	}
+	Check(blobs > kFrames, "the random frames have too few blobs to test anything", -1);
+
+	// Every other pixel set gives a run for every two pixels
+	for (int y = 0; y < kCameraImageHeight; ++y)
+	{
+		for (int x = 0; x < kCameraImageWidth; ++x)
+		{
+			s_pixels[y][x] = Pixel(x % 2 == 0);
+		}
+	}
+	detector->Detect(&s_pixels[0][0], kCameraImageWidth, kCameraImageHeight, pixelsPerLine, detected);
+	Check(detected.m_overflow, "a frame with too many runs is not marked as overflowed", -1);
+
+	// Time a frame with a few targets and some noise, as the camera sees
+	MakeFrame(kCameraImageWidth, kCameraImageHeight, 4, 200);
+	double start = Now();
+	for (int i = 0; i < kTimedFrames; ++i)
+	{
+		detector->Detect(&s_pixels[0][0], kCameraImageWidth, kCameraImageHeight, pixelsPerLine, detected);
+	}
+	const double detectorTime = (Now() - start) / kTimedFrames;
+	start = Now();
+	for (int i = 0; i < kTimedFrames; ++i)
+	{
+		FloodFill(kCameraImageWidth, kCameraImageHeight, expected);
+	}
+	const double floodFillTime = (Now() - start) / kTimedFrames;
+	Compare(detected, expected, -1);
+	printf("%dx%d frame     Time per frame\n", kCameraImageWidth, kCameraImageHeight);
+	printf("TargetDetector  %8.1f us\n", detectorTime);
+	printf("Flood fill      %8.1f us\n", floodFillTime);
+
+	delete detector;
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,453 @@
+/*
+ * WPILib.h
+ *
+ * The part of WPILib and VxWorks used by the robot code, simulated on a
+ * Linux host. The declarations match the 2012 WPILib so that the robot
+ * code compiles unchanged, and SimulatedWPILib.cpp implements them on a
+ * virtual clock. Simulation.h has the calls a simulation uses to script
+ * the driver station and read back the motors. This file is not part of
+ * the robot build.
+ */
+#ifndef SIMULATED_WPILIB_H
+#define SIMULATED_WPILIB_H
+
+#include <stdio.h>
+#include <string.h>
+#include <exception>
+#include <string>
+
+using namespace std;
+
+// VxWorks types
+typedef unsigned int UINT32;
+typedef int INT32;
+typedef unsigned short UINT16;
+typedef short INT16;
+typedef unsigned char UINT8;
+typedef signed char INT8;
+typedef unsigned long long UINT64;
+typedef long long INT64;
+typedef int STATUS;
+typedef int (*FUNCPTR)(...);
+typedef struct semaphore* SEM_ID;
+
+#define OK 0
+#define ERROR (-1)
+#define WAIT_FOREVER (-1)
+#define NO_WAIT 0
+#define SEM_Q_FIFO 0x00
+#define SEM_Q_PRIORITY 0x01
+#define SEM_DELETE_SAFE 0x04
+#define SEM_INVERSION_SAFE 0x08
+#define SEM_EMPTY 0
+#define SEM_FULL 1
+#define IMAQ_FUNC extern "C"
+
+// VxWorks kernel, see SimulatedWPILib.cpp for how tasks are scheduled
+SEM_ID semBCreate(int options, int initialState);
+SEM_ID semMCreate(int options);
+SEM_ID semCCreate(int options, int initialCount);
+STATUS semTake(SEM_ID semaphore, int timeout);
+STATUS semGive(SEM_ID semaphore);
+STATUS semFlush(SEM_ID semaphore);
+STATUS semDelete(SEM_ID semaphore);
+STATUS taskDelay(int ticks);
+STATUS taskLock();
+STATUS taskUnlock();
+int sysClkRateGet();
+int intLock();
+void intUnlock(int lockKey);
+IMAQ_FUNC int Priv_SetWriteFileAllowed(UINT32 enable);
+
+// WPILib utility and timer functions
+UINT32 GetFPGATime();
+double GetTime();
+void Wait(double seconds);
+
+/**
+ * @brief Takes a semaphore for the lifetime of the object.
+ */
+class Synchronized
+{
+public:
+	explicit Synchronized(SEM_ID semaphore);
+	virtual ~Synchronized();
+private:
+	SEM_ID m_semaphore;
+};
+
+/**
+ * @brief A VxWorks task. The simulation runs each task on its own thread
+ * but only lets one run at a time, see SimulatedWPILib.cpp.
+ */
+class Task
+{
+public:
+	static const UINT32 kDefaultPriority = 101;
+	static const INT32 kInvalidTaskID = -1;
+
+	Task(const char* name, FUNCPTR function, INT32 priority = kDefaultPriority, UINT32 stackSize = 20000);
+	virtual ~Task();
+	bool Start(UINT32 arg0 = 0, UINT32 arg1 = 0, UINT32 arg2 = 0, UINT32 arg3 = 0, UINT32 arg4 = 0,
+		UINT32 arg5 = 0, UINT32 arg6 = 0, UINT32 arg7 = 0, UINT32 arg8 = 0, UINT32 arg9 = 0);
+	bool Stop();
+	bool Verify();
+	INT32 GetPriority();
+	const char* GetName();
+
+private:
+	std::string m_name;
+	FUNCPTR m_function;
+	INT32 m_priority;
+	struct SimulatedTask* m_task;
+};
+
+class Command;
+
+/**
+ * @brief A robot subsystem, see Scheduler.
+ */
+class Subsystem
+{
+public:
+	Subsystem(const char* name);
+	virtual ~Subsystem();
+	virtual void InitDefaultCommand();
+	void SetDefaultCommand(Command* command);
+	Command* GetDefaultCommand();
+	Command* GetCurrentCommand();
+	const char* GetName();
+
+private:
+	friend class Scheduler;
+	std::string m_name;
+	Command* m_defaultCommand;
+	bool m_initializedDefaultCommand;
+	Command* m_currentCommand;
+};
+
+/**
+ * @brief A command run by the Scheduler.
+ */
+class Command
+{
+public:
+	Command();
+	Command(const char* name);
+	virtual ~Command();
+	void Requires(Subsystem* subsystem);
+	void Start();
+	void Cancel();
+	bool IsRunning();
+	const char* GetName();
+
+protected:
+	virtual void Initialize() = 0;
+	virtual void Execute() = 0;
+	virtual bool IsFinished() = 0;
+	virtual void End() = 0;
+	virtual void Interrupted() = 0;
+
+private:
+	friend class Scheduler;
+	enum { kMaxRequirements = 4 };
+	std::string m_name;
+	Subsystem* m_requirements[kMaxRequirements];
+	int m_requirementCount;
+	bool m_running;
+	bool m_initialized;
+};
+
+/**
+ * @brief Runs the commands, as the WPILib command scheduler does: a
+ * started command interrupts the running commands needing the same
+ * subsystems, and an idle subsystem runs its default command.
+ */
+class Scheduler
+{
+public:
+	static Scheduler* GetInstance();
+	void Run();
+	void AddCommand(Command* command);
+	void RegisterSubsystem(Subsystem* subsystem);
+	void Remove(Command* command);
+
+private:
+	Scheduler();
+	enum { kMaxCommands = 32, kMaxSubsystems = 16 };
+	Command* m_additions[kMaxCommands];
+	int m_additionCount;
+	Command* m_commands[kMaxCommands];
+	int m_commandCount;
+	Subsystem* m_subsystems[kMaxSubsystems];
+	int m_subsystemCount;
+	void ProcessAddition(Command* command);
+};
+
+/**
+ * @brief The driver station, scripted by Simulation::SetEnabled and
+ * Simulation::SetAutonomous.
+ */
+class DriverStation
+{
+public:
+	static DriverStation* GetInstance();
+	bool IsEnabled();
+	bool IsDisabled();
+	bool IsAutonomous();
+	bool IsOperatorControl();
+	float GetBatteryVoltage();
+};
+
+/**
+ * @brief A joystick or game pad, scripted by Simulation::SetJoystickAxis
+ * and Simulation::SetJoystickButton.
+ */
+class GenericHID
+{
+public:
+	enum JoystickHand {kLeftHand = 0, kRightHand = 1};
+	virtual ~GenericHID() {}
+	virtual float GetX(JoystickHand hand = kRightHand) = 0;
+	virtual float GetY(JoystickHand hand = kRightHand) = 0;
+	virtual float GetRawAxis(UINT32 axis) = 0;
+	virtual bool GetRawButton(UINT32 button) = 0;
+};
+
+class Joystick : public GenericHID
+{
+public:
+	explicit Joystick(UINT32 port);
+	virtual ~Joystick();
+	virtual float GetX(JoystickHand hand = kRightHand);
+	virtual float GetY(JoystickHand hand = kRightHand);
+	virtual float GetZ();
+	virtual float GetTwist();
+	virtual float GetThrottle();
+	virtual float GetRawAxis(UINT32 axis);
+	virtual bool GetTrigger(JoystickHand hand = kRightHand);
+	virtual bool GetTop(JoystickHand hand = kRightHand);
+	virtual bool GetRawButton(UINT32 button);
+
+private:
+	UINT32 m_port;
+};
+
+class JoystickButton
+{
+public:
+	JoystickButton(GenericHID* joystick, int buttonNumber);
+	virtual ~JoystickButton();
+	virtual bool Get();
+	void WhenPressed(Command* command);
+	void WhileHeld(Command* command);
+	void WhenReleased(Command* command);
+
+private:
+	GenericHID* m_joystick;
+	int m_buttonNumber;
+};
+
+class MotorSafety
+{
+public:
+	virtual ~MotorSafety() {}
+	virtual void SetExpiration(float timeout) = 0;
+	virtual float GetExpiration() = 0;
+	virtual bool IsAlive() = 0;
+	virtual void StopMotor() = 0;
+	virtual void SetSafetyEnabled(bool enabled) = 0;
+	virtual bool IsSafetyEnabled() = 0;
+	virtual void GetDescription(char* desc) = 0;
+};
+
+/**
+ * @brief Stops a MotorSafety object that is not fed within its expiration
+ * time. The simulation does not check, it only records the feeds.
+ */
+class MotorSafetyHelper
+{
+public:
+	explicit MotorSafetyHelper(MotorSafety* safeObject);
+	~MotorSafetyHelper();
+	void Feed();
+	void SetExpiration(float expirationTime);
+	float GetExpiration();
+	bool IsAlive();
+	void Check();
+	void SetSafetyEnabled(bool enabled);
+	bool IsSafetyEnabled();
+
+private:
+	MotorSafety* m_safeObject;
+	float m_expiration;
+	bool m_enabled;
+	UINT32 m_stopTime;
+};
+
+class SpeedController
+{
+public:
+	virtual ~SpeedController() {}
+	virtual void Set(float value, UINT8 syncGroup = 0) = 0;
+	virtual float Get() = 0;
+	virtual void Disable() = 0;
+};
+
+/**
+ * @brief The 2012 RobotDrive, only the constructor and the MotorSafety
+ * interface are used by AdvancedRobotDrive.
+ */
+class RobotDrive : public MotorSafety
+{
+public:
+	RobotDrive(SpeedController& frontLeftMotor, SpeedController& rearLeftMotor,
+		SpeedController& frontRightMotor, SpeedController& rearRightMotor);
+	virtual ~RobotDrive();
+	virtual void SetExpiration(float timeout);
+	virtual float GetExpiration();
+	virtual bool IsAlive();
+	virtual void StopMotor();
+	virtual void SetSafetyEnabled(bool enabled);
+	virtual bool IsSafetyEnabled();
+	virtual void GetDescription(char* desc);
+
+protected:
+	SpeedController* m_frontLeftMotor;
+	SpeedController* m_frontRightMotor;
+	SpeedController* m_rearLeftMotor;
+	SpeedController* m_rearRightMotor;
+	MotorSafetyHelper* m_safetyHelper;
+};
+
+/**
+ * @brief A Jaguar on the CAN bus, simulated as a motor with a first order
+ * response. Every call that would send a message on the bus is counted,
+ * see Simulation::GetCANMessageCount.
+ */
+class CANJaguar : public MotorSafety, public SpeedController
+{
+public:
+	typedef enum {kPercentVbus, kCurrent, kSpeed, kPosition, kVoltage} ControlMode;
+	typedef enum {kSpeedRef_Encoder = 0, kSpeedRef_InvEncoder = 2, kSpeedRef_QuadEncoder = 3, kSpeedRef_None = 0xFF} SpeedReference;
+	typedef enum {kPosRef_QuadEncoder = 0, kPosRef_Potentiometer = 1, kPosRef_None = 0xFF} PositionReference;
+	typedef enum {kNeutralMode_Jumper = 0, kNeutralMode_Brake = 1, kNeutralMode_Coast = 2} NeutralMode;
+	typedef enum {kLimitMode_SwitchInputsOnly = 0, kLimitMode_SoftPositionLimits = 1} LimitMode;
+
+	explicit CANJaguar(UINT8 deviceNumber, ControlMode controlMode = kPercentVbus);
+	virtual ~CANJaguar();
+
+	// SpeedController
+	virtual float Get();
+	virtual void Set(float value, UINT8 syncGroup = 0);
+	virtual void Disable();
+
+	void SetSpeedReference(SpeedReference reference);
+	void SetPositionReference(PositionReference reference);
+	void SetPID(double p, double i, double d);
+	void EnableControl(double encoderInitialPosition = 0.0);
+	void DisableControl();
+	void ChangeControlMode(ControlMode controlMode);
+	ControlMode GetControlMode();
+	float GetBusVoltage();
+	float GetOutputVoltage();
+	float GetOutputCurrent();
+	float GetTemperature();
+	double GetPosition();
+	double GetSpeed();
+	void ConfigNeutralMode(NeutralMode mode);
+	void ConfigEncoderCodesPerRev(UINT16 codesPerRev);
+	void ConfigMaxOutputVoltage(double voltage);
+	static void UpdateSyncGroup(UINT8 syncGroup);
+
+	// MotorSafety
+	virtual void SetExpiration(float timeout);
+	virtual float GetExpiration();
+	virtual bool IsAlive();
+	virtual void StopMotor();
+	virtual void SetSafetyEnabled(bool enabled);
+	virtual bool IsSafetyEnabled();
+	virtual void GetDescription(char* desc);
+
+private:
+	struct SimulatedJaguar* m_jaguar;
+	MotorSafetyHelper* m_safetyHelper;
+};
+
+class Gyro
+{
+public:
+	explicit Gyro(UINT32 channel);
+	virtual ~Gyro();
+	virtual float GetAngle();
+	virtual double GetRate();
+	virtual void Reset();
+	void SetSensitivity(float voltsPerDegreePerSecond);
+};
+
+class ADXL345_I2C
+{
+public:
+	enum DataFormat_Range {kRange_2G = 0x00, kRange_4G = 0x01, kRange_8G = 0x02, kRange_16G = 0x03};
+	enum Axes {kAxis_X = 0x00, kAxis_Y = 0x02, kAxis_Z = 0x04};
+	struct AllAxes
+	{
+		double XAxis;
+		double YAxis;
+		double ZAxis;
+	};
+
+	explicit ADXL345_I2C(UINT8 moduleNumber, DataFormat_Range range = kRange_2G);
+	virtual ~ADXL345_I2C();
+	virtual double GetAcceleration(Axes axis);
+	virtual AllAxes GetAccelerations();
+};
+
+/**
+ * @brief The robot, run by StartCompetition.
+ */
+class RobotBase
+{
+public:
+	virtual ~RobotBase();
+	virtual void StartCompetition() = 0;
+	bool IsEnabled();
+	bool IsDisabled();
+	bool IsAutonomous();
+	bool IsOperatorControl();
+
+protected:
+	RobotBase();
+};
+
+/**
+ * @brief Calls the Init functions when the mode changes and the Periodic
+ * functions every driver station packet, see Simulation::Run.
+ */
+class IterativeRobot : public RobotBase
+{
+public:
+	virtual void StartCompetition();
+	virtual void RobotInit();
+	virtual void DisabledInit();
+	virtual void AutonomousInit();
+	virtual void TeleopInit();
+	virtual void DisabledPeriodic();
+	virtual void AutonomousPeriodic();
+	virtual void TeleopPeriodic();
+
+protected:
+	IterativeRobot();
+	virtual ~IterativeRobot();
+};
+
+//! Creates the robot, defined by START_ROBOT_CLASS
+RobotBase* FRC_userClassFactory();
+
+#define START_ROBOT_CLASS(_ClassName_) \
+	RobotBase* FRC_userClassFactory() \
+	{ \
+		return new _ClassName_(); \
+	}
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * ioLib.h
+ *
+ * The VxWorks file functions used by LogSystem, see WPILib.h. This file
+ * is not part of the robot build.
+ */
+#ifndef SIMULATED_IOLIB_H
+#define SIMULATED_IOLIB_H
+
+#include "WPILib.h"
+
+#define FIOCONTIG 20
+
+int ioctl(int fd, int function, int arg);
+STATUS mkdir(const char* path);
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ * nivision.h
+ *
+ * Only the pixel type TargetDetector uses, laid out as in the NI vision
+ * library. See WPILib.h. This file is not part of the robot build.
+ */
+#ifndef NIVISION_H
+#define NIVISION_H
+
+typedef struct HSLValue_struct
+{
+	unsigned char L;
+	unsigned char S;
+	unsigned char H;
+	unsigned char alpha;
+} HSLValue;
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * TelemetryDecoder.cpp
+ *
+ * Host side tool that converts a telemetry file written by
+ * TelemetryRecorder into CSV, with one column per channel and a header
+ * row of channel names and units. Build it on the host with:
+ *
+ *     g++ -o TelemetryDecoder Tools/TelemetryDecoder.cpp
+ *
+ * Usage:
+ *
+ *     TelemetryDecoder telemetry.bin [output.csv]
+ *
+ * The output is written to stdout when no output file is given. This file
+ * is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include "../Classes/TelemetryFormat.h"
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+	//! Reverses the byte order of a 32 bit value
+	unsigned int Swap(unsigned int value)
+	{
+		return ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) |
+			((value & 0x00FF0000) >> 8) | ((value & 0xFF000000) >> 24);
+	}
+
+	//! Reverses the byte order of a 16 bit value
+	unsigned short Swap(unsigned short value)
+	{
+		return static_cast<unsigned short> ((value << 8) | (value >> 8));
+	}
+
+	//! Reads count 32 bit values, swapping them if required
+	bool ReadColumn(FILE* in, unsigned int* column, unsigned count, bool swap)
+	{
+		if (count > 0 && fread(column, sizeof (column[0]), count, in) != count)
+		{
+			return false;
+		}
+		if (swap)
+		{
+			for (unsigned i = 0; i < count; ++i) column[i] = Swap(column[i]);
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s telemetry.bin [output.csv]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* in = fopen(argv[1], "rb");
+	if (in == NULL)
+	{
+		fprintf(stderr, "Unable to open %s\n", argv[1]);
+		return 1;
+	}
+	FILE* out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+	if (out == NULL)
+	{
+		fprintf(stderr, "Unable to create %s\n", argv[2]);
+		return 1;
+	}
+
+	TelemetryHeader header;
+	if (fread(&header, sizeof (header), 1, in) != 1)
+	{
+		fprintf(stderr, "%s is too short to be a telemetry file\n", argv[1]);
+		return 1;
+	}
+	const bool swap = header.m_byteOrder != kTelemetryByteOrder;
+	if (swap)
+	{
+		header.m_magic = Swap(header.m_magic);
+		header.m_version = Swap(header.m_version);
+		header.m_channelCount = Swap(header.m_channelCount);
+	}
+	if (header.m_magic != kTelemetryMagic || header.m_version != kTelemetryVersion)
+	{
+		fprintf(stderr, "%s is not a version %u telemetry file\n", argv[1], kTelemetryVersion);
+		return 1;
+	}
+
+	const unsigned channelCount = header.m_channelCount;
+	std::vector<TelemetryChannelInfo> channels(channelCount);
+	if (channelCount > 0 && fread(&channels[0], sizeof (channels[0]), channelCount, in) != channelCount)
+	{
+		fprintf(stderr, "%s has a truncated channel list\n", argv[1]);
+		return 1;
+	}
+
+	fprintf(out, "Time (s)");
+	for (unsigned c = 0; c < channelCount; ++c)
+	{
+		TelemetryChannelInfo& info = channels[c];
+		if (swap) info.m_type = Swap(info.m_type);
+		info.m_name[kTelemetryNameLength - 1] = '\0';
+		info.m_units[kTelemetryUnitsLength - 1] = '\0';
+		if (info.m_units[0] != '\0')
+		{
+			fprintf(out, ",%s (%s)", info.m_name, info.m_units);
+		}
+		else
+		{
+			fprintf(out, ",%s", info.m_name);
+		}
+	}
+	fputc('\n', out);
+
+	unsigned int rowCount;
+	std::vector<unsigned int> times;
+	std::vector<unsigned int> values;
+	while (fread(&rowCount, sizeof (rowCount), 1, in) == 1)
+	{
+		if (swap) rowCount = Swap(rowCount);
+		times.resize(rowCount);
+		values.resize(rowCount * channelCount);
+		bool complete = ReadColumn(in, rowCount ? &times[0] : NULL, rowCount, swap);
+		for (unsigned c = 0; complete && c < channelCount; ++c)
+		{
+			complete = ReadColumn(in, rowCount ? &values[c * rowCount] : NULL, rowCount, swap);
+		}
+		if (complete == false)
+		{
+			fprintf(stderr, "%s ends with a truncated block\n", argv[1]);
+			break;
+		}
+
+		for (unsigned row = 0; row < rowCount; ++row)
+		{
+			fprintf(out, "%.6f", times[row] * 1e-6);
+			for (unsigned c = 0; c < channelCount; ++c)
+			{
+				TelemetryValue value;
+				value.m_integer = static_cast<int> (values[c * rowCount + row]);
+				if (channels[c].m_type == kTelemetryInteger)
+				{
+					fprintf(out, ",%d", value.m_integer);
+				}
+				else
+				{
+					fprintf(out, ",%g", static_cast<double> (value.m_float));
+				}
+			}
+			fputc('\n', out);
+		}
+	}
+
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	fclose(in);
+	return 0;
+}
+
+#endif
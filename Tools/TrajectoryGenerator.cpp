@@ -0,0 +1,310 @@
+/*
+ * TrajectoryGenerator.cpp
+ *
+ * Host side tool that turns a list of waypoints into a trajectory file
+ * for Trajectory::Load. A Catmull-Rom spline is passed through the
+ * waypoints and timed so that the robot speeds up from a stop, stays
+ * within the speed and acceleration limits, slows down for curves and
+ * stops at the last waypoint. A point is written every kDrivePeriod
+ * seconds. Build it on the host with:
+ *
+ *     g++ -o TrajectoryGenerator Tools/TrajectoryGenerator.cpp
+ *
+ * Usage:
+ *
+ *     TrajectoryGenerator [--host-order] waypoints.txt autonomous.traj
+ *
+ * The waypoints file holds one waypoint per line, as x and y in inches
+ * from where the robot starts, x forward and y to the left. Copy the
+ * output to kAutonomousTrajectoryFile on the robot. With --host-order the
+ * file is written in the byte order of this computer rather than the
+ * cRIO's, for loading in the host tests and simulation.
+ *
+ * The top speed is kPathMaxVelocity, limited to kDriveVelocityLimit of
+ * kDriveMaxSpeed. The acceleration is kPathMaxAcceleration, limited to
+ * what the kDriveRamp output ramp can follow: the ramp lags the output by
+ * its time constant, so the acceleration is kept below reaching the top
+ * speed in one time constant. This file is not part of the robot build.
+ */
+#ifndef __vxworks
+
+#include "../Robotmap.h"
+#include "../Classes/TrajectoryFormat.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	//! The number of spline samples between each pair of waypoints
+	const int samplesPerSegment = 200;
+
+	struct Sample
+	{
+		double m_x;
+		double m_y;
+		double m_heading;
+		double m_distance;
+		double m_velocity;
+		double m_time;
+	};
+
+	//! Reverses the byte order of a 32 bit value
+	unsigned int Swap(unsigned int value)
+	{
+		return ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) |
+			((value & 0x00FF0000) >> 8) | ((value & 0xFF000000) >> 24);
+	}
+
+	//! Reverses the byte order of a 16 bit value
+	unsigned short Swap(unsigned short value)
+	{
+		return static_cast<unsigned short> ((value << 8) | (value >> 8));
+	}
+
+	//! Reverses the byte order of a float
+	float Swap(float value)
+	{
+		union { float m_float; unsigned int m_int; } bits;
+		bits.m_float = value;
+		bits.m_int = Swap(bits.m_int);
+		return bits.m_float;
+	}
+
+	//! Returns true if this computer is big endian like the cRIO
+	bool IsBigEndian()
+	{
+		const unsigned int value = 0x01020304;
+		return *reinterpret_cast<const unsigned char*> (&value) == 0x01;
+	}
+
+	//! Evaluates the Catmull-Rom spline through p1 and p2 at t
+	double CatmullRom(double p0, double p1, double p2, double p3, double t)
+	{
+		return 0.5 * ((2 * p1) + (p2 - p0) * t +
+			(2 * p0 - 5 * p1 + 4 * p2 - p3) * t * t +
+			(3 * p1 - p0 - 3 * p2 + p3) * t * t * t);
+	}
+
+	//! Returns the difference between two angles, wrapped to -pi to pi
+	double AngleDifference(double a, double b)
+	{
+		double difference = a - b;
+		while (difference > M_PI) difference -= 2 * M_PI;
+		while (difference < -M_PI) difference += 2 * M_PI;
+		return difference;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool hostOrder = false;
+	int arg = 1;
+	if (arg < argc && strcmp(argv[arg], "--host-order") == 0)
+	{
+		hostOrder = true;
+		++arg;
+	}
+	if (arg + 2 > argc)
+	{
+		fprintf(stderr, "Usage: %s [--host-order] waypoints.txt output.traj\n", argv[0]);
+		return 1;
+	}
+	const char* const waypointsName = argv[arg];
+	const char* const outputName = argv[arg + 1];
+
+	// Read the waypoints
+	FILE* in = fopen(waypointsName, "r");
+	if (in == NULL)
+	{
+		fprintf(stderr, "Unable to open %s\n", waypointsName);
+		return 1;
+	}
+	std::vector<double> xs;
+	std::vector<double> ys;
+	double x;
+	double y;
+	while (fscanf(in, "%lf %lf", &x, &y) == 2)
+	{
+		xs.push_back(x);
+		ys.push_back(y);
+	}
+	fclose(in);
+	const int waypointCount = static_cast<int> (xs.size());
+	if (waypointCount < 2)
+	{
+		fprintf(stderr, "%s needs at least two waypoints\n", waypointsName);
+		return 1;
+	}
+
+	// The limits the robot can follow
+	double maxVelocity = kPathMaxVelocity;
+	if (maxVelocity > kDriveVelocityLimit * kDriveMaxSpeed)
+	{
+		maxVelocity = kDriveVelocityLimit * kDriveMaxSpeed;
+	}
+	const double rampTimeConstant = -kDrivePeriod / log(1.0 - kDriveRamp);
+	double maxAcceleration = kPathMaxAcceleration;
+	if (maxAcceleration > maxVelocity / rampTimeConstant)
+	{
+		maxAcceleration = maxVelocity / rampTimeConstant;
+	}
+
+	// Sample the spline, with the end waypoints repeated so that it starts
+	// and ends on them
+	std::vector<Sample> samples;
+	for (int i = 0; i + 1 < waypointCount; ++i)
+	{
+		const int i0 = (i > 0) ? i - 1 : 0;
+		const int i3 = (i + 2 < waypointCount) ? i + 2 : waypointCount - 1;
+		for (int j = (i == 0) ? 0 : 1; j <= samplesPerSegment; ++j)
+		{
+			const double t = static_cast<double> (j) / samplesPerSegment;
+			Sample sample = {};
+			sample.m_x = CatmullRom(xs[i0], xs[i], xs[i + 1], xs[i3], t);
+			sample.m_y = CatmullRom(ys[i0], ys[i], ys[i + 1], ys[i3], t);
+			samples.push_back(sample);
+		}
+	}
+
+	// Work out the distance and heading at each sample
+	const int count = static_cast<int> (samples.size());
+	for (int i = 1; i < count; ++i)
+	{
+		const double dx = samples[i].m_x - samples[i - 1].m_x;
+		const double dy = samples[i].m_y - samples[i - 1].m_y;
+		samples[i].m_distance = samples[i - 1].m_distance + sqrt(dx * dx + dy * dy);
+		samples[i].m_heading = atan2(dy, dx);
+	}
+	samples[0].m_heading = samples[1].m_heading;
+
+	// Limit the speed so the sideways acceleration round curves stays
+	// within the maximum acceleration, v^2 * curvature <= a
+	for (int i = 0; i < count; ++i)
+	{
+		samples[i].m_velocity = maxVelocity;
+		if (i > 0 && i + 1 < count)
+		{
+			const double ds = samples[i + 1].m_distance - samples[i - 1].m_distance;
+			const double curvature = (ds > 0) ?
+				fabs(AngleDifference(samples[i + 1].m_heading, samples[i].m_heading)) * 2 / ds : 0;
+			if (curvature > 0 && sqrt(maxAcceleration / curvature) < samples[i].m_velocity)
+			{
+				samples[i].m_velocity = sqrt(maxAcceleration / curvature);
+			}
+		}
+	}
+
+	// Speed up from a stop and slow to a stop, v^2 = u^2 + 2as
+	samples[0].m_velocity = 0;
+	for (int i = 1; i < count; ++i)
+	{
+		const double ds = samples[i].m_distance - samples[i - 1].m_distance;
+		const double reachable = sqrt(samples[i - 1].m_velocity * samples[i - 1].m_velocity + 2 * maxAcceleration * ds);
+		if (reachable < samples[i].m_velocity) samples[i].m_velocity = reachable;
+	}
+	samples[count - 1].m_velocity = 0;
+	for (int i = count - 2; i >= 0; --i)
+	{
+		const double ds = samples[i + 1].m_distance - samples[i].m_distance;
+		const double reachable = sqrt(samples[i + 1].m_velocity * samples[i + 1].m_velocity + 2 * maxAcceleration * ds);
+		if (reachable < samples[i].m_velocity) samples[i].m_velocity = reachable;
+	}
+
+	// Time each sample, assuming constant acceleration between samples
+	for (int i = 1; i < count; ++i)
+	{
+		const double ds = samples[i].m_distance - samples[i - 1].m_distance;
+		const double speed = samples[i].m_velocity + samples[i - 1].m_velocity;
+		samples[i].m_time = samples[i - 1].m_time + ((speed > 0) ? 2 * ds / speed : 0);
+	}
+
+	// Resample every kDrivePeriod
+	std::vector<TrajectoryPoint> points;
+	int sample = 0;
+	for (double time = 0; ; time += kDrivePeriod)
+	{
+		while (sample + 1 < count && samples[sample + 1].m_time <= time)
+		{
+			++sample;
+		}
+		if (sample + 1 >= count)
+		{
+			break;
+		}
+		const Sample& a = samples[sample];
+		const Sample& b = samples[sample + 1];
+		const double t = (b.m_time > a.m_time) ? (time - a.m_time) / (b.m_time - a.m_time) : 0;
+		TrajectoryPoint point;
+		point.m_x = static_cast<float> (a.m_x + (b.m_x - a.m_x) * t);
+		point.m_y = static_cast<float> (a.m_y + (b.m_y - a.m_y) * t);
+		point.m_heading = static_cast<float> (a.m_heading + AngleDifference(b.m_heading, a.m_heading) * t);
+		point.m_velocity = static_cast<float> (a.m_velocity + (b.m_velocity - a.m_velocity) * t);
+		point.m_distance = static_cast<float> (a.m_distance + (b.m_distance - a.m_distance) * t);
+		points.push_back(point);
+	}
+	const Sample& last = samples[count - 1];
+	TrajectoryPoint end;
+	end.m_x = static_cast<float> (last.m_x);
+	end.m_y = static_cast<float> (last.m_y);
+	end.m_heading = static_cast<float> (last.m_heading);
+	end.m_velocity = 0;
+	end.m_distance = static_cast<float> (last.m_distance);
+	points.push_back(end);
+
+	if (points.size() > static_cast<size_t> (kTrajectoryMaxPoints))
+	{
+		fprintf(stderr, "The trajectory takes %.2f seconds, longer than the %d points the robot can hold\n",
+			last.m_time, kTrajectoryMaxPoints);
+		return 1;
+	}
+
+	// Convert to the robot's byte order, then checksum the points as stored
+	const bool swap = !hostOrder && !IsBigEndian();
+	if (swap)
+	{
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			points[i].m_x = Swap(points[i].m_x);
+			points[i].m_y = Swap(points[i].m_y);
+			points[i].m_heading = Swap(points[i].m_heading);
+			points[i].m_velocity = Swap(points[i].m_velocity);
+			points[i].m_distance = Swap(points[i].m_distance);
+		}
+	}
+	TrajectoryFileHeader header;
+	header.m_magic = kTrajectoryMagic;
+	header.m_byteOrder = kTrajectoryByteOrder;
+	header.m_version = kTrajectoryVersion;
+	header.m_pointSize = sizeof (TrajectoryPoint);
+	header.m_pointCount = static_cast<unsigned int> (points.size());
+	header.m_period = kDrivePeriod;
+	header.m_checksum = TrajectoryChecksum(&points[0], static_cast<unsigned int> (points.size() * sizeof (TrajectoryPoint)));
+	if (swap)
+	{
+		header.m_magic = Swap(header.m_magic);
+		header.m_byteOrder = Swap(header.m_byteOrder);
+		header.m_version = Swap(header.m_version);
+		header.m_pointSize = Swap(header.m_pointSize);
+		header.m_pointCount = Swap(header.m_pointCount);
+		header.m_period = Swap(header.m_period);
+		header.m_checksum = Swap(header.m_checksum);
+	}
+
+	FILE* out = fopen(outputName, "wb");
+	if (out == NULL)
+	{
+		fprintf(stderr, "Unable to create %s\n", outputName);
+		return 1;
+	}
+	fwrite(&header, sizeof (header), 1, out);
+	fwrite(&points[0], sizeof (TrajectoryPoint), points.size(), out);
+	fclose(out);
+
+	printf("%u points, %.1f inches in %.2f seconds\n",
+		static_cast<unsigned int> (points.size()), last.m_distance, last.m_time);
+	return 0;
+}
+
+#endif
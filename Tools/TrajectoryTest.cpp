@@ -0,0 +1,197 @@
+/*
+ * TrajectoryTest.cpp
+ *
+ * Host side test of the trajectory files. Build and run it with
+ * "make -C Tools check".
+ *
+ * TrajectoryGenerator, from the same build directory as this test, turns
+ * a list of waypoints into a file in this computer's byte order, which
+ * Trajectory::Load must load with the path starting and stopping at the
+ * ends of the waypoints. Copies of the file with a corrupted point, a
+ * wrong checksum, a wrong version, a missing point or a truncated header
+ * must all be rejected and leave the trajectory empty, as must a file in
+ * the other byte order. The files are written next to this test. The
+ * program exits with a failure if any check fails. This file is not part
+ * of the robot build.
+ */
+#ifndef __vxworks
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../Robotmap.h"
+#include "../Classes/Trajectory.h"
+
+namespace
+{
+	const float kTolerance = 0.01;	//!< Inches, for the ends of the path
+
+	const float kWaypoints[][2] = {{0, 0}, {60, 0}, {100, 40}};
+	const int kWaypointCount = sizeof(kWaypoints) / sizeof(kWaypoints[0]);
+
+	int s_failures = 0;
+	Trajectory s_trajectory;
+
+	//! Reports a failed check
+	void Check(bool passed, const char* description)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", description);
+			++s_failures;
+		}
+	}
+
+	//! Returns true if this computer is big endian like the cRIO
+	bool IsBigEndian()
+	{
+		const unsigned int value = 0x01020304;
+		return *reinterpret_cast<const unsigned char*> (&value) == 0x01;
+	}
+
+	//! Reads a whole file
+	std::vector<char> ReadFile(const std::string& name)
+	{
+		std::vector<char> contents;
+		FILE* file = fopen(name.c_str(), "rb");
+		if (file != NULL)
+		{
+			char buffer[4096];
+			size_t length;
+			while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+			{
+				contents.insert(contents.end(), buffer, buffer + length);
+			}
+			fclose(file);
+		}
+		return contents;
+	}
+
+	//! Writes length bytes of contents to a file
+	void WriteFile(const std::string& name, const std::vector<char>& contents, size_t length)
+	{
+		FILE* file = fopen(name.c_str(), "wb");
+		if (file != NULL)
+		{
+			fwrite(&contents[0], 1, length, file);
+			fclose(file);
+		}
+	}
+
+	//! Writes a damaged copy of a trajectory file and checks it is rejected
+	void CheckRejected(const std::string& name, const std::vector<char>& contents, size_t length,
+		const char* description)
+	{
+		WriteFile(name, contents, length);
+		const bool loaded = s_trajectory.Load(name.c_str());
+		Check(!loaded && s_trajectory.GetCount() == 0, description);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	// The generator and the files are in the directory this test is in
+	std::string directory = argv[0];
+	const size_t slash = directory.rfind('/');
+	directory = (slash == std::string::npos) ? "." : directory.substr(0, slash);
+	const std::string waypointsName = directory + "/TrajectoryTest.waypoints";
+	const std::string hostName = directory + "/TrajectoryTest.traj";
+	const std::string robotName = directory + "/TrajectoryTestRobot.traj";
+	const std::string damagedName = directory + "/TrajectoryTestDamaged.traj";
+
+	FILE* waypoints = fopen(waypointsName.c_str(), "w");
+	if (waypoints == NULL)
+	{
+		printf("FAILED: unable to create %s\n", waypointsName.c_str());
+		return 1;
+	}
+	for (int i = 0; i < kWaypointCount; ++i)
+	{
+		fprintf(waypoints, "%g %g\n", kWaypoints[i][0], kWaypoints[i][1]);
+	}
+	fclose(waypoints);
+
+	const std::string generator = directory + "/TrajectoryGenerator";
+	const std::string hostCommand = generator + " --host-order " + waypointsName + " " + hostName + " > /dev/null";
+	const std::string robotCommand = generator + " " + waypointsName + " " + robotName + " > /dev/null";
+	Check(system(hostCommand.c_str()) == 0, "TrajectoryGenerator --host-order failed");
+	Check(system(robotCommand.c_str()) == 0, "TrajectoryGenerator failed");
+
+	// The generated file loads, and runs from the first waypoint to the
+	// last, starting and ending stopped
+	Check(s_trajectory.Load(hostName.c_str()), "the generated trajectory does not load");
+	const int count = s_trajectory.GetCount();
+	Check(count > 1, "the loaded trajectory has no points");
+	if (count > 1)
+	{
+		const TrajectoryPoint& first = s_trajectory.GetPoint(0);
+		const TrajectoryPoint& last = s_trajectory.GetPoint(count - 1);
+		Check(fabs(first.m_x - kWaypoints[0][0]) < kTolerance && fabs(first.m_y - kWaypoints[0][1]) < kTolerance,
+			"the trajectory does not start at the first waypoint");
+		Check(fabs(last.m_x - kWaypoints[kWaypointCount - 1][0]) < kTolerance &&
+			fabs(last.m_y - kWaypoints[kWaypointCount - 1][1]) < kTolerance,
+			"the trajectory does not end at the last waypoint");
+		Check(first.m_velocity == 0 && last.m_velocity == 0, "the trajectory does not start and end stopped");
+		bool ordered = true;
+		bool limited = true;
+		for (int i = 1; i < count; ++i)
+		{
+			ordered = ordered && s_trajectory.GetPoint(i).m_distance >= s_trajectory.GetPoint(i - 1).m_distance;
+			limited = limited && s_trajectory.GetPoint(i).m_velocity <= kPathMaxVelocity + 1e-3;
+		}
+		Check(ordered, "the distance along the trajectory goes backwards");
+		Check(limited, "the trajectory is faster than kPathMaxVelocity");
+	}
+
+	// A file in the cRIO's byte order only loads on a big endian computer
+	Check(s_trajectory.Load(robotName.c_str()) == IsBigEndian(),
+		"a trajectory in the other byte order is not rejected");
+
+	const std::vector<char> contents = ReadFile(hostName);
+	const size_t headerSize = sizeof(TrajectoryFileHeader);
+	Check(contents.size() > headerSize, "the generated trajectory file is empty");
+	if (contents.size() > headerSize)
+	{
+		// An untouched copy loads, so the rejections below are down to the damage
+		WriteFile(damagedName, contents, contents.size());
+		Check(s_trajectory.Load(damagedName.c_str()) && s_trajectory.GetCount() == count,
+			"an untouched copy of the trajectory does not load");
+
+		std::vector<char> damaged = contents;
+		damaged[headerSize + sizeof(TrajectoryPoint) + 1] ^= 0x10;
+		CheckRejected(damagedName, damaged, damaged.size(), "a trajectory with a corrupted point is loaded");
+
+		damaged = contents;
+		TrajectoryFileHeader header;
+		memcpy(&header, &damaged[0], headerSize);
+		header.m_checksum ^= 1;
+		memcpy(&damaged[0], &header, headerSize);
+		CheckRejected(damagedName, damaged, damaged.size(), "a trajectory with the wrong checksum is loaded");
+
+		damaged = contents;
+		memcpy(&header, &damaged[0], headerSize);
+		header.m_version = kTrajectoryVersion + 1;
+		memcpy(&damaged[0], &header, headerSize);
+		CheckRejected(damagedName, damaged, damaged.size(), "a trajectory with the wrong version is loaded");
+
+		CheckRejected(damagedName, contents, contents.size() - sizeof(TrajectoryPoint),
+			"a trajectory missing its last point is loaded");
+		CheckRejected(damagedName, contents, contents.size() - 1, "a truncated trajectory is loaded");
+		CheckRejected(damagedName, contents, headerSize - 1, "a trajectory with a truncated header is loaded");
+	}
+	Check(!s_trajectory.Load((directory + "/NoSuchFile.traj").c_str()), "a missing trajectory file is loaded");
+
+	if (s_failures != 0)
+	{
+		printf("%d checks FAILED\n", s_failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
+
+#endif